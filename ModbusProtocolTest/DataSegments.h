@@ -0,0 +1,48 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Data segments header file. Frame as list of memory segments for send without gathering to one buffer.
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#ifndef DATA_SEGMENTS
+#define DATA_SEGMENTS
+
+#include <stdint.h>
+#include <stddef.h>
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* segment of frame for send: frame is sent as segments one by one, e.g. MBAP header and request PDU */
+//on POSIX systems layout is the same as iovec - array of segments is passed to writev/sendmsg as is
+struct DataSegment
+{
+	const uint8_t* data;
+	size_t length;
+};
+
+#ifndef _WIN32
+static_assert(sizeof(DataSegment) == sizeof(iovec) && offsetof(DataSegment, data) == offsetof(iovec, iov_base) &&
+	offsetof(DataSegment, length) == offsetof(iovec, iov_len), "DataSegment layout isn't iovec layout");
+
+/* segments as iovec array for writev/sendmsg */
+inline const iovec* DataSegmentsToIovec(const DataSegment* segments)
+{
+	return reinterpret_cast <const iovec*>(segments);
+}
+#endif
+
+/* total length of segments */
+inline size_t DataSegmentsLength(const DataSegment* segments, size_t segmentsCount)
+{
+	size_t length = 0;
+	for (size_t i = 0; i < segmentsCount; i++)
+	{
+		length += segments[i].length;
+	}
+	return length;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+#endif
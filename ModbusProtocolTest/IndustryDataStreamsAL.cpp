@@ -6,7 +6,289 @@
 //*********************************************************************************************************//
 
 #include "IndustryDataStreamsAL.h"
+#ifdef __linux__
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+#include <sys/uio.h>
+#include <poll.h>
+#endif
 
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* set capacity of transmit queue */
+bool TransmitFrameQueue::Init(size_t capacity)
+{
+	size_t cellsCount = 2;
+	while (cellsCount < capacity)
+	{
+		cellsCount <<= 1;
+	}
+	try
+	{
+		this->cells.reset(new frameCell[cellsCount]);
+	}
+	catch (...)
+	{
+		this->cells.reset();
+		this->cellsMask = 0;
+		return false;
+	}
+	for (size_t i = 0; i < cellsCount; i++)
+	{
+		this->cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	this->cellsMask = cellsCount - 1;
+	this->enqueuePos.store(0, std::memory_order_relaxed);
+	this->dequeuePos.store(0, std::memory_order_relaxed);
+	return true;
+}
+
+/* copy frame to queue */
+bool TransmitFrameQueue::Push(const uint8_t* data, size_t dataLength)
+{
+	DataSegment segment = { data, dataLength };
+	return Push(&segment, 1);
+}
+
+/* copy frame of segments to queue - position is taken by CAS, frame is published by sequence of cell */
+bool TransmitFrameQueue::Push(const DataSegment* segments, size_t segmentsCount)
+{
+	if (!this->cells || !segments)
+	{
+		return false;
+	}
+	size_t dataLength = DataSegmentsLength(segments, segmentsCount);
+	if (!dataLength || dataLength > frameMaxSize)
+	{
+		return false;
+	}
+	size_t position = this->enqueuePos.load(std::memory_order_relaxed);
+	frameCell* cell;
+	for (;;)
+	{
+		cell = &this->cells[position & this->cellsMask];
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+		if (difference == 0)
+		{
+			if (this->enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			//cell of previous turn isn't read by consumer - queue is full
+			return false;
+		}
+		else
+		{
+			position = this->enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+	uint8_t* cellData = cell->data;
+	for (size_t i = 0; i < segmentsCount; i++)
+	{
+		if (segments[i].length)
+		{
+			memcpy(cellData, segments[i].data, segments[i].length);
+			cellData += segments[i].length;
+		}
+	}
+	cell->dataLength = dataLength;
+	cell->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+/* frame at position index from head */
+bool TransmitFrameQueue::PeekFrame(size_t index, const uint8_t** data, size_t* dataLength) const
+{
+	if (!this->cells || index > this->cellsMask)
+	{
+		return false;
+	}
+	size_t position = this->dequeuePos.load(std::memory_order_relaxed) + index;
+	const frameCell* cell = &this->cells[position & this->cellsMask];
+	if (cell->sequence.load(std::memory_order_acquire) != position + 1)
+	{
+		return false;
+	}
+	*data = cell->data;
+	*dataLength = cell->dataLength;
+	return true;
+}
+
+/* remove frames from head - cells are free for next turn of producers */
+void TransmitFrameQueue::PopFrames(size_t framesCount)
+{
+	size_t position = this->dequeuePos.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < framesCount; i++)
+	{
+		this->cells[(position + i) & this->cellsMask].sequence.store(position + i + this->cellsMask + 1, std::memory_order_release);
+	}
+	this->dequeuePos.store(position + framesCount, std::memory_order_relaxed);
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* constructor - slabs are allocated once */
+ReceiveSlabRing::ReceiveSlabRing(size_t slabSize, size_t slabsCount) :
+	memory(new uint8_t[slabSize * slabsCount]), slabHeld(new atomic <bool>[slabsCount]), slabSize(slabSize), slabsCount(slabsCount)
+{
+	for (size_t i = 0; i < slabsCount; i++)
+	{
+		this->slabHeld[i].store(false, std::memory_order_relaxed);
+	}
+}
+
+/* next slab of ring - wait while it is held by view */
+uint8_t* ReceiveSlabRing::AcquireSlab(size_t* slabIndex)
+{
+	size_t index = this->nextSlab;
+	if (this->slabHeld[index].load(std::memory_order_acquire))
+	{
+		std::unique_lock <std::mutex> lock(this->ringLock);
+		this->slabReleased.wait(lock, [this, index]() {
+			return this->interrupted || !this->slabHeld[index].load(std::memory_order_acquire); });
+		if (this->interrupted)
+		{
+			return nullptr;
+		}
+	}
+	this->slabHeld[index].store(true, std::memory_order_relaxed);
+	this->nextSlab = (index + 1) % this->slabsCount;
+	*slabIndex = index;
+	return this->memory.get() + index * this->slabSize;
+}
+
+/* return slab to ring */
+void ReceiveSlabRing::ReleaseSlab(size_t slabIndex)
+{
+	//flag is changed under lock - receive thread can't miss it between check and wait
+	std::lock_guard <std::mutex> lock(this->ringLock);
+	this->slabHeld[slabIndex].store(false, std::memory_order_release);
+	this->slabReleased.notify_one();
+}
+
+/* stop waiting of receive thread */
+void ReceiveSlabRing::Interrupt(void)
+{
+	std::lock_guard <std::mutex> lock(this->ringLock);
+	this->interrupted = true;
+	this->slabReleased.notify_one();
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* create ring of receive slabs for stream start */
+bool IndustryDataStreamAL::createReceiveSlabs(void)
+{
+	try
+	{
+		this->receiveSlabs = std::make_shared <ReceiveSlabRing>(this->receiveSlabSize, this->receiveSlabsCount);
+	}
+	catch (...)
+	{
+		this->receiveSlabs.reset();
+		return false;
+	}
+	return true;
+}
+
+/* pass received data to handlers - data handlers are called with data in slab, then view handler gets slab */
+void IndustryDataStreamAL::passReceivedData(size_t slabIndex, uint8_t* data, size_t dataLength)
+{
+	//call external handler for data - free function
+	if (this->dataReceiveFunc)
+	{
+		this->dataReceiveFunc(data, dataLength);
+	}
+	//call external handler for data - function of object
+	if (this->dataReceiveFuncObj)
+	{
+		this->dataReceiveFuncObj(data, dataLength);
+	}
+	//view releases slab, if handler doesn't keep it
+	ReceiveDataView view(this->receiveSlabs, slabIndex, data, dataLength);
+	if (this->dataReceiveViewFunc)
+	{
+		this->dataReceiveViewFunc(view);
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* send frame of segments by SendData - segments are copied to one buffer */
+bool IndustryDataStreamAL::SendDataSegments(const DataSegment* segments, size_t segmentsCount)
+{
+	if (!segments)
+	{
+		return false;
+	}
+	vector <uint8_t> frame;
+	try
+	{
+		frame.reserve(DataSegmentsLength(segments, segmentsCount));
+		for (size_t i = 0; i < segmentsCount; i++)
+		{
+			frame.insert(frame.end(), segments[i].data, segments[i].data + segments[i].length);
+		}
+	}
+	catch (...)
+	{
+		return false;
+	}
+	return frame.size() ? SendData(frame.data(), frame.size()) : false;
+}
+
+/* queue frame for transmit thread */
+bool IndustryDataStreamAL::queueTransmitFrame(const DataSegment* segments, size_t segmentsCount, bool* wakeTransmitThread)
+{
+	*wakeTransmitThread = false;
+	if (!this->transmitQueue.Push(segments, segmentsCount))
+	{
+		this->transmitQueueDrops++;
+		this->newTransmitReady = false;
+		return false;
+	}
+	size_t queueDepth = this->transmitQueue.GetDepth();
+	size_t maxDepth = this->transmitQueueMaxDepth.load(std::memory_order_relaxed);
+	while (queueDepth > maxDepth && !this->transmitQueueMaxDepth.compare_exchange_weak(maxDepth, queueDepth, std::memory_order_relaxed))
+	{
+	}
+	//frame is published before waiting flag is read - transmit thread sees frame or producer sees waiting thread
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	*wakeTransmitThread = this->transmitThreadWaiting.exchange(false);
+	return true;
+}
+
+/* transmit thread is going to wait event */
+bool IndustryDataStreamAL::prepareTransmitWait(void)
+{
+	const uint8_t* data;
+	size_t dataLength;
+	this->transmitThreadWaiting.store(true);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (this->transmitQueue.PeekFrame(0, &data, &dataLength))
+	{
+		this->transmitThreadWaiting.store(false);
+		return false;
+	}
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef _WIN32
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 /* start com port data stream */
 bool DataStreamCOM::StreamStart()
@@ -40,7 +322,8 @@ bool DataStreamCOM::StreamStart()
 		comPortTimeouts.ReadTotalTimeoutMultiplier = 0;
 		comPortTimeouts.ReadTotalTimeoutConstant = this->comPortTotalTimeout;
 		comPortTimeouts.WriteTotalTimeoutMultiplier = 0;
-		comPortTimeouts.WriteTotalTimeoutConstant = this->comPortTotalTimeout;
+		//no write timeout - batch of frames is written by transmit thread during any time
+		comPortTimeouts.WriteTotalTimeoutConstant = 0;
 
 		if (!SetCommTimeouts(comPortHandle, &comPortTimeouts))
 		{
@@ -96,12 +379,27 @@ bool DataStreamCOM::StreamStart()
 	//try create threads
 	try
 	{
-		//receive thread
+		//receive slabs and receive thread
+		if (!createReceiveSlabs())
+		{
+			throw (string)"COMStream ERROR: can't create receive buffers.";
+		}
 		this->receiveThread = thread(&DataStreamCOM::receiveDataThreadFunction, this);
 		if (!this->receiveThread.joinable())
 		{
 			throw (string)"COMStream ERROR: can't start receive thread or stream.";
 		}
+		//transmit thread - auto reset event about new frames in queue
+		this->transmitEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+		if (this->transmitEvent == NULL || !this->transmitQueue.Init(this->transmitQueueSize))
+		{
+			throw (string)"COMStream ERROR: can't create transmit event or queue.";
+		}
+		this->transmitThread = thread(&DataStreamCOM::transmitDataThreadFunction, this);
+		if (!this->transmitThread.joinable())
+		{
+			throw (string)"COMStream ERROR: can't start transmit thread or stream.";
+		}
 	}
 	catch (string& s)
 	{
@@ -130,6 +428,10 @@ bool DataStreamCOM::StreamStop()
 {
 	//stop message for threads
 	stopThreadsFlag = true;
+	if (this->receiveSlabs)
+	{
+		this->receiveSlabs->Interrupt();
+	}
 
 	transmitStreamStarted = false;
 
@@ -143,6 +445,21 @@ bool DataStreamCOM::StreamStop()
 		receiveStreamStarted = false;
 	}
 
+	//transmit thread, not sent frames are dropped
+	if (this->transmitEvent != NULL)
+	{
+		SetEvent(this->transmitEvent);
+	}
+	if (transmitThread.joinable())
+	{
+		transmitThread.join();
+	}
+	if (this->transmitEvent != NULL)
+	{
+		CloseHandle(this->transmitEvent);
+		this->transmitEvent = NULL;
+	}
+
 	//close COM port
 	std::lock_guard <mutex> lock_comPortHandle(mutex_comPortHandle);
 	CloseHandle(comPortHandle);
@@ -161,142 +478,131 @@ bool DataStreamCOM::StreamStop()
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* send data to port - asynchronous transmit */
+/* send data to port - frame is copied to transmit queue, written by transmit thread */
+//any threads can send at the same time, frame is dropped if queue is full
 bool DataStreamCOM::SendData(uint8_t* data, size_t dataLength)
+{
+	DataSegment segment = { data, dataLength };
+	return SendDataSegments(&segment, 1);
+}
+
+/* send frame of segments - segments are gathered in transmit queue */
+bool DataStreamCOM::SendDataSegments(const DataSegment* segments, size_t segmentsCount)
 {
 	//check input
-	if (!data || !dataLength)
+	if (!segments || !segmentsCount)
+	{
+		return false;
+	}
+	if (!transmitStreamStarted)
+	{
+		ids_outputErrorMessageA("ERROR COM port transmit: COM port closed.");
+		return false;
+	}
+	bool wakeTransmitThread;
+	if (!queueTransmitFrame(segments, segmentsCount, &wakeTransmitThread))
 	{
+		ids_outputErrorMessageA("ERROR COM port transmit: transmit queue is full, frame is dropped.");
 		return false;
 	}
+	if (wakeTransmitThread)
+	{
+		SetEvent(this->transmitEvent);
+	}
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
 
-	//lock for com port handle
-	std::unique_lock <mutex> lock_comPortHandle(mutex_comPortHandle, std::defer_lock);
-	//lock for transmit data
-	std::unique_lock <mutex> lockTransmit(mutex_transmitDataProtect, std::defer_lock);
-	DWORD bytesWritten;
-	DWORD waitResult;
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* thread for asynchronous transmit data - all ready frames of queue are written by one WriteFile */
+void DataStreamCOM::transmitDataThreadFunction()
+{
 	OVERLAPPED sync = { 0 };
-	bool writeResult;
+	DWORD bytesWritten, waitResult;
+	std::unique_lock <mutex> lock_comPortHandle(mutex_comPortHandle, std::defer_lock);
 
-	//lock all data for transmit
-	lockTransmit.lock();
-	if (!this->newTransmitReady)
+	//event of write operation is created once
+	sync.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (sync.hEvent == NULL)
 	{
-		ids_outputErrorMessageA("ERROR COM port transmit: transmit process busy.");
-		return false;
+		ids_outputErrorMessageA("ERROR COM port transmit: fail create synchronization object.");
+		return;
 	}
 
-	if (dataLength)
-	{
-		this->dataForTransmit = data;
-		this->lenOfDataForTransmit = dataLength;
-		this->newTransmitReady = false;
-		this->lastTransmitState = false;
+	//change status flag
+	transmitThreadWork = true;
 
-		try
+	while (!stopThreadsFlag)
+	{
+		//ready frames from head of queue - to one buffer
+		size_t framesCount = 0;
+		size_t batchLength = 0;
+		const uint8_t* frameData;
+		size_t frameLength;
+		while (framesCount < transmitBatchMaxFrames && this->transmitQueue.PeekFrame(framesCount, &frameData, &frameLength))
 		{
-			//create synchro object
-			sync.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
-			if (sync.hEvent == NULL)
+			memcpy(this->transmitBuffer + batchLength, frameData, frameLength);
+			batchLength += frameLength;
+			framesCount++;
+		}
+		if (!framesCount)
+		{
+			//queue is empty - wait new frames or stop
+			if (prepareTransmitWait())
 			{
-				throw (string)"ERROR COM port transmit: fail create synchronization object.";
+				WaitForSingleObject(this->transmitEvent, INFINITE);
 			}
+			continue;
+		}
+		//cells are free for producers during write
+		this->transmitQueue.PopFrames(framesCount);
 
-			//lock handle and write data
-			lock_comPortHandle.lock();
-			if (comPortHandle != INVALID_HANDLE_VALUE)
+		//write batch
+		bool writeResult = false;
+		bytesWritten = 0;
+		ResetEvent(sync.hEvent);
+		lock_comPortHandle.lock();
+		if (comPortHandle != INVALID_HANDLE_VALUE)
+		{
+			writeResult = WriteFile(comPortHandle, this->transmitBuffer, (DWORD)batchLength, &bytesWritten, &sync);
+			if (!writeResult && GetLastError() == ERROR_IO_PENDING)
 			{
-				writeResult = WriteFile(comPortHandle, this->dataForTransmit, this->lenOfDataForTransmit, &bytesWritten, &sync);
 				lock_comPortHandle.unlock();
-				//check result
-				if (!writeResult)
+				//wait operation complete, stop of stream cancels operation
+				do
 				{
-					if (GetLastError() == ERROR_IO_PENDING)
-					{
-						//ok - wait operation complete
-						waitResult = WaitForSingleObject(sync.hEvent, this->comPortWriteTimeout);
-						if (waitResult == WAIT_OBJECT_0)
-						{
-							//lock handle and get result
-							lock_comPortHandle.lock();
-							if (!GetOverlappedResult(comPortHandle, &sync, &bytesWritten, FALSE))
-							{
-								//unlock immediatelly
-								lock_comPortHandle.unlock();
-								//error message
-								throw (string)"ERROR COM port transmit: ok send data during timeout, but result of asynchronous operation = false.";
-							}
-							else
-							{
-								writeResult = true;
-							}
-							lock_comPortHandle.unlock();
-						}
-						else
-						{
-							throw (string)"ERROR COM port transmit: fail send data during timeout.";
-						}
-					}
-					else
+					waitResult = WaitForSingleObject(sync.hEvent, this->comPortWriteWaitStep);
+					if (waitResult == WAIT_TIMEOUT && stopThreadsFlag)
 					{
-						throw (string)"ERROR COM port transmit: fail write data to COM port.";
+						lock_comPortHandle.lock();
+						CancelIoEx(comPortHandle, &sync);
+						lock_comPortHandle.unlock();
 					}
-				}
-				else
-				{
-					throw (string)"ERROR COM port transmit: fail write data to COM port.";
-				}
-
-				//check result
-				if (writeResult && (this->lenOfDataForTransmit == bytesWritten))
-				{
-					this->lastTransmitState = true;
-				}
-				this->newTransmitReady = true;
-				this->lenOfDataForTransmit = 0;
-				this->dataForTransmit = nullptr;
+				} while (waitResult == WAIT_TIMEOUT);
+				lock_comPortHandle.lock();
+				writeResult = GetOverlappedResult(comPortHandle, &sync, &bytesWritten, TRUE);
 			}
-			else
-			{
-				lock_comPortHandle.unlock();
-				throw (string)"ERROR COM port transmit: COM port closed.";
-			}
-
-			//close event object
-			CloseHandle(sync.hEvent);
 		}
-		catch (string& s)
+		lock_comPortHandle.unlock();
+
+		//check result
+		if (writeResult && bytesWritten == batchLength)
 		{
-			if (sync.hEvent != NULL)
-			{
-				CloseHandle(sync.hEvent);
-			}
-			ids_outputErrorMessageA(s.c_str());
-			this->lastTransmitState = false;
-			this->newTransmitReady = true;
-			this->dataForTransmit = nullptr;
-			this->lenOfDataForTransmit = 0;
-			return false;
+			this->lastTransmitState = true;
 		}
-		catch (...)
+		else
 		{
-			if (sync.hEvent != NULL)
-			{
-				CloseHandle(sync.hEvent);
-			}
-			ids_outputErrorMessageA("ERROR COM port transmit: unknown error.");
+			ids_outputErrorMessageA("ERROR COM port transmit: fail write data to COM port.");
 			this->lastTransmitState = false;
-			this->newTransmitReady = true;
-			this->dataForTransmit = nullptr;
-			this->lenOfDataForTransmit = 0;
-			return false;
 		}
+		this->newTransmitReady = true;
 	}
-	//unlock all transmit data
-	lockTransmit.unlock();
 
-	return true;
+	//close event object
+	CloseHandle(sync.hEvent);
+
+	//change status flag
+	transmitThreadWork = false;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
@@ -307,6 +613,9 @@ void DataStreamCOM::receiveDataThreadFunction()
 	OVERLAPPED sync = { 0 };
 	unsigned long wait, read, state;
 	std::unique_lock <mutex> lock_comPortHandle(mutex_comPortHandle, std::defer_lock);
+	//slab of ring for next read, it is passed to handlers with received data
+	size_t slabIndex = 0;
+	uint8_t* slab = nullptr;
 
 	//change status flag
 	receiveThreadWork = true;
@@ -318,6 +627,15 @@ void DataStreamCOM::receiveDataThreadFunction()
 		{
 			break;
 		}
+		//wait for slab is canceled by stop
+		if (!slab)
+		{
+			slab = this->receiveSlabs->AcquireSlab(&slabIndex);
+			if (!slab)
+			{
+				break;
+			}
+		}
 
 		//try receive
 		try
@@ -348,7 +666,7 @@ void DataStreamCOM::receiveDataThreadFunction()
 				{
 					lock_comPortHandle.lock();
 					//read receive data
-					ReadFile(comPortHandle, this->inputBuffer, inputBufferSize, &read, &sync);
+					ReadFile(comPortHandle, slab, (DWORD)this->receiveSlabs->GetSlabSize(), &read, &sync);
 					lock_comPortHandle.unlock();
 					//wait end reading
 					wait = WaitForSingleObject(sync.hEvent, this->comPortReadTimeout);
@@ -359,15 +677,11 @@ void DataStreamCOM::receiveDataThreadFunction()
 						if (GetOverlappedResult(comPortHandle, &sync, &read, FALSE))
 						{
 							lock_comPortHandle.unlock();
-							//call external handler for data - free function
-							if (this->dataReceiveFunc)
-							{
-								this->dataReceiveFunc((uint8_t*)this->inputBuffer, read);
-							}
-							//call external handler for data - function of object
-							if (this->dataReceiveFuncObj)
+							//slab with data is passed to handlers, next read - to next slab
+							if (read)
 							{
-								this->dataReceiveFuncObj((uint8_t*)this->inputBuffer, read);
+								passReceivedData(slabIndex, slab, read);
+								slab = nullptr;
 							}
 						}
 						else
@@ -412,6 +726,10 @@ void DataStreamCOM::receiveDataThreadFunction()
 			continue;
 		}
 	}
+	if (slab)
+	{
+		this->receiveSlabs->ReleaseSlab(slabIndex);
+	}
 
 	//change status flag
 	receiveThreadWork = false;
@@ -443,3 +761,1488 @@ const vector <wstring>* DataStreamCOM::GetAvailableCOMList()
 	return &(this->comPortsList);
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
+#endif
+
+#ifdef __linux__
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* termios code of baud rate, B0 - not supported */
+static speed_t serialBaudRateCode(uint32_t baudRate)
+{
+	switch (baudRate)
+	{
+		case 50: return B50;
+		case 75: return B75;
+		case 110: return B110;
+		case 134: return B134;
+		case 150: return B150;
+		case 200: return B200;
+		case 300: return B300;
+		case 600: return B600;
+		case 1200: return B1200;
+		case 1800: return B1800;
+		case 2400: return B2400;
+		case 4800: return B4800;
+		case 9600: return B9600;
+		case 19200: return B19200;
+		case 38400: return B38400;
+		case 57600: return B57600;
+		case 115200: return B115200;
+		case 230400: return B230400;
+		case 460800: return B460800;
+		case 500000: return B500000;
+		case 576000: return B576000;
+		case 921600: return B921600;
+		case 1000000: return B1000000;
+		case 1152000: return B1152000;
+		case 1500000: return B1500000;
+		case 2000000: return B2000000;
+		case 2500000: return B2500000;
+		case 3000000: return B3000000;
+		case 3500000: return B3500000;
+		case 4000000: return B4000000;
+		default: return B0;
+	}
+}
+
+bool DataStreamSerial::baudRateSupported(uint32_t baudRateIn)
+{
+	return serialBaudRateCode(baudRateIn) != B0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* start serial port data stream */
+bool DataStreamSerial::StreamStart()
+{
+	//check state
+	if (transmitStreamStarted || receiveStreamStarted || transmitThreadWork || receiveThreadWork ||
+		this->transmitThread.joinable() || this->receiveThread.joinable())
+	{
+		return false;
+	}
+
+	//try open and config serial device, create threads
+	try
+	{
+		if (this->deviceName.empty())
+		{
+			throw (string)"SerialStream ERROR: serial device name isn't set.";
+		}
+		//tty isn't controlling terminal of process
+		this->deviceHandle = open(this->deviceName.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+		if (this->deviceHandle < 0)
+		{
+			throw (string)"SerialStream ERROR: can't open serial device.";
+		}
+		if (!configDevice())
+		{
+			throw (string)"SerialStream ERROR: can't config serial device parameters.";
+		}
+		//transmit thread writes by own not blocking handle of tty - it waits free space of tty and stop event together
+		this->transmitHandle = open(this->deviceName.c_str(), O_WRONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+		this->transmitEventHandle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (this->transmitHandle < 0 || this->transmitEventHandle < 0 || !this->transmitQueue.Init(this->transmitQueueSize))
+		{
+			throw (string)"SerialStream ERROR: can't create transmit handle or queue.";
+		}
+		if (!createReceiveSlabs())
+		{
+			throw (string)"SerialStream ERROR: can't create receive buffers.";
+		}
+
+		//epoll for tty and event for stop of thread
+		this->epollHandle = epoll_create1(EPOLL_CLOEXEC);
+		this->stopEventHandle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (this->epollHandle < 0 || this->stopEventHandle < 0)
+		{
+			throw (string)"SerialStream ERROR: can't create events objects.";
+		}
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.fd = this->deviceHandle;
+		if (epoll_ctl(this->epollHandle, EPOLL_CTL_ADD, this->deviceHandle, &event) < 0)
+		{
+			throw (string)"SerialStream ERROR: can't create events objects.";
+		}
+		event.data.fd = this->stopEventHandle;
+		if (epoll_ctl(this->epollHandle, EPOLL_CTL_ADD, this->stopEventHandle, &event) < 0)
+		{
+			throw (string)"SerialStream ERROR: can't create events objects.";
+		}
+
+		stopThreadsFlag = false;
+		this->receiveThread = thread(&DataStreamSerial::receiveDataThreadFunction, this);
+		if (!this->receiveThread.joinable())
+		{
+			throw (string)"SerialStream ERROR: can't start receive thread or stream.";
+		}
+		this->transmitThread = thread(&DataStreamSerial::transmitDataThreadFunction, this);
+		if (!this->transmitThread.joinable())
+		{
+			throw (string)"SerialStream ERROR: can't start transmit thread or stream.";
+		}
+	}
+	catch (string& s)
+	{
+		ids_outputErrorMessageA(s.c_str());
+		this->StreamStop();
+		return false;
+	}
+	catch (...)
+	{
+		ids_outputErrorMessageA("SerialStream ERROR: unknown error during start system thread.");
+		this->StreamStop();
+		return false;
+	}
+
+	//set flags about stream start
+	transmitStreamStarted = true;
+	receiveStreamStarted = true;
+
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* config tty: raw mode, frame format, baud rate, VMIN/VTIME, low latency mode */
+bool DataStreamSerial::configDevice(void)
+{
+	termios tty;
+	if (tcgetattr(this->deviceHandle, &tty) < 0)
+	{
+		return false;
+	}
+	//raw mode: no echo, no line editing, no conversion of bytes
+	cfmakeraw(&tty);
+	tty.c_cflag &= ~(CSIZE | CSTOPB | PARENB | PARODD | CMSPAR | CRTSCTS);
+	tty.c_cflag |= CLOCAL | CREAD;
+	switch (this->byteSize)
+	{
+		case 5: tty.c_cflag |= CS5; break;
+		case 6: tty.c_cflag |= CS6; break;
+		case 7: tty.c_cflag |= CS7; break;
+		default: tty.c_cflag |= CS8; break;
+	}
+	if (this->stopBits == SERIAL_TWO_STOP_BITS)
+	{
+		tty.c_cflag |= CSTOPB;
+	}
+	switch (this->parity)
+	{
+		case SERIAL_ODD_PARITY: tty.c_cflag |= PARENB | PARODD; break;
+		case SERIAL_EVEN_PARITY: tty.c_cflag |= PARENB; break;
+		case SERIAL_MARK_PARITY: tty.c_cflag |= PARENB | PARODD | CMSPAR; break;
+		case SERIAL_SPACE_PARITY: tty.c_cflag |= PARENB | CMSPAR; break;
+		default: break;
+	}
+	//read after epoll event: VMIN = 0, VTIME = 0 - available bytes at once
+	tty.c_cc[VMIN] = this->readMinBytes;
+	tty.c_cc[VTIME] = this->readInterByteTime;
+	speed_t speed = serialBaudRateCode(this->baudRate);
+	if (cfsetispeed(&tty, speed) < 0 || cfsetospeed(&tty, speed) < 0 || tcsetattr(this->deviceHandle, TCSANOW, &tty) < 0)
+	{
+		return false;
+	}
+	//old data of tty isn't received
+	tcflush(this->deviceHandle, TCIOFLUSH);
+
+	//driver without serial_struct (pseudo-terminal, some USB adapters) doesn't support low latency mode
+	if (this->lowLatency)
+	{
+		serial_struct serialInfo;
+		if (ioctl(this->deviceHandle, TIOCGSERIAL, &serialInfo) == 0)
+		{
+			serialInfo.flags |= ASYNC_LOW_LATENCY;
+			if (ioctl(this->deviceHandle, TIOCSSERIAL, &serialInfo) < 0)
+			{
+				ids_outputErrorMessageA("SerialStream ERROR: can't set low latency mode of serial device.");
+			}
+		}
+	}
+	return true;
+}
+
+/* close tty handles, epoll and events, threads are stopped */
+void DataStreamSerial::closeDevice(void)
+{
+	if (this->deviceHandle >= 0)
+	{
+		close(this->deviceHandle);
+		this->deviceHandle = -1;
+	}
+	if (this->transmitHandle >= 0)
+	{
+		close(this->transmitHandle);
+		this->transmitHandle = -1;
+	}
+	if (this->transmitEventHandle >= 0)
+	{
+		close(this->transmitEventHandle);
+		this->transmitEventHandle = -1;
+	}
+	if (this->epollHandle >= 0)
+	{
+		close(this->epollHandle);
+		this->epollHandle = -1;
+	}
+	if (this->stopEventHandle >= 0)
+	{
+		close(this->stopEventHandle);
+		this->stopEventHandle = -1;
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* stop serial port data stream */
+bool DataStreamSerial::StreamStop()
+{
+	//stop message for threads - flag and events for waiting threads, not sent frames are dropped
+	stopThreadsFlag = true;
+	transmitStreamStarted = false;
+	if (this->receiveSlabs)
+	{
+		this->receiveSlabs->Interrupt();
+	}
+	uint64_t eventValue = 1;
+	if (this->stopEventHandle >= 0 && write(this->stopEventHandle, &eventValue, sizeof(eventValue)) < 0)
+	{
+		ids_outputErrorMessageA("SerialStream ERROR: fail send stop event to receive thread.");
+	}
+	if (this->transmitEventHandle >= 0 && write(this->transmitEventHandle, &eventValue, sizeof(eventValue)) < 0)
+	{
+		ids_outputErrorMessageA("SerialStream ERROR: fail send stop event to transmit thread.");
+	}
+	if (receiveThread.joinable())
+	{
+		receiveThread.join();
+	}
+	if (transmitThread.joinable())
+	{
+		transmitThread.join();
+	}
+	closeDevice();
+
+	transmitStreamStarted = false;
+	receiveStreamStarted = false;
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* send data to serial port - frame is copied to transmit queue, written by transmit thread */
+//any threads can send at the same time, frame is dropped if queue is full
+bool DataStreamSerial::SendData(uint8_t* data, size_t dataLength)
+{
+	DataSegment segment = { data, dataLength };
+	return SendDataSegments(&segment, 1);
+}
+
+/* send frame of segments - segments are gathered in transmit queue */
+bool DataStreamSerial::SendDataSegments(const DataSegment* segments, size_t segmentsCount)
+{
+	//check input
+	if (!segments || !segmentsCount)
+	{
+		return false;
+	}
+	if (!transmitStreamStarted)
+	{
+		ids_outputErrorMessageA("ERROR serial port transmit: serial device closed.");
+		return false;
+	}
+	bool wakeTransmitThread;
+	if (!queueTransmitFrame(segments, segmentsCount, &wakeTransmitThread))
+	{
+		ids_outputErrorMessageA("ERROR serial port transmit: transmit queue is full, frame is dropped.");
+		return false;
+	}
+	uint64_t eventValue = 1;
+	if (wakeTransmitThread && write(this->transmitEventHandle, &eventValue, sizeof(eventValue)) < 0)
+	{
+		ids_outputErrorMessageA("ERROR serial port transmit: fail wake transmit thread.");
+	}
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* thread for transmit data - all ready frames of queue are written by one writev */
+void DataStreamSerial::transmitDataThreadFunction()
+{
+	iovec frames[transmitBatchMaxFrames];
+	//part of first frame written by previous write
+	size_t frameOffset = 0;
+
+	//change status flag
+	transmitThreadWork = true;
+
+	while (!stopThreadsFlag)
+	{
+		//ready frames from head of queue
+		size_t framesCount = 0;
+		const uint8_t* frameData;
+		size_t frameLength;
+		while (framesCount < transmitBatchMaxFrames && this->transmitQueue.PeekFrame(framesCount, &frameData, &frameLength))
+		{
+			frames[framesCount].iov_base = (void*)frameData;
+			frames[framesCount].iov_len = frameLength;
+			framesCount++;
+		}
+		if (!framesCount)
+		{
+			//queue is empty - wait new frames or stop
+			if (prepareTransmitWait())
+			{
+				waitTransmitEvents(false);
+			}
+			continue;
+		}
+		frames[0].iov_base = (uint8_t*)frames[0].iov_base + frameOffset;
+		frames[0].iov_len -= frameOffset;
+
+		ssize_t writeResult = writev(this->transmitHandle, frames, (int)framesCount);
+		if (writeResult < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			if (errno == EAGAIN)
+			{
+				//output buffer of tty is full
+				waitTransmitEvents(true);
+				continue;
+			}
+			//frames aren't sent - dropped
+			ids_outputErrorMessageA("ERROR serial port transmit: fail write data to serial device.");
+			this->transmitQueue.PopFrames(framesCount);
+			frameOffset = 0;
+			this->lastTransmitState = false;
+			this->newTransmitReady = true;
+			continue;
+		}
+
+		//remove written frames, rest of partly written frame is written next time
+		size_t bytesWritten = (size_t)writeResult;
+		size_t framesWritten = 0;
+		while (framesWritten < framesCount && bytesWritten >= frames[framesWritten].iov_len)
+		{
+			bytesWritten -= frames[framesWritten].iov_len;
+			framesWritten++;
+		}
+		frameOffset = framesWritten ? bytesWritten : frameOffset + bytesWritten;
+		this->transmitQueue.PopFrames(framesWritten);
+		this->lastTransmitState = true;
+		this->newTransmitReady = true;
+	}
+
+	//change status flag
+	transmitThreadWork = false;
+}
+
+/* wait event of transmit thread (new frames, stop) and free space of tty if waitOutput */
+void DataStreamSerial::waitTransmitEvents(bool waitOutput)
+{
+	pollfd events[2] = {};
+	events[0].fd = this->transmitEventHandle;
+	events[0].events = POLLIN;
+	events[1].fd = this->transmitHandle;
+	events[1].events = POLLOUT;
+	if (poll(events, waitOutput ? 2 : 1, -1) > 0 && (events[0].revents & POLLIN))
+	{
+		uint64_t eventValue;
+		if (read(this->transmitEventHandle, &eventValue, sizeof(eventValue)) < 0)
+		{
+			//event is reset by other read
+		}
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* thread for receive data - wait of tty data or stop event */
+void DataStreamSerial::receiveDataThreadFunction()
+{
+	epoll_event events[2];
+
+	//change status flag
+	receiveThreadWork = true;
+
+	while (!stopThreadsFlag)
+	{
+		int eventsCount = epoll_wait(this->epollHandle, events, 2, -1);
+		if (eventsCount < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			ids_outputErrorMessageA("ERROR serial port receive: fail wait device events.");
+			break;
+		}
+		bool deviceClosed = false;
+		for (int i = 0; i < eventsCount; i++)
+		{
+			//stop event - flag is checked by loop
+			if (events[i].data.fd != this->deviceHandle)
+			{
+				continue;
+			}
+			//data is read to next slab of ring, wait for slab is canceled by stop
+			size_t slabIndex;
+			uint8_t* slab = this->receiveSlabs->AcquireSlab(&slabIndex);
+			if (!slab)
+			{
+				break;
+			}
+			ssize_t readSize = read(this->deviceHandle, slab, this->receiveSlabs->GetSlabSize());
+			if (readSize > 0)
+			{
+				passReceivedData(slabIndex, slab, (size_t)readSize);
+				continue;
+			}
+			int readError = errno;
+			this->receiveSlabs->ReleaseSlab(slabIndex);
+			//device is removed or other side of pseudo-terminal is closed
+			if ((readSize < 0 && readError != EINTR && readError != EAGAIN) || (events[i].events & (EPOLLHUP | EPOLLERR)))
+			{
+				deviceClosed = true;
+			}
+		}
+		if (deviceClosed)
+		{
+			ids_outputErrorMessageA("ERROR serial port receive: serial device is closed.");
+			break;
+		}
+	}
+
+	//change status flag
+	receiveThreadWork = false;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+thread_local DataStreamEthernet::eventLoopWorker* DataStreamEthernet::currentWorker = nullptr;
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* start ethernet data stream - Modbus TCP server */
+bool DataStreamEthernet::StreamStart()
+{
+	//check state
+	if (transmitStreamStarted || receiveStreamStarted || receiveThreadWork || this->receiveThread.joinable() || this->workers.size())
+	{
+		return false;
+	}
+
+	//try open listen sockets of all workers and create threads
+	try
+	{
+		stopThreadsFlag = false;
+		for (size_t i = 0; i < this->workersCount; i++)
+		{
+			eventLoopWorker* worker = new eventLoopWorker;
+			worker->number = i;
+			worker->requestHandler = this->workersRequestHandlers[i] ? this->workersRequestHandlers[i] : this->requestHandler;
+			this->workers.push_back(worker);
+			if (!openWorker(worker))
+			{
+				throw (string)"EthernetStream ERROR: can't open listen socket or events objects of worker.";
+			}
+		}
+		//io_uring of workers is created by their threads, epoll is used if io_uring isn't available
+		this->ioUringActive = false;
+		if (this->ioUringMode)
+		{
+#ifdef IO_URING_QUEUE_SUPPORTED
+			this->ioUringActive = IoUringQueue::IsAvailable();
+#endif
+			if (!this->ioUringActive)
+			{
+				ids_outputErrorMessageA("EthernetStream: io_uring isn't available, epoll is used.");
+			}
+		}
+		//first worker - in receive thread, other workers - in own threads
+		this->receiveThread = thread(&DataStreamEthernet::receiveDataThreadFunction, this);
+		if (!this->receiveThread.joinable())
+		{
+			throw (string)"EthernetStream ERROR: can't start receive thread or stream.";
+		}
+		for (size_t i = 1; i < this->workers.size(); i++)
+		{
+			this->workers[i]->workerThread = thread(&DataStreamEthernet::workerThreadFunction, this, this->workers[i]);
+			if (!this->workers[i]->workerThread.joinable())
+			{
+				throw (string)"EthernetStream ERROR: can't start worker thread.";
+			}
+		}
+	}
+	catch (string& s)
+	{
+		ids_outputErrorMessageA(s.c_str());
+		this->StreamStop();
+		return false;
+	}
+	catch (...)
+	{
+		ids_outputErrorMessageA("EthernetStream ERROR: unknown error during start system thread.");
+		this->StreamStop();
+		return false;
+	}
+
+	//set flags about stream start
+	transmitStreamStarted = true;
+	receiveStreamStarted = true;
+
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* stop ethernet data stream, all clients are disconnected */
+bool DataStreamEthernet::StreamStop()
+{
+	//stop message for threads - flag and events for waiting threads
+	stopThreadsFlag = true;
+	for (size_t i = 0; i < this->workers.size(); i++)
+	{
+		if (this->workers[i]->stopEventHandle >= 0)
+		{
+			uint64_t eventValue = 1;
+			if (write(this->workers[i]->stopEventHandle, &eventValue, sizeof(eventValue)) < 0)
+			{
+				ids_outputErrorMessageA("EthernetStream ERROR: fail send stop event to receive thread.");
+			}
+		}
+	}
+	if (receiveThread.joinable())
+	{
+		receiveThread.join();
+	}
+
+	//close all connections and sockets of workers, threads are stopped
+	while (this->workers.size())
+	{
+		eventLoopWorker* worker = this->workers.back();
+		if (worker->workerThread.joinable())
+		{
+			worker->workerThread.join();
+		}
+		closeWorker(worker);
+		delete worker;
+		this->workers.pop_back();
+	}
+
+	this->ioUringActive = false;
+	transmitStreamStarted = false;
+	receiveStreamStarted = false;
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* send data to client of data in process, data is sent after return from data receive function */
+bool DataStreamEthernet::SendData(uint8_t* data, size_t dataLength)
+{
+	//check input
+	if (!data || !dataLength)
+	{
+		return false;
+	}
+	//client of data in process - of worker that called data receive function
+	eventLoopWorker* worker = currentWorker;
+	if (!worker || !worker->currentConnection)
+	{
+		ids_outputErrorMessageA("ERROR Ethernet transmit: no client for data, data is sent only from data receive function.");
+		this->lastTransmitState = false;
+		return false;
+	}
+	worker->transmitBuffer.insert(worker->transmitBuffer.end(), data, data + dataLength);
+	this->lastTransmitState = true;
+	return true;
+}
+
+/* send frame of segments to client of data in process - segments are sent at once without copy or added to answers of received data */
+//no answers of connection wait send (epoll worker) - segments are sent by sendmsg from memory of caller,
+//rest not sent because of full socket buffer is added to answers and is sent on free space event
+bool DataStreamEthernet::SendDataSegments(const DataSegment* segments, size_t segmentsCount)
+{
+	//check input
+	if (!segments || !segmentsCount)
+	{
+		return false;
+	}
+	eventLoopWorker* worker = currentWorker;
+	if (!worker || !worker->currentConnection)
+	{
+		ids_outputErrorMessageA("ERROR Ethernet transmit: no client for data, data is sent only from data receive function.");
+		this->lastTransmitState = false;
+		return false;
+	}
+	clientConnection* connection = worker->currentConnection;
+	size_t sentLength = 0;
+	bool sendAtOnce = worker->transmitBuffer.empty() && connection->output.empty();
+#ifdef IO_URING_QUEUE_SUPPORTED
+	//io_uring worker - answers are sent by send operations of ring
+	sendAtOnce = sendAtOnce && !worker->ring.IsOpen();
+#endif
+	if (sendAtOnce)
+	{
+		msghdr message = {};
+		message.msg_iov = const_cast <iovec*>(DataSegmentsToIovec(segments));
+		message.msg_iovlen = segmentsCount;
+		ssize_t sent;
+		do
+		{
+			sent = sendmsg(connection->socket, &message, MSG_NOSIGNAL);
+		} while (sent < 0 && errno == EINTR);
+		//error of connection is found by send of rest
+		sentLength = (sent > 0) ? (size_t)sent : 0;
+	}
+	//not sent rest of segments
+	for (size_t i = 0; i < segmentsCount; i++)
+	{
+		if (sentLength >= segments[i].length)
+		{
+			sentLength -= segments[i].length;
+			continue;
+		}
+		worker->transmitBuffer.insert(worker->transmitBuffer.end(), segments[i].data + sentLength, segments[i].data + segments[i].length);
+		sentLength = 0;
+	}
+	this->lastTransmitState = true;
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* open listen socket, epoll and stop event of worker */
+bool DataStreamEthernet::openWorker(eventLoopWorker* worker)
+{
+	//listen socket - not blocking, port can be used again immediately after stop;
+	//listen sockets of several workers share one port
+	worker->listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (worker->listenSocket < 0)
+	{
+		return false;
+	}
+	int option = 1;
+	setsockopt(worker->listenSocket, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option));
+	if (this->workersCount > 1 && setsockopt(worker->listenSocket, SOL_SOCKET, SO_REUSEPORT, &option, sizeof(option)) < 0)
+	{
+		return false;
+	}
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(this->port);
+	if (bind(worker->listenSocket, (sockaddr*)&address, sizeof(address)) < 0)
+	{
+		ids_outputErrorMessageA("EthernetStream ERROR: can't bind socket to port.");
+		return false;
+	}
+	if (listen(worker->listenSocket, SOMAXCONN) < 0)
+	{
+		return false;
+	}
+
+	//epoll for all sockets of worker and event for stop of thread
+	worker->epollHandle = epoll_create1(EPOLL_CLOEXEC);
+	worker->stopEventHandle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (worker->epollHandle < 0 || worker->stopEventHandle < 0)
+	{
+		return false;
+	}
+	//listen socket is edge triggered - all connections are accepted at once
+	epoll_event event = {};
+	event.events = EPOLLIN | EPOLLET;
+	event.data.ptr = &worker->listenSocket;
+	if (epoll_ctl(worker->epollHandle, EPOLL_CTL_ADD, worker->listenSocket, &event) < 0)
+	{
+		return false;
+	}
+	event.events = EPOLLIN;
+	event.data.ptr = &worker->stopEventHandle;
+	return epoll_ctl(worker->epollHandle, EPOLL_CTL_ADD, worker->stopEventHandle, &event) == 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* close all connections and sockets of worker, thread of worker is stopped */
+void DataStreamEthernet::closeWorker(eventLoopWorker* worker)
+{
+	while (worker->connections.size())
+	{
+		closeConnection(worker, worker->connections.back());
+	}
+	if (worker->listenSocket >= 0)
+	{
+		close(worker->listenSocket);
+		worker->listenSocket = -1;
+	}
+	if (worker->epollHandle >= 0)
+	{
+		close(worker->epollHandle);
+		worker->epollHandle = -1;
+	}
+	if (worker->stopEventHandle >= 0)
+	{
+		close(worker->stopEventHandle);
+		worker->stopEventHandle = -1;
+	}
+#ifdef IO_URING_QUEUE_SUPPORTED
+	worker->ring.Close();
+#endif
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* thread for receive data - event loop of first worker */
+void DataStreamEthernet::receiveDataThreadFunction()
+{
+	//change status flag
+	receiveThreadWork = true;
+
+	workerThreadFunction(this->workers[0]);
+
+	//change status flag
+	receiveThreadWork = false;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* worker thread - event loop of listen socket and client connections of worker */
+void DataStreamEthernet::workerThreadFunction(eventLoopWorker* worker)
+{
+	const int eventsMaxCount = 256;
+	epoll_event events[eventsMaxCount];
+
+	currentWorker = worker;
+	if (this->workersPinning)
+	{
+		pinWorkerThread(worker);
+	}
+#ifdef IO_URING_QUEUE_SUPPORTED
+	//io_uring is used only by thread of worker, epoll - if io_uring of worker can't be created
+	if (this->ioUringActive)
+	{
+		if (openWorkerRing(worker))
+		{
+			ioUringWorkerLoop(worker);
+			return;
+		}
+		ids_outputErrorMessageA("EthernetStream ERROR: can't create io_uring of worker, epoll is used.");
+	}
+#endif
+
+	while (!stopThreadsFlag)
+	{
+		//wait events of sockets or stop event
+		int eventsCount = epoll_wait(worker->epollHandle, events, eventsMaxCount, -1);
+		if (eventsCount < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			ids_outputErrorMessageA("ERROR Ethernet receive: fail wait sockets events.");
+			break;
+		}
+		for (int i = 0; i < eventsCount; i++)
+		{
+			//stop event - flag is checked by loop
+			if (events[i].data.ptr == &worker->stopEventHandle)
+			{
+				continue;
+			}
+			//new connections
+			if (events[i].data.ptr == &worker->listenSocket)
+			{
+				acceptConnections(worker);
+				continue;
+			}
+			//client data or free space for answers, connection is closed by client or on error
+			clientConnection* connection = (clientConnection*)events[i].data.ptr;
+			bool connectionAlive = true;
+			if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+			{
+				connectionAlive = receiveConnectionData(worker, connection);
+			}
+			if (connectionAlive && (events[i].events & EPOLLOUT))
+			{
+				connectionAlive = sendConnectionData(worker, connection);
+			}
+			if (!connectionAlive)
+			{
+				closeConnection(worker, connection);
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* pin thread of worker to core: worker N - to N-th core of process affinity mask, cores are used again for more workers */
+void DataStreamEthernet::pinWorkerThread(eventLoopWorker* worker)
+{
+	cpu_set_t processCores;
+	CPU_ZERO(&processCores);
+	if (sched_getaffinity(0, sizeof(processCores), &processCores) != 0 || !CPU_COUNT(&processCores))
+	{
+		return;
+	}
+	size_t coreIndex = worker->number % (size_t)CPU_COUNT(&processCores);
+	for (int core = 0; core < CPU_SETSIZE; core++)
+	{
+		if (!CPU_ISSET(core, &processCores))
+		{
+			continue;
+		}
+		if (!coreIndex--)
+		{
+			cpu_set_t workerCore;
+			CPU_ZERO(&workerCore);
+			CPU_SET(core, &workerCore);
+			if (pthread_setaffinity_np(pthread_self(), sizeof(workerCore), &workerCore) != 0)
+			{
+				ids_outputErrorMessageA("EthernetStream ERROR: can't pin worker thread to core.");
+			}
+			return;
+		}
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* accept all new connections of worker, connections over limit of all workers are closed */
+void DataStreamEthernet::acceptConnections(eventLoopWorker* worker)
+{
+	while (1)
+	{
+		int clientSocket = accept4(worker->listenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (clientSocket < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+			{
+				continue;
+			}
+			//no more connections or no free resources - connections are accepted on next event
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				ids_outputErrorMessageA("ERROR Ethernet receive: fail accept connection.");
+			}
+			return;
+		}
+		//add connection to list and to events
+		clientConnection* connection = addConnection(worker, clientSocket);
+		if (!connection)
+		{
+			continue;
+		}
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.ptr = connection;
+		if (epoll_ctl(worker->epollHandle, EPOLL_CTL_ADD, clientSocket, &event) < 0)
+		{
+			closeConnection(worker, connection);
+			continue;
+		}
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/* add accepted connection to list of worker, connection over limit is closed; nullptr - connection is closed */
+DataStreamEthernet::clientConnection* DataStreamEthernet::addConnection(eventLoopWorker* worker, int clientSocket)
+{
+	if (this->connectionsCount.fetch_add(1) >= this->maxConnections)
+	{
+		this->connectionsCount--;
+		close(clientSocket);
+		return nullptr;
+	}
+	//answers are sent without delay
+	int option = 1;
+	setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option));
+
+	clientConnection* connection = nullptr;
+	try
+	{
+		connection = new clientConnection;
+		connection->socket = clientSocket;
+		connection->index = worker->connections.size();
+		worker->connections.push_back(connection);
+	}
+	catch (...)
+	{
+		ids_outputErrorMessageA("ERROR Ethernet receive: no memory for new connection.");
+		delete connection;
+		close(clientSocket);
+		this->connectionsCount--;
+		return nullptr;
+	}
+	return connection;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* receive and process client data, false - connection must be closed */
+bool DataStreamEthernet::receiveConnectionData(eventLoopWorker* worker, clientConnection* connection)
+{
+	while (1)
+	{
+		//not complete frame of previous receive is placed before new data
+		size_t keptSize = connection->inputSize;
+		memcpy(worker->receiveBuffer, connection->input, keptSize);
+		ssize_t received = recv(connection->socket, worker->receiveBuffer + keptSize, receiveBufferSize, 0);
+		if (received == 0)
+		{
+			//closed by client
+			return false;
+		}
+		if (received < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			//all data received or error
+			return (errno == EAGAIN || errno == EWOULDBLOCK);
+		}
+
+		//process data, send all answers for received data at once
+		if (!processConnectionData(worker, connection, worker->receiveBuffer, keptSize + (size_t)received, keptSize))
+		{
+			return false;
+		}
+		if (connection->output.size() && !sendConnectionData(worker, connection))
+		{
+			return false;
+		}
+
+		//socket buffer is empty - wait next event
+		if ((size_t)received < receiveBufferSize)
+		{
+			return true;
+		}
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/* process received data: kept not complete frame and new data after it; answers are added to not sent answers of connection,
+not complete frame is kept by connection; false - connection must be closed */
+bool DataStreamEthernet::processConnectionData(eventLoopWorker* worker, clientConnection* connection, uint8_t* data, size_t dataLength, size_t keptSize)
+{
+	//answers are collected in transmit buffer of worker
+	size_t parsedLength = dataLength;
+	worker->currentConnection = connection;
+	if (worker->requestHandler)
+	{
+		//Modbus TCP frames, client with wrong MBAP header is disconnected
+		if (!parseConnectionFrames(worker, data, dataLength, &parsedLength))
+		{
+			worker->currentConnection = nullptr;
+			worker->transmitBuffer.clear();
+			return false;
+		}
+	}
+	else
+	{
+		//call external handler for data - free function
+		if (this->dataReceiveFunc)
+		{
+			this->dataReceiveFunc(data + keptSize, dataLength - keptSize);
+		}
+		//call external handler for data - function of object
+		if (this->dataReceiveFuncObj)
+		{
+			this->dataReceiveFuncObj(data + keptSize, dataLength - keptSize);
+		}
+	}
+	worker->currentConnection = nullptr;
+
+	//keep not complete frame
+	connection->inputSize = dataLength - parsedLength;
+	memcpy(connection->input, data + parsedLength, connection->inputSize);
+
+	//answers for data
+	if (worker->transmitBuffer.size())
+	{
+		if (connection->output.empty())
+		{
+			connection->output.swap(worker->transmitBuffer);
+		}
+		else
+		{
+			connection->output.insert(connection->output.end(), worker->transmitBuffer.begin(), worker->transmitBuffer.end());
+			worker->transmitBuffer.clear();
+		}
+	}
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* process all complete Modbus TCP frames in data, parsed length - size of processed frames, false - wrong MBAP header */
+bool DataStreamEthernet::parseConnectionFrames(eventLoopWorker* worker, const uint8_t* data, size_t dataLength, size_t* parsedLength)
+{
+	uint8_t answer[mbapFrameMaxSize];
+	size_t position = 0;
+	while (dataLength - position >= mbapHeaderSize)
+	{
+		//MBAP header: transaction identifier, protocol identifier = 0, length of unit identifier and PDU, unit identifier
+		const uint8_t* frame = data + position;
+		uint16_t protocolId = (uint16_t)frame[2] << 8 | frame[3];
+		uint16_t length = (uint16_t)frame[4] << 8 | frame[5];
+		if (protocolId != 0 || length < 2 || length > mbapFrameMaxSize - 6)
+		{
+			return false;
+		}
+		if (dataLength - position < (size_t)length + 6)
+		{
+			//not complete frame
+			break;
+		}
+		//answer with transaction and unit identifiers of request
+		size_t answerLength = worker->requestHandler(frame[6], frame + mbapHeaderSize, length - 1, answer + mbapHeaderSize, sizeof(answer) - mbapHeaderSize);
+		if (answerLength)
+		{
+			answer[0] = frame[0];
+			answer[1] = frame[1];
+			answer[2] = 0;
+			answer[3] = 0;
+			answer[4] = (uint8_t)((answerLength + 1) >> 8);
+			answer[5] = (uint8_t)(answerLength + 1);
+			answer[6] = frame[6];
+			worker->transmitBuffer.insert(worker->transmitBuffer.end(), answer, answer + mbapHeaderSize + answerLength);
+		}
+		position += (size_t)length + 6;
+	}
+	*parsedLength = position;
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* send not sent answers of client, rest is sent on free space event; false - connection must be closed */
+bool DataStreamEthernet::sendConnectionData(eventLoopWorker* worker, clientConnection* connection)
+{
+	while (connection->outputSent < connection->output.size())
+	{
+		ssize_t sent = send(connection->socket, connection->output.data() + connection->outputSent,
+			connection->output.size() - connection->outputSent, MSG_NOSIGNAL);
+		if (sent < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				return false;
+			}
+			//socket buffer is full - client that doesn't read answers is disconnected
+			if (connection->output.size() - connection->outputSent > connectionOutputMaxSize)
+			{
+				return false;
+			}
+			//wait free space
+			if (!connection->waitOutput)
+			{
+				epoll_event event = {};
+				event.events = EPOLLIN | EPOLLOUT;
+				event.data.ptr = connection;
+				connection->waitOutput = true;
+				return epoll_ctl(worker->epollHandle, EPOLL_CTL_MOD, connection->socket, &event) == 0;
+			}
+			return true;
+		}
+		connection->outputSent += (size_t)sent;
+	}
+
+	//all sent
+	connection->output.clear();
+	connection->outputSent = 0;
+	if (connection->waitOutput)
+	{
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.ptr = connection;
+		connection->waitOutput = false;
+		return epoll_ctl(worker->epollHandle, EPOLL_CTL_MOD, connection->socket, &event) == 0;
+	}
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* close client connection and remove it from list of worker */
+void DataStreamEthernet::closeConnection(eventLoopWorker* worker, clientConnection* connection)
+{
+	//socket is removed from epoll on close
+	close(connection->socket);
+	//last connection is moved to place of closed connection
+	clientConnection* lastConnection = worker->connections.back();
+	lastConnection->index = connection->index;
+	worker->connections[connection->index] = lastConnection;
+	worker->connections.pop_back();
+	this->connectionsCount--;
+	delete connection;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+#ifdef IO_URING_QUEUE_SUPPORTED
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* open io_uring of worker and provide its receive buffers, false - io_uring isn't available */
+bool DataStreamEthernet::openWorkerRing(eventLoopWorker* worker)
+{
+	if (!worker->ring.Init(ioUringSubmissionEntries, ioUringCompletionEntries) ||
+		!worker->ring.ProvideBuffers(0, ioUringBuffersCount, ioUringBufferSize))
+	{
+		worker->ring.Close();
+		return false;
+	}
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* event loop of worker by io_uring: operations of completions are collected and submitted at once with wait of next completions */
+void DataStreamEthernet::ioUringWorkerLoop(eventLoopWorker* worker)
+{
+	worker->acceptArmed = false;
+	worker->acceptBlocked = false;
+	worker->recycleBuffers.clear();
+	if (!armStopEvent(worker))
+	{
+		ids_outputErrorMessageA("ERROR Ethernet receive: fail start io_uring operations.");
+		return;
+	}
+
+	while (!stopThreadsFlag)
+	{
+		//buffers not returned to kernel because of full submission queue are returned again
+		while (worker->recycleBuffers.size() && worker->ring.RecycleBuffer(worker->recycleBuffers.back()))
+		{
+			worker->recycleBuffers.pop_back();
+		}
+		//accept is armed again after its end or after close of connection, if descriptors were exhausted;
+		//full submission queue - accept is armed by next loop after submit
+		if (!worker->acceptArmed && !worker->acceptBlocked)
+		{
+			armAccept(worker);
+		}
+		int result = worker->ring.Submit(1);
+		if (result < 0 && result != -EBUSY)
+		{
+			ids_outputErrorMessageA("ERROR Ethernet receive: fail wait io_uring completions.");
+			break;
+		}
+		io_uring_cqe* completion;
+		while ((completion = worker->ring.PeekCompletion()) != nullptr)
+		{
+			processRingCompletion(worker, completion);
+			worker->ring.CompletionSeen();
+		}
+	}
+
+	//stop: data isn't processed, all operations are canceled, memory of operations is freed after their completions
+	for (size_t i = 0; i < worker->connections.size(); i++)
+	{
+		worker->connections[i]->closing = true;
+	}
+	io_uring_sqe* entry = worker->ring.GetSubmissionEntry();
+	if (entry)
+	{
+		entry->opcode = IORING_OP_ASYNC_CANCEL;
+		entry->fd = -1;
+		entry->cancel_flags = IORING_ASYNC_CANCEL_ANY | IORING_ASYNC_CANCEL_ALL;
+		entry->user_data = 0;
+	}
+	while (worker->operationsCount)
+	{
+		if (worker->ring.Submit(1) < 0)
+		{
+			break;
+		}
+		io_uring_cqe* completion;
+		while ((completion = worker->ring.PeekCompletion()) != nullptr)
+		{
+			processRingCompletion(worker, completion);
+			worker->ring.CompletionSeen();
+		}
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* process one completion: new connection, received data, end of send */
+void DataStreamEthernet::processRingCompletion(eventLoopWorker* worker, const io_uring_cqe* completion)
+{
+	uint64_t operation = completion->user_data & ioUringOperationMask;
+	//multishot operation is ended by completion without "more" flag
+	bool operationEnded = !(completion->flags & IORING_CQE_F_MORE);
+	if (operationEnded)
+	{
+		worker->operationsCount--;
+	}
+	//stop event - flag is checked by loop
+	if (operation == ioUringStop)
+	{
+		return;
+	}
+
+	//new connection
+	if (operation == ioUringAccept)
+	{
+		if (operationEnded)
+		{
+			worker->acceptArmed = false;
+		}
+		if (completion->res >= 0)
+		{
+			if (stopThreadsFlag)
+			{
+				close(completion->res);
+				return;
+			}
+			clientConnection* connection = addConnection(worker, completion->res);
+			if (connection && !armReceive(worker, connection))
+			{
+				closeConnection(worker, connection);
+			}
+			return;
+		}
+		//no free descriptors or memory - accept is armed again after close of connection
+		if (completion->res == -EMFILE || completion->res == -ENFILE || completion->res == -ENOBUFS || completion->res == -ENOMEM)
+		{
+			worker->acceptBlocked = true;
+			ids_outputErrorMessageA("ERROR Ethernet receive: fail accept connection.");
+		}
+		else if (completion->res != -ECONNABORTED && completion->res != -EINTR && completion->res != -ECANCELED)
+		{
+			ids_outputErrorMessageA("ERROR Ethernet receive: fail accept connection.");
+		}
+		return;
+	}
+
+	clientConnection* connection = (clientConnection*)(uintptr_t)(completion->user_data & ~(uint64_t)ioUringOperationMask);
+	if (operationEnded)
+	{
+		connection->operationsCount--;
+	}
+	if (operation == ioUringReceive)
+	{
+		if (completion->flags & IORING_CQE_F_BUFFER)
+		{
+			uint16_t bufferId = (uint16_t)(completion->flags >> IORING_CQE_BUFFER_SHIFT);
+			if (completion->res > 0 && !connection->closing)
+			{
+				//frames are parsed in provided buffer, not complete frame of previous receive is placed before new data
+				uint8_t* data = worker->ring.GetBuffer(bufferId);
+				size_t keptSize = connection->inputSize;
+				if (keptSize)
+				{
+					memcpy(worker->receiveBuffer, connection->input, keptSize);
+					memcpy(worker->receiveBuffer + keptSize, data, (size_t)completion->res);
+					data = worker->receiveBuffer;
+				}
+				if (!processConnectionData(worker, connection, data, keptSize + (size_t)completion->res, keptSize) ||
+					!submitConnectionSend(worker, connection))
+				{
+					closeRingConnection(worker, connection);
+				}
+			}
+			//full submission queue - buffer is returned by loop after submit, else it is lost for receive
+			if (!worker->ring.RecycleBuffer(bufferId))
+			{
+				worker->recycleBuffers.push_back(bufferId);
+			}
+		}
+		//closed by client or error; receive without free buffers is armed again
+		if (completion->res == 0 || (completion->res < 0 && completion->res != -ENOBUFS))
+		{
+			closeRingConnection(worker, connection);
+		}
+		else if (operationEnded && !connection->closing && !armReceive(worker, connection))
+		{
+			closeRingConnection(worker, connection);
+		}
+	}
+	else
+	{
+		//end of send: rest of answers or next answers
+		connection->sendInFlight = false;
+		if (completion->res < 0)
+		{
+			closeRingConnection(worker, connection);
+		}
+		else
+		{
+			connection->outputSent += (size_t)completion->res;
+			if (!submitConnectionSend(worker, connection))
+			{
+				closeRingConnection(worker, connection);
+			}
+		}
+	}
+
+	//closed connection is deleted after completion of its last operation
+	if (connection->closing && !connection->operationsCount)
+	{
+		closeConnection(worker, connection);
+		worker->acceptBlocked = false;
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* multishot accept of listen socket */
+bool DataStreamEthernet::armAccept(eventLoopWorker* worker)
+{
+	io_uring_sqe* entry = worker->ring.GetSubmissionEntry();
+	if (!entry)
+	{
+		return false;
+	}
+	entry->opcode = IORING_OP_ACCEPT;
+	entry->fd = worker->listenSocket;
+	entry->ioprio = IORING_ACCEPT_MULTISHOT;
+	entry->accept_flags = SOCK_CLOEXEC;
+	entry->user_data = (uint64_t)(uintptr_t)worker | ioUringAccept;
+	worker->acceptArmed = true;
+	worker->operationsCount++;
+	return true;
+}
+
+/* wait of stop event */
+bool DataStreamEthernet::armStopEvent(eventLoopWorker* worker)
+{
+	io_uring_sqe* entry = worker->ring.GetSubmissionEntry();
+	if (!entry)
+	{
+		return false;
+	}
+	entry->opcode = IORING_OP_POLL_ADD;
+	entry->fd = worker->stopEventHandle;
+	entry->poll32_events = POLLIN;
+	entry->user_data = (uint64_t)(uintptr_t)worker | ioUringStop;
+	worker->operationsCount++;
+	return true;
+}
+
+/* multishot receive of connection to provided buffers */
+bool DataStreamEthernet::armReceive(eventLoopWorker* worker, clientConnection* connection)
+{
+	io_uring_sqe* entry = worker->ring.GetSubmissionEntry();
+	if (!entry)
+	{
+		return false;
+	}
+	entry->opcode = IORING_OP_RECV;
+	entry->fd = connection->socket;
+	entry->ioprio = IORING_RECV_MULTISHOT;
+	entry->flags = IOSQE_BUFFER_SELECT;
+	entry->buf_group = 0;
+	entry->user_data = (uint64_t)(uintptr_t)connection | ioUringReceive;
+	connection->operationsCount++;
+	worker->operationsCount++;
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* send not sent answers of connection, one send of connection is in flight; false - connection must be closed */
+bool DataStreamEthernet::submitConnectionSend(eventLoopWorker* worker, clientConnection* connection)
+{
+	//client that doesn't read answers is disconnected
+	if (connection->outputInFlight.size() - connection->outputSent + connection->output.size() > connectionOutputMaxSize)
+	{
+		return false;
+	}
+	if (connection->sendInFlight || connection->closing)
+	{
+		return true;
+	}
+	if (connection->outputSent >= connection->outputInFlight.size())
+	{
+		//all sent - next answers, answers of next data are collected in other buffer
+		connection->outputInFlight.clear();
+		connection->outputSent = 0;
+		if (connection->output.empty())
+		{
+			return true;
+		}
+		connection->outputInFlight.swap(connection->output);
+	}
+	io_uring_sqe* entry = worker->ring.GetSubmissionEntry();
+	if (!entry)
+	{
+		return false;
+	}
+	entry->opcode = IORING_OP_SEND;
+	entry->fd = connection->socket;
+	entry->addr = (uint64_t)(uintptr_t)(connection->outputInFlight.data() + connection->outputSent);
+	entry->len = (uint32_t)(connection->outputInFlight.size() - connection->outputSent);
+	entry->msg_flags = MSG_NOSIGNAL;
+	entry->user_data = (uint64_t)(uintptr_t)connection | ioUringSend;
+	connection->sendInFlight = true;
+	connection->operationsCount++;
+	worker->operationsCount++;
+	return true;
+}
+
+/* close connection: its operations are canceled, connection is deleted after their completions */
+void DataStreamEthernet::closeRingConnection(eventLoopWorker* worker, clientConnection* connection)
+{
+	if (connection->closing)
+	{
+		return;
+	}
+	connection->closing = true;
+	if (!connection->operationsCount)
+	{
+		return;
+	}
+	io_uring_sqe* entry = worker->ring.GetSubmissionEntry();
+	if (entry)
+	{
+		entry->opcode = IORING_OP_ASYNC_CANCEL;
+		entry->fd = connection->socket;
+		entry->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+		entry->user_data = 0;
+	}
+	else
+	{
+		//no free entries - operations are ended by shutdown of socket
+		shutdown(connection->socket, SHUT_RDWR);
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+#endif
+#else
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* Modbus TCP server is implemented for Linux (epoll) only */
+bool DataStreamEthernet::StreamStart()
+{
+	ids_outputErrorMessageA("EthernetStream ERROR: Modbus TCP server is not implemented for this platform.");
+	return false;
+}
+
+bool DataStreamEthernet::StreamStop()
+{
+	return true;
+}
+
+bool DataStreamEthernet::SendData(uint8_t* data, size_t dataLength)
+{
+	return false;
+}
+
+bool DataStreamEthernet::SendDataSegments(const DataSegment* segments, size_t segmentsCount)
+{
+	return false;
+}
+
+void DataStreamEthernet::receiveDataThreadFunction()
+{
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+#endif
@@ -9,15 +9,22 @@
 #define INDUSTRY_DATA_STREAMS_AL
 
 #include <stdint.h>
+#include <string.h>
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <vector>
 #include <string>
+#include <memory>
+#include <condition_variable>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <wchar.h>
 #include <functional>
 #include <iostream>
+#include "DataSegments.h"
+#include "IoUringQueue.h"
 
 using std::cout;
 using std::wcout;
@@ -55,6 +62,149 @@ inline void ids_outputErrorMessageW(const wchar_t* text)
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* bounded lock-free queue of frames for transmit: many producers (SendData of any threads), one consumer (transmit thread) */
+//cell of queue keeps frame copy and sequence number: cell is free for producer if sequence = position,
+//frame is ready for consumer if sequence = position + 1; frames are read by consumer in order of queue
+class TransmitFrameQueue
+{
+	public:
+		//max frame size: MBAP header and PDU (Modbus TCP), address, PDU and CRC (Modbus RTU)
+		static const size_t frameMaxSize = 260;
+
+		/* set capacity - frames count, rounded up to power of 2; only without producers and consumer */
+		bool Init(size_t capacity);
+		/* copy frame to queue, false - queue is full or frame is bigger than max size */
+		bool Push(const uint8_t* data, size_t dataLength);
+		/* copy frame of segments to queue - segments are gathered in cell of queue */
+		bool Push(const DataSegment* segments, size_t segmentsCount);
+		/* consumer: frame at position index from head, false - frame isn't ready */
+		bool PeekFrame(size_t index, const uint8_t** data, size_t* dataLength) const;
+		/* consumer: remove frames from head */
+		void PopFrames(size_t framesCount);
+		/* count of frames in queue, capacity */
+		size_t GetDepth(void) const
+		{
+			return this->enqueuePos.load(std::memory_order_relaxed) - this->dequeuePos.load(std::memory_order_relaxed);
+		}
+		size_t GetCapacity(void) const
+		{
+			return this->cellsMask + 1;
+		}
+
+	private:
+		struct frameCell
+		{
+			atomic <size_t> sequence;
+			size_t dataLength;
+			uint8_t data[frameMaxSize];
+		};
+		std::unique_ptr <frameCell[]> cells;
+		size_t cellsMask = 0;
+		//positions of producers and consumer in own cache lines
+		alignas(64) atomic <size_t> enqueuePos = 0;
+		alignas(64) atomic <size_t> dequeuePos = 0;
+};
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* ring of receive slabs: receive thread reads data to slabs in turn, data of slab is passed to consumers as view */
+//slab is used again after its view is released; if next slab of ring is still held by consumer, receive thread waits
+class ReceiveSlabRing
+{
+	public:
+		/* constructor: size of one slab (bytes), count of slabs */
+		ReceiveSlabRing(size_t slabSize, size_t slabsCount);
+		ReceiveSlabRing(const ReceiveSlabRing&) = delete;
+		ReceiveSlabRing& operator=(const ReceiveSlabRing&) = delete;
+
+		/* receive thread: next slab of ring, nullptr - ring is interrupted by stream stop */
+		uint8_t* AcquireSlab(size_t* slabIndex);
+		/* return slab to ring, may be called by any thread */
+		void ReleaseSlab(size_t slabIndex);
+		/* stop waiting of receive thread */
+		void Interrupt(void);
+		size_t GetSlabSize(void) const
+		{
+			return this->slabSize;
+		}
+
+	private:
+		std::unique_ptr <uint8_t[]> memory;
+		std::unique_ptr <atomic <bool>[]> slabHeld;
+		size_t slabSize;
+		size_t slabsCount;
+		size_t nextSlab = 0;
+		std::mutex ringLock;
+		std::condition_variable slabReleased;
+		bool interrupted = false;
+};
+
+/* read-only view of received data in slab of ring - move only, slab is released by Release or destructor */
+class ReceiveDataView
+{
+	public:
+		ReceiveDataView()
+		{
+		}
+		ReceiveDataView(std::shared_ptr <ReceiveSlabRing> ring, size_t slabIndex, const uint8_t* data, size_t dataLength) :
+			ring(std::move(ring)), slabIndex(slabIndex), data(data), dataLength(dataLength)
+		{
+		}
+		ReceiveDataView(ReceiveDataView&& other) noexcept
+		{
+			*this = std::move(other);
+		}
+		ReceiveDataView& operator=(ReceiveDataView&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Release();
+				this->ring = std::move(other.ring);
+				this->slabIndex = other.slabIndex;
+				this->data = other.data;
+				this->dataLength = other.dataLength;
+				other.data = nullptr;
+				other.dataLength = 0;
+			}
+			return *this;
+		}
+		ReceiveDataView(const ReceiveDataView&) = delete;
+		ReceiveDataView& operator=(const ReceiveDataView&) = delete;
+		~ReceiveDataView()
+		{
+			Release();
+		}
+
+		const uint8_t* Data(void) const
+		{
+			return this->data;
+		}
+		size_t Size(void) const
+		{
+			return this->dataLength;
+		}
+		/* data is consumed - slab returns to ring */
+		void Release(void)
+		{
+			if (this->ring)
+			{
+				this->ring->ReleaseSlab(this->slabIndex);
+				this->ring.reset();
+			}
+			this->data = nullptr;
+			this->dataLength = 0;
+		}
+
+	private:
+		//ring is kept by view - view can live longer than stream
+		std::shared_ptr <ReceiveSlabRing> ring;
+		size_t slabIndex = 0;
+		const uint8_t* data = nullptr;
+		size_t dataLength = 0;
+};
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 /* base class for industry data streams */
 class IndustryDataStreamAL
@@ -62,6 +212,8 @@ class IndustryDataStreamAL
 		//pointer to receive data function, this function is called when port received data
 		typedef void(*DataReceiveFunc)(uint8_t*, size_t);
 		typedef function <void(uint8_t*, size_t)> DataReceiveFuncObj;
+		//handler of received data view - view can be moved out to keep slab after return
+		typedef function <void(ReceiveDataView&)> DataReceiveViewFuncObj;
 
 	public:
 		//constructor
@@ -76,6 +228,9 @@ class IndustryDataStreamAL
 
 		//data send function - virtual
 		virtual bool SendData(uint8_t* data, size_t dataLength) = 0;
+		//send one frame of segments (scatter-gather), stream gathers segments by itself;
+		//default - segments are copied to one buffer for SendData
+		virtual bool SendDataSegments(const DataSegment* segments, size_t segmentsCount);
 
 		//config extrenal handler for received data
 		//overload #1
@@ -98,6 +253,32 @@ class IndustryDataStreamAL
 			}
 			return false;
 		}
+		//handler for view of received data in receive slab - it is called after handlers of data;
+		//slab is held until view is released, streams with receive slabs only (serial, COM port)
+		bool SetDataReceiveViewFunc(DataReceiveViewFuncObj receiveFunc)
+		{
+			if (receiveFunc)
+			{
+				dataReceiveViewFunc = receiveFunc;
+				return true;
+			}
+			return false;
+		}
+
+		//max size of receive slab - length of one read of COM port is DWORD, protocol handlers parse data of one read in place
+		static const size_t receiveSlabMaxSize = 65536;
+		//set size of receive slab (max data of one read) and count of slabs before stream start
+		bool SetReceiveBufferSize(size_t slabSize, size_t slabsCount = 4)
+		{
+			if (!slabSize || slabSize > receiveSlabMaxSize || !slabsCount || receiveStreamStarted)
+			{
+				return false;
+			}
+			receiveSlabSize = slabSize;
+			receiveSlabsCount = slabsCount;
+			return true;
+		}
+		size_t GetReceiveBufferSize() const { return receiveSlabSize; }
 
 		//start transmit&receive function - virtual
 		virtual bool StreamStart() = 0;
@@ -109,13 +290,38 @@ class IndustryDataStreamAL
 		bool GetLastTransmitState() const { return lastTransmitState; }
 		bool NewTransmitReady() const { return newTransmitReady; }
 
+		//set size of transmit queue (frames) before stream start, streams with transmit thread only
+		bool SetTransmitQueueSize(size_t framesCount)
+		{
+			if (!framesCount || transmitStreamStarted)
+			{
+				return false;
+			}
+			transmitQueueSize = framesCount;
+			return true;
+		}
+		//frames in transmit queue, max frames in queue, frames dropped by full queue
+		size_t GetTransmitQueueDepth() const { return transmitQueue.GetDepth(); }
+		size_t GetTransmitQueueMaxDepth() const { return transmitQueueMaxDepth; }
+		uint64_t GetTransmitQueueDrops() const { return transmitQueueDrops; }
+
 	protected:
 		//pointer to external handler for received data
 		DataReceiveFunc dataReceiveFunc = nullptr;
 		DataReceiveFuncObj dataReceiveFuncObj = nullptr;
+		DataReceiveViewFuncObj dataReceiveViewFunc = nullptr;
+
+		//receive slabs: created on stream start, ring lives while views of its slabs exist
+		size_t receiveSlabSize = 1024;
+		size_t receiveSlabsCount = 4;
+		std::shared_ptr <ReceiveSlabRing> receiveSlabs;
+		/* create ring of receive slabs */
+		bool createReceiveSlabs(void);
+		/* pass data of slab to handlers, slab is released after handlers or by view */
+		void passReceivedData(size_t slabIndex, uint8_t* data, size_t dataLength);
 
 		//send (transmit) stream state
-		bool transmitStreamStarted = false;
+		atomic <bool> transmitStreamStarted = false;
 		//get (receive) stream state
 		bool receiveStreamStarted = false;
 
@@ -132,19 +338,30 @@ class IndustryDataStreamAL
 		//flag as atomic bool to immediately terminate threads
 		atomic <bool> stopThreadsFlag = false;
 
-		//flag - last transmit state
+		//flag - last transmit state; new transmit ready - transmit queue isn't full
 		atomic <bool> lastTransmitState = false;
 		atomic <bool> newTransmitReady = true;
 
-		//data for transmit thread
-		uint8_t* dataForTransmit = nullptr;
-		size_t lenOfDataForTransmit = 0;
+		//queue of frames for transmit thread: frames of SendData are copied to queue, transmit thread writes
+		//all ready frames by one write; thread is woken by producer only if it waits
+		TransmitFrameQueue transmitQueue;
+		size_t transmitQueueSize = 64;
+		atomic <size_t> transmitQueueMaxDepth = 0;
+		atomic <uint64_t> transmitQueueDrops = 0;
+		atomic <bool> transmitThreadWaiting = false;
+		static const size_t transmitBatchMaxFrames = 16;
+
+		/* queue frame for transmit thread, wakeTransmitThread - transmit thread waits and must be woken by event */
+		bool queueTransmitFrame(const DataSegment* segments, size_t segmentsCount, bool* wakeTransmitThread);
+		/* transmit thread is going to wait event, false - queue isn't empty, wait is canceled */
+		bool prepareTransmitWait(void);
 
 		//mutex for protect transmit data
 		mutex mutex_transmitDataProtect;
 };
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
+#ifdef _WIN32
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 /* class for COM port data stream */
 class DataStreamCOM : public IndustryDataStreamAL
@@ -294,15 +511,16 @@ class DataStreamCOM : public IndustryDataStreamAL
 		//stop transmit&receive function
 		virtual bool StreamStop() override;
 
-		//data send function - virtual
+		//data send function - frame is queued for transmit thread, may be called by several threads
 		virtual bool SendData(uint8_t* data, size_t dataLength) override;
+		virtual bool SendDataSegments(const DataSegment* segments, size_t segmentsCount) override;
 
 		//function for enum available in OS Windows com ports
 		const vector <wstring>* GetAvailableCOMList();
 
 	private:
 		//thread function for transmit data
-		virtual void transmitDataThreadFunction() {};
+		virtual void transmitDataThreadFunction();
 
 		//thread function for receive data
 		virtual void receiveDataThreadFunction();
@@ -311,30 +529,455 @@ class DataStreamCOM : public IndustryDataStreamAL
 		vector <wstring> comPortsList; //available com ports list
 		HANDLE comPortHandle = INVALID_HANDLE_VALUE;
 		mutex mutex_comPortHandle;
-	#define inputBufferSize 1024
-		char inputBuffer[inputBufferSize];
 		wstring comPortName = L"NAN";
 		uint32_t baudRate = 9600;
 		uint8_t byteSize = 8;
 		uint8_t stopBits = ONESTOPBIT;
 		uint8_t parity = NOPARITY;
 		const uint32_t comPortTotalTimeout = 1;
-		const uint32_t comPortWriteTimeout = 1;
+		const uint32_t comPortWriteWaitStep = 100;
 		const uint32_t comPortReadTimeout = 10000;
+		//event about new frames for transmit thread, batch of frames for one write
+		HANDLE transmitEvent = NULL;
+		uint8_t transmitBuffer[transmitBatchMaxFrames * TransmitFrameQueue::frameMaxSize];
 };
 /*-----------------------------------------------------------------------------------------------------------------------------*/
+#endif
 
+#ifdef __linux__
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* class for Ethernet port data stream */
+/* class for serial port data stream - termios tty (Linux) */
+//receive thread waits data by epoll without timeouts; read of available data is tuned by VMIN/VTIME of tty:
+//VMIN = 0, VTIME = 0 (default) - data is passed at once, VTIME > 0 - read waits pause between bytes (0.1 s units),
+//so frame comes by one call; parameters: byte size 5...8, stop bits and parity - as for DataStreamCOM (Win32 values)
+class DataStreamSerial : public IndustryDataStreamAL
+{
+	public:
+		//stop bits and parity values
+		enum serialPortOptions
+		{
+			SERIAL_ONE_STOP_BIT = 0,
+			SERIAL_TWO_STOP_BITS = 2,
+			SERIAL_NO_PARITY = 0,
+			SERIAL_ODD_PARITY = 1,
+			SERIAL_EVEN_PARITY = 2,
+			SERIAL_MARK_PARITY = 3,
+			SERIAL_SPACE_PARITY = 4
+		};
+
+		//constructor 1
+		DataStreamSerial()
+		{
+		}
+		//constructor 2
+		DataStreamSerial(const char* deviceNameIn, uint32_t baudRateIn, uint8_t byteSizeIn, uint8_t stopBitsIn, uint8_t parityIn)
+		{
+			//check input data
+			try
+			{
+				if (!deviceNameIn || !strlen(deviceNameIn))
+				{
+					throw (string)"SerialStream ERROR: bad name of serial device.";
+				}
+				if (!baudRateSupported(baudRateIn))
+				{
+					throw (string)"SerialStream ERROR: BaudRate value wrong";
+				}
+				if (byteSizeIn < 5 || byteSizeIn > 8)
+				{
+					throw (string)"SerialStream ERROR: byte size value wrong";
+				}
+				if (stopBitsIn != SERIAL_ONE_STOP_BIT && stopBitsIn != SERIAL_TWO_STOP_BITS)
+				{
+					throw (string)"SerialStream ERROR: stop bits value wrong";
+				}
+				if (parityIn > SERIAL_SPACE_PARITY)
+				{
+					throw (string)"SerialStream ERROR: parity value wrong";
+				}
+			}
+			catch (string& s)
+			{
+				ids_outputErrorMessageA(s.c_str());
+				return;
+			}
+			//accept input data
+			deviceName = deviceNameIn;
+			baudRate = baudRateIn;
+			byteSize = byteSizeIn;
+			stopBits = stopBitsIn;
+			parity = parityIn;
+		}
+
+		//destructor
+		~DataStreamSerial()
+		{
+			StreamStop();
+		}
+
+		//set & get serial device name (e.g. /dev/ttyS0, /dev/ttyUSB0), only for stopped stream
+		bool SetDeviceName(const char* deviceNameIn)
+		{
+			if (!deviceNameIn || !strlen(deviceNameIn) || receiveStreamStarted)
+			{
+				ids_outputErrorMessageA("SerialStream ERROR: bad name of serial device or stream is started.");
+				return false;
+			}
+			deviceName = deviceNameIn;
+			return true;
+		}
+		string GetDeviceName() const { return deviceName; }
+
+		//set & get BaudRate - standard values 50...4000000
+		bool SetBaudRate(uint32_t baudRateIn)
+		{
+			if (!baudRateSupported(baudRateIn))
+			{
+				ids_outputErrorMessageA("SerialStream ERROR: BaudRate value wrong");
+				return false;
+			}
+			baudRate = baudRateIn;
+			return true;
+		}
+		uint32_t GetBaudRate() const { return baudRate; }
+
+		//set & get byte size
+		bool SetByteSize(uint8_t byteSizeIn)
+		{
+			if (byteSizeIn < 5 || byteSizeIn > 8)
+			{
+				ids_outputErrorMessageA("SerialStream ERROR: byte size value wrong");
+				return false;
+			}
+			byteSize = byteSizeIn;
+			return true;
+		}
+		uint8_t GetByteSize() const { return byteSize; }
+
+		//set & get stop bits
+		bool SetStopBits(uint8_t stopBitsIn)
+		{
+			if (stopBitsIn != SERIAL_ONE_STOP_BIT && stopBitsIn != SERIAL_TWO_STOP_BITS)
+			{
+				ids_outputErrorMessageA("SerialStream ERROR: stop bits value wrong");
+				return false;
+			}
+			stopBits = stopBitsIn;
+			return true;
+		}
+		uint8_t GetStopBits() const { return stopBits; }
+
+		//set & get parity
+		bool SetParity(uint8_t parityIn)
+		{
+			if (parityIn > SERIAL_SPACE_PARITY)
+			{
+				ids_outputErrorMessageA("SerialStream ERROR: parity value wrong");
+				return false;
+			}
+			parity = parityIn;
+			return true;
+		}
+		uint8_t GetParity() const { return parity; }
+
+		//set VMIN (bytes) and VTIME (0.1 s) of tty, applied at stream start
+		void SetReadTiming(uint8_t minBytesIn, uint8_t interByteTimeIn)
+		{
+			readMinBytes = minBytesIn;
+			readInterByteTime = interByteTimeIn;
+		}
+		//low latency mode of serial driver (ASYNC_LOW_LATENCY) - received data isn't delayed by driver, applied at stream start;
+		//device without this mode (e.g. pseudo-terminal) works as is
+		void SetLowLatency(bool lowLatencyIn) { lowLatency = lowLatencyIn; }
+		bool GetLowLatency() const { return lowLatency; }
+
+		//start transmit&receive function
+		virtual bool StreamStart() override;
+
+		//stop transmit&receive function
+		virtual bool StreamStop() override;
+
+		//data send function - frame is queued for transmit thread, may be called by several threads
+		virtual bool SendData(uint8_t* data, size_t dataLength) override;
+		virtual bool SendDataSegments(const DataSegment* segments, size_t segmentsCount) override;
+
+	private:
+		//thread function for transmit data
+		virtual void transmitDataThreadFunction();
+
+		//thread function for receive data
+		virtual void receiveDataThreadFunction();
+
+		/* serial device config */
+		static bool baudRateSupported(uint32_t baudRateIn);
+		bool configDevice(void);
+		void closeDevice(void);
+		/* wait of transmit thread: new frames or stop, free space of tty */
+		void waitTransmitEvents(bool waitOutput);
+
+		//-----------serial port parameters-----------
+		string deviceName;
+		uint32_t baudRate = 9600;
+		uint8_t byteSize = 8;
+		uint8_t stopBits = SERIAL_ONE_STOP_BIT;
+		uint8_t parity = SERIAL_NO_PARITY;
+		uint8_t readMinBytes = 0;
+		uint8_t readInterByteTime = 0;
+		bool lowLatency = true;
+		//tty, epoll and event for thread stop; not blocking tty and event for transmit thread
+		int deviceHandle = -1;
+		int epollHandle = -1;
+		int stopEventHandle = -1;
+		int transmitHandle = -1;
+		int transmitEventHandle = -1;
+};
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+#endif
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* class for Ethernet port data stream - Modbus TCP server */
+//each worker thread serves its client connections by own listen socket and epoll (Linux), connections are distributed
+//between listen sockets of workers by kernel (SO_REUSEPORT); requests are split by MBAP header of each connection,
+//PDU of request is passed to request handler of worker and its answer is sent back with transaction identifier of request;
+//without request handler received data is passed to data receive functions as is, SendData answers to client of this data;
+//in io_uring mode worker uses own io_uring instead of epoll: multishot accept and receive to ring of provided buffers,
+//sends of all connections are submitted by one system call with wait of next completions
 class DataStreamEthernet : public IndustryDataStreamAL
 {
+		//request handler: unit identifier, request PDU and its length, place for answer PDU and its size
+		//returns answer PDU length, 0 - no answer
+		typedef function <size_t(uint8_t, const uint8_t*, size_t, uint8_t*, size_t)> RequestHandlerFuncObj;
+
 	public:
+		//constructor 1
 		DataStreamEthernet()
 		{
 		}
+		//constructor 2
+		DataStreamEthernet(uint16_t portIn)
+		{
+			port = portIn;
+		}
+
+		//destructor
 		~DataStreamEthernet()
 		{
+			StreamStop();
+		}
+
+		//set & get TCP port, port is changed only for stopped stream
+		bool SetPort(uint16_t portIn)
+		{
+			if (receiveStreamStarted)
+			{
+				ids_outputErrorMessageA("EthernetStream ERROR: port can't be changed for started stream.");
+				return false;
+			}
+			port = portIn;
+			return true;
+		}
+		uint16_t GetPort() const { return port; }
+
+		//set & get max count of client connections, new connections over limit are closed
+		bool SetMaxConnections(size_t maxConnectionsIn)
+		{
+			if (!maxConnectionsIn)
+			{
+				ids_outputErrorMessageA("EthernetStream ERROR: max connections value wrong");
+				return false;
+			}
+			maxConnections = maxConnectionsIn;
+			return true;
+		}
+		size_t GetMaxConnections() const { return maxConnections; }
+		//count of connected clients
+		size_t GetConnectionsCount() const { return connectionsCount; }
+
+		//config handler of Modbus TCP requests, set before stream start
+		bool SetRequestHandler(RequestHandlerFuncObj handler)
+		{
+			if (handler && !receiveStreamStarted)
+			{
+				requestHandler = handler;
+				return true;
+			}
+			return false;
+		}
+
+		//set & get count of worker threads, set before stream start; 1 - all connections are served by receive thread
+		bool SetWorkersCount(size_t workersCountIn)
+		{
+			if (!workersCountIn || receiveStreamStarted)
+			{
+				ids_outputErrorMessageA("EthernetStream ERROR: workers count can't be changed or value wrong.");
+				return false;
+			}
+			workersCount = workersCountIn;
+			workersRequestHandlers.resize(workersCount);
+			return true;
+		}
+		size_t GetWorkersCount() const { return workersCount; }
+
+		//config handler of requests for one worker, set before stream start; worker without own handler uses common handler;
+		//handlers of different workers are called at the same time
+		bool SetWorkerRequestHandler(size_t workerNumber, RequestHandlerFuncObj handler)
+		{
+			if (!handler || receiveStreamStarted || workerNumber >= workersCount)
+			{
+				return false;
+			}
+			workersRequestHandlers[workerNumber] = handler;
+			return true;
+		}
+
+		//pin worker threads to processor cores: worker N - to N-th core available for process
+		void SetWorkersPinning(bool pinningIn) { workersPinning = pinningIn; }
+
+		//use io_uring instead of epoll for sockets of workers, set before stream start;
+		//epoll is used if io_uring isn't available (Linux 6.0 and newer is required)
+		bool SetIoUringMode(bool ioUringModeIn)
+		{
+			if (receiveStreamStarted)
+			{
+				ids_outputErrorMessageA("EthernetStream ERROR: io_uring mode can't be changed for started stream.");
+				return false;
+			}
+			ioUringMode = ioUringModeIn;
+			return true;
 		}
+		bool GetIoUringMode() const { return ioUringMode; }
+		//io_uring is used by started stream
+		bool IsIoUringActive() const { return ioUringActive; }
+
+		//start transmit&receive function
+		virtual bool StreamStart() override;
+
+		//stop transmit&receive function
+		virtual bool StreamStop() override;
+
+		//data send function - to client of data in process, only from data receive function
+		virtual bool SendData(uint8_t* data, size_t dataLength) override;
+		virtual bool SendDataSegments(const DataSegment* segments, size_t segmentsCount) override;
+
+	private:
+		//thread function for transmit data
+		virtual void transmitDataThreadFunction() {};
+
+		//thread function for receive data - event loop of first worker
+		virtual void receiveDataThreadFunction();
+
+		//MBAP header size and max size of Modbus TCP frame - header and PDU up to 253 bytes
+		static const size_t mbapHeaderSize = 7;
+		static const size_t mbapFrameMaxSize = mbapHeaderSize + 253;
+		//max size of not sent data of one client, client is disconnected if it doesn't read answers
+		static const size_t connectionOutputMaxSize = 1024 * 1024;
+
+		//client connection: socket, not complete frame from previous receive, not sent answers
+		struct clientConnection
+		{
+			int socket = -1;
+			//position in connections list
+			size_t index = 0;
+			uint8_t input[mbapFrameMaxSize];
+			size_t inputSize = 0;
+			vector <uint8_t> output;
+			size_t outputSent = 0;
+			//socket is waited for free space in send buffer
+			bool waitOutput = false;
+			//io_uring: answers in send operation (output is sent from position outputSent), operations of connection in kernel;
+			//closed connection is deleted after completion of all its operations
+			vector <uint8_t> outputInFlight;
+			size_t operationsCount = 0;
+			bool sendInFlight = false;
+			bool closing = false;
+		};
+
+		//data of one receive call, place before data for not complete frame of connection
+		static const size_t receiveBufferSize = 65536;
+
+		//worker: event loop of own listen socket and its client connections
+		struct eventLoopWorker
+		{
+			size_t number = 0;
+			//thread of worker, first worker works in receive thread
+			thread workerThread;
+			RequestHandlerFuncObj requestHandler = nullptr;
+			//listen socket, epoll and event for thread stop
+			int listenSocket = -1;
+			int epollHandle = -1;
+			int stopEventHandle = -1;
+			//client connections of worker
+			vector <clientConnection*> connections;
+			//client of data in process and answers for this data
+			clientConnection* currentConnection = nullptr;
+			vector <uint8_t> transmitBuffer;
+			uint8_t receiveBuffer[mbapFrameMaxSize + receiveBufferSize];
+#ifdef IO_URING_QUEUE_SUPPORTED
+			//io_uring of worker, operations in kernel and state of accept operation
+			IoUringQueue ring;
+			size_t operationsCount = 0;
+			bool acceptArmed = false;
+			bool acceptBlocked = false;
+			//provided buffers that must be returned to kernel - submission queue was full
+			vector <uint16_t> recycleBuffers;
+#endif
+		};
+
+#ifdef IO_URING_QUEUE_SUPPORTED
+		//io_uring: submission entries, completion entries, provided receive buffers of worker and their size
+		static const unsigned ioUringSubmissionEntries = 1024;
+		static const unsigned ioUringCompletionEntries = 8192;
+		static const unsigned ioUringBuffersCount = 512;
+		static const size_t ioUringBufferSize = 4096;
+		//type of operation in low bits of user data, high bits - connection or worker; user data 0 - cancel operation
+		enum ioUringOperation : uint64_t
+		{
+			ioUringReceive = 0,
+			ioUringSend = 1,
+			ioUringAccept = 2,
+			ioUringStop = 3,
+			ioUringOperationMask = 3
+		};
+#endif
+
+		/* workers and connections processing */
+		bool openWorker(eventLoopWorker* worker);
+		void closeWorker(eventLoopWorker* worker);
+		void workerThreadFunction(eventLoopWorker* worker);
+		void pinWorkerThread(eventLoopWorker* worker);
+		void acceptConnections(eventLoopWorker* worker);
+		clientConnection* addConnection(eventLoopWorker* worker, int clientSocket);
+		bool receiveConnectionData(eventLoopWorker* worker, clientConnection* connection);
+		bool processConnectionData(eventLoopWorker* worker, clientConnection* connection, uint8_t* data, size_t dataLength, size_t keptSize);
+		bool parseConnectionFrames(eventLoopWorker* worker, const uint8_t* data, size_t dataLength, size_t* parsedLength);
+		bool sendConnectionData(eventLoopWorker* worker, clientConnection* connection);
+		void closeConnection(eventLoopWorker* worker, clientConnection* connection);
+#ifdef IO_URING_QUEUE_SUPPORTED
+		/* workers and connections processing by io_uring */
+		bool openWorkerRing(eventLoopWorker* worker);
+		void ioUringWorkerLoop(eventLoopWorker* worker);
+		void processRingCompletion(eventLoopWorker* worker, const io_uring_cqe* completion);
+		bool armAccept(eventLoopWorker* worker);
+		bool armStopEvent(eventLoopWorker* worker);
+		bool armReceive(eventLoopWorker* worker, clientConnection* connection);
+		bool submitConnectionSend(eventLoopWorker* worker, clientConnection* connection);
+		void closeRingConnection(eventLoopWorker* worker, clientConnection* connection);
+#endif
+
+		//-----------ethernet parameters-----------
+		uint16_t port = 502;
+		size_t maxConnections = 10000;
+		atomic <size_t> connectionsCount = 0;
+		RequestHandlerFuncObj requestHandler = nullptr;
+		//workers and their own request handlers
+		size_t workersCount = 1;
+		bool workersPinning = false;
+		bool ioUringMode = false;
+		atomic <bool> ioUringActive = false;
+		vector <RequestHandlerFuncObj> workersRequestHandlers = vector <RequestHandlerFuncObj>(1);
+		vector <eventLoopWorker*> workers;
+		//worker of calling thread, for SendData from data receive function
+		static thread_local eventLoopWorker* currentWorker;
 };
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
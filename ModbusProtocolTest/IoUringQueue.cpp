@@ -0,0 +1,325 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//io_uring queue source file. Submission and completion rings of io_uring and provided receive buffers (Linux).
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include "IoUringQueue.h"
+
+#ifdef IO_URING_QUEUE_SUPPORTED
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* system calls of io_uring */
+static int ioUringSetup(unsigned entries, io_uring_params* params)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int ioUringEnter(int ringHandle, unsigned submitCount, unsigned waitCompletions, unsigned flags)
+{
+	return (int)syscall(__NR_io_uring_enter, ringHandle, submitCount, waitCompletions, flags, nullptr, 0);
+}
+
+static int ioUringRegister(int ringHandle, unsigned opcode, void* arg, unsigned argsCount)
+{
+	return (int)syscall(__NR_io_uring_register, ringHandle, opcode, arg, argsCount);
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* create io_uring and map its rings */
+bool IoUringQueue::Init(unsigned submissionEntries, unsigned completionEntries)
+{
+	Close();
+
+	io_uring_params params;
+	//completion queue is larger than submission queue - multishot operations post many completions;
+	//task work of completions is run at wait of completions by this thread only - completions are posted by batches;
+	//older kernels without these flags - task work interrupts thread
+	const unsigned setupFlags[] = {
+		IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN,
+		IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN,
+		IORING_SETUP_CQSIZE};
+	int ringHandle = -1;
+	for (unsigned flags : setupFlags)
+	{
+		memset(&params, 0, sizeof(params));
+		params.flags = flags;
+		params.cq_entries = completionEntries;
+		ringHandle = ioUringSetup(submissionEntries, &params);
+		if (ringHandle >= 0 || errno != EINVAL)
+		{
+			break;
+		}
+	}
+	if (ringHandle < 0)
+	{
+		return false;
+	}
+	this->ringHandle = ringHandle;
+
+	//multishot receive and send zero copy are added in same kernel version - probe of send zero copy is check of multishot receive
+	uint8_t probeMemory[sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op)];
+	memset(probeMemory, 0, sizeof(probeMemory));
+	io_uring_probe* probe = reinterpret_cast <io_uring_probe*>(probeMemory);
+	if (ioUringRegister(this->ringHandle, IORING_REGISTER_PROBE, probe, 256) < 0)
+	{
+		Close();
+		return false;
+	}
+	const uint8_t requiredOperations[] = {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_POLL_ADD, IORING_OP_ASYNC_CANCEL, IORING_OP_PROVIDE_BUFFERS, IORING_OP_SEND_ZC};
+	for (uint8_t operation : requiredOperations)
+	{
+		if (operation > probe->last_op || !(probe->ops[operation].flags & IO_URING_OP_SUPPORTED))
+		{
+			Close();
+			return false;
+		}
+	}
+
+	//rings: one mapping for both rings in newer kernels
+	this->submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	this->completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		if (this->completionRingSize > this->submissionRingSize)
+		{
+			this->submissionRingSize = this->completionRingSize;
+		}
+		this->completionRingSize = 0;
+	}
+	this->submissionRingMemory = mmap(nullptr, this->submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringHandle, IORING_OFF_SQ_RING);
+	if (this->submissionRingMemory == MAP_FAILED)
+	{
+		this->submissionRingMemory = nullptr;
+		Close();
+		return false;
+	}
+	void* completionMemory = this->submissionRingMemory;
+	if (this->completionRingSize)
+	{
+		this->completionRingMemory = mmap(nullptr, this->completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringHandle, IORING_OFF_CQ_RING);
+		if (this->completionRingMemory == MAP_FAILED)
+		{
+			this->completionRingMemory = nullptr;
+			Close();
+			return false;
+		}
+		completionMemory = this->completionRingMemory;
+	}
+	this->submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+	void* entriesMemory = mmap(nullptr, this->submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringHandle, IORING_OFF_SQES);
+	if (entriesMemory == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+	this->submissionEntries = static_cast <io_uring_sqe*>(entriesMemory);
+
+	uint8_t* submissionRing = static_cast <uint8_t*>(this->submissionRingMemory);
+	this->submissionHead = reinterpret_cast <unsigned*>(submissionRing + params.sq_off.head);
+	this->submissionTail = reinterpret_cast <unsigned*>(submissionRing + params.sq_off.tail);
+	this->submissionMask = *reinterpret_cast <unsigned*>(submissionRing + params.sq_off.ring_mask);
+	this->submissionCount = params.sq_entries;
+	this->submissionLocalTail = *this->submissionTail;
+	//indirection array: entry i is in slot i, filled once
+	unsigned* submissionArray = reinterpret_cast <unsigned*>(submissionRing + params.sq_off.array);
+	for (unsigned i = 0; i < params.sq_entries; i++)
+	{
+		submissionArray[i] = i;
+	}
+
+	uint8_t* completionRing = static_cast <uint8_t*>(completionMemory);
+	this->completionHead = reinterpret_cast <unsigned*>(completionRing + params.cq_off.head);
+	this->completionTail = reinterpret_cast <unsigned*>(completionRing + params.cq_off.tail);
+	this->completionMask = *reinterpret_cast <unsigned*>(completionRing + params.cq_off.ring_mask);
+	this->completionEntries = reinterpret_cast <io_uring_cqe*>(completionRing + params.cq_off.cqes);
+	return true;
+}
+
+/* io_uring is supported by kernel */
+bool IoUringQueue::IsAvailable(void)
+{
+	IoUringQueue testQueue;
+	return testQueue.Init(8, 16);
+}
+
+/* provide buffers for receive operations */
+bool IoUringQueue::ProvideBuffers(uint16_t groupId, unsigned buffersCount, size_t bufferSize)
+{
+	if (!IsOpen() || this->buffersMemory || !buffersCount || buffersCount > 65536 || !bufferSize)
+	{
+		return false;
+	}
+	this->buffersMemorySize = buffersCount * bufferSize;
+	void* buffersMemory = mmap(nullptr, this->buffersMemorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (buffersMemory == MAP_FAILED)
+	{
+		return false;
+	}
+	this->buffersMemory = static_cast <uint8_t*>(buffersMemory);
+	this->bufferSize = bufferSize;
+	this->bufferGroupId = groupId;
+
+	//all buffers by one operation, its completion is waited here
+	io_uring_sqe* entry = GetSubmissionEntry();
+	if (!entry)
+	{
+		return false;
+	}
+	entry->opcode = IORING_OP_PROVIDE_BUFFERS;
+	entry->fd = (int)buffersCount;
+	entry->addr = (uint64_t)(uintptr_t)this->buffersMemory;
+	entry->len = (uint32_t)bufferSize;
+	entry->off = 0;
+	entry->buf_group = groupId;
+	entry->user_data = 0;
+	if (Submit(1) < 0)
+	{
+		return false;
+	}
+	unsigned head = *this->completionHead;
+	if (head == __atomic_load_n(this->completionTail, __ATOMIC_ACQUIRE))
+	{
+		return false;
+	}
+	int result = this->completionEntries[head & this->completionMask].res;
+	__atomic_store_n(this->completionHead, head + 1, __ATOMIC_RELEASE);
+	return result >= 0;
+}
+
+/* close io_uring */
+void IoUringQueue::Close(void)
+{
+	if (this->submissionEntries)
+	{
+		munmap(this->submissionEntries, this->submissionEntriesSize);
+		this->submissionEntries = nullptr;
+	}
+	if (this->completionRingMemory)
+	{
+		munmap(this->completionRingMemory, this->completionRingSize);
+		this->completionRingMemory = nullptr;
+	}
+	if (this->submissionRingMemory)
+	{
+		munmap(this->submissionRingMemory, this->submissionRingSize);
+		this->submissionRingMemory = nullptr;
+	}
+	if (this->ringHandle >= 0)
+	{
+		close(this->ringHandle);
+		this->ringHandle = -1;
+	}
+	//buffers are unmapped after ring is closed - kernel doesn't write to them
+	if (this->buffersMemory)
+	{
+		munmap(this->buffersMemory, this->buffersMemorySize);
+		this->buffersMemory = nullptr;
+	}
+	this->submissionHead = nullptr;
+	this->submissionTail = nullptr;
+	this->completionHead = nullptr;
+	this->completionTail = nullptr;
+	this->completionEntries = nullptr;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* free submission entry */
+io_uring_sqe* IoUringQueue::GetSubmissionEntry(void)
+{
+	unsigned head = __atomic_load_n(this->submissionHead, __ATOMIC_ACQUIRE);
+	if (this->submissionLocalTail - head >= this->submissionCount)
+	{
+		//queue is full - submit collected entries, kernel consumes them at io_uring_enter
+		if (Submit(0) < 0)
+		{
+			return nullptr;
+		}
+		head = __atomic_load_n(this->submissionHead, __ATOMIC_ACQUIRE);
+		if (this->submissionLocalTail - head >= this->submissionCount)
+		{
+			return nullptr;
+		}
+	}
+	io_uring_sqe* entry = &this->submissionEntries[this->submissionLocalTail & this->submissionMask];
+	memset(entry, 0, sizeof(io_uring_sqe));
+	this->submissionLocalTail++;
+	return entry;
+}
+
+/* submit collected entries and wait completions */
+int IoUringQueue::Submit(unsigned waitCompletions)
+{
+	unsigned submitCount = this->submissionLocalTail - *this->submissionTail;
+	__atomic_store_n(this->submissionTail, this->submissionLocalTail, __ATOMIC_RELEASE);
+	unsigned flags = waitCompletions ? IORING_ENTER_GETEVENTS : 0;
+	//completions are waited only if completion queue is empty
+	if (waitCompletions && __atomic_load_n(this->completionTail, __ATOMIC_ACQUIRE) != *this->completionHead)
+	{
+		waitCompletions = 0;
+		flags = 0;
+	}
+	if (!submitCount && !waitCompletions)
+	{
+		return 0;
+	}
+	int result;
+	do
+	{
+		result = ioUringEnter(this->ringHandle, submitCount, waitCompletions, flags);
+	} while (result < 0 && errno == EINTR);
+	return result < 0 ? -errno : result;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* next completion entry, completions of internal operations are skipped */
+io_uring_cqe* IoUringQueue::PeekCompletion(void)
+{
+	unsigned head = *this->completionHead;
+	unsigned tail = __atomic_load_n(this->completionTail, __ATOMIC_ACQUIRE);
+	while (head != tail && !this->completionEntries[head & this->completionMask].user_data)
+	{
+		head++;
+	}
+	__atomic_store_n(this->completionHead, head, __ATOMIC_RELEASE);
+	if (head == tail)
+	{
+		return nullptr;
+	}
+	return &this->completionEntries[head & this->completionMask];
+}
+
+/* completion entry is processed */
+void IoUringQueue::CompletionSeen(void)
+{
+	__atomic_store_n(this->completionHead, *this->completionHead + 1, __ATOMIC_RELEASE);
+}
+
+/* return buffer to kernel, completion is posted on error only */
+bool IoUringQueue::RecycleBuffer(uint16_t bufferId)
+{
+	io_uring_sqe* entry = GetSubmissionEntry();
+	if (!entry)
+	{
+		return false;
+	}
+	entry->opcode = IORING_OP_PROVIDE_BUFFERS;
+	entry->fd = 1;
+	entry->addr = (uint64_t)(uintptr_t)GetBuffer(bufferId);
+	entry->len = (uint32_t)this->bufferSize;
+	entry->off = bufferId;
+	entry->buf_group = this->bufferGroupId;
+	entry->flags = IOSQE_CQE_SKIP_SUCCESS;
+	entry->user_data = 0;
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+#endif
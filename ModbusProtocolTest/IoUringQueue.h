@@ -0,0 +1,112 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//io_uring queue header file. Submission and completion rings of io_uring and provided receive buffers (Linux).
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#ifndef IO_URING_QUEUE
+#define IO_URING_QUEUE
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define IO_URING_QUEUE_SUPPORTED
+#endif
+#endif
+
+#ifdef IO_URING_QUEUE_SUPPORTED
+#include <stdint.h>
+#include <stddef.h>
+#include <linux/io_uring.h>
+
+//flags of Linux 6.1 for older headers
+#ifndef IORING_SETUP_SINGLE_ISSUER
+#define IORING_SETUP_SINGLE_ISSUER (1U << 12)
+#endif
+#ifndef IORING_SETUP_DEFER_TASKRUN
+#define IORING_SETUP_DEFER_TASKRUN (1U << 13)
+#endif
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* io_uring by system calls, without liburing: thread that created io_uring fills submission queue and reads completion queue */
+//submission entries are collected and submitted by one io_uring_enter together with wait of completions;
+//provided buffers (IORING_OP_PROVIDE_BUFFERS) - kernel selects buffer for each receive, buffer is returned by RecycleBuffer;
+//operations with user data 0 are internal - their completions are skipped by PeekCompletion
+class IoUringQueue
+{
+	public:
+		IoUringQueue()
+		{
+
+		}
+		~IoUringQueue()
+		{
+			Close();
+		}
+		IoUringQueue(const IoUringQueue&) = delete;
+		IoUringQueue& operator=(const IoUringQueue&) = delete;
+
+		/* create io_uring: submission entries count, completion entries count; false - io_uring isn't available */
+		//kernel must support multishot accept and receive (Linux 6.0 and newer); completions are posted
+		//at wait of this thread only (Linux 6.1 and newer), io_uring can't be used by other threads
+		bool Init(unsigned submissionEntries, unsigned completionEntries);
+		/* io_uring with required operations is supported by kernel */
+		static bool IsAvailable(void);
+		/* provide buffers for receive operations: group of buffers, count, size of one buffer */
+		bool ProvideBuffers(uint16_t groupId, unsigned buffersCount, size_t bufferSize);
+		/* close io_uring, operations in flight are canceled by kernel */
+		void Close(void);
+		bool IsOpen(void) const
+		{
+			return this->ringHandle >= 0;
+		}
+
+		/* free submission entry, entries are submitted by Submit; nullptr - queue is full and can't be submitted */
+		io_uring_sqe* GetSubmissionEntry(void);
+		/* submit collected entries and wait completions count, returns count of submitted entries or -errno */
+		int Submit(unsigned waitCompletions);
+
+		/* completions: next completion entry or nullptr, entry is freed by CompletionSeen */
+		io_uring_cqe* PeekCompletion(void);
+		void CompletionSeen(void);
+
+		/* provided buffers: data of buffer by identifier from completion flags, return buffer to kernel with next submit */
+		uint8_t* GetBuffer(uint16_t bufferId) const
+		{
+			return this->buffersMemory + (size_t)bufferId * this->bufferSize;
+		}
+		bool RecycleBuffer(uint16_t bufferId);
+
+	private:
+		int ringHandle = -1;
+		//mapped memory of rings and submission entries
+		void* submissionRingMemory = nullptr;
+		size_t submissionRingSize = 0;
+		void* completionRingMemory = nullptr;
+		size_t completionRingSize = 0;
+		io_uring_sqe* submissionEntries = nullptr;
+		size_t submissionEntriesSize = 0;
+
+		//submission queue: head is moved by kernel, tail - by this thread
+		unsigned* submissionHead = nullptr;
+		unsigned* submissionTail = nullptr;
+		unsigned submissionMask = 0;
+		unsigned submissionCount = 0;
+		//tail of filled entries, not submitted to kernel yet
+		unsigned submissionLocalTail = 0;
+
+		//completion queue: tail is moved by kernel, head - by this thread
+		unsigned* completionHead = nullptr;
+		unsigned* completionTail = nullptr;
+		unsigned completionMask = 0;
+		io_uring_cqe* completionEntries = nullptr;
+
+		//memory of provided buffers
+		uint8_t* buffersMemory = nullptr;
+		size_t buffersMemorySize = 0;
+		size_t bufferSize = 0;
+		uint16_t bufferGroupId = 0;
+};
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+#endif
+
+#endif
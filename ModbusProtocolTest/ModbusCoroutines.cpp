@@ -0,0 +1,164 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//MODBUS master coroutines source file. Awaitable master transactions on single thread executor (C++20).
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include "ModbusCoroutines.h"
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* coroutine is finished - frame is destroyed */
+ModbusTask::promise_type::~promise_type()
+{
+	if (this->executor)
+	{
+		this->executor->taskFinished();
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* start coroutine */
+void ModbusCoroutineExecutor::Spawn(ModbusTask task)
+{
+	std::coroutine_handle <ModbusTask::promise_type> handle = task.coroutineHandle;
+	if (!handle)
+	{
+		return;
+	}
+	//frame is owned by executor since this moment
+	task.coroutineHandle = nullptr;
+	handle.promise().executor = this;
+	this->tasksCount++;
+	Post(handle);
+}
+
+/* queue coroutine for resume */
+void ModbusCoroutineExecutor::Post(std::coroutine_handle <> handle)
+{
+	{
+		std::lock_guard <std::mutex> lock(this->readyLock);
+		this->readyCoroutines.push_back(handle);
+	}
+	this->readyEvent.notify_one();
+}
+
+/* stop Run */
+void ModbusCoroutineExecutor::Stop(void)
+{
+	{
+		std::lock_guard <std::mutex> lock(this->readyLock);
+		this->stopRequested = true;
+	}
+	this->readyEvent.notify_one();
+}
+
+/* coroutine is finished */
+void ModbusCoroutineExecutor::taskFinished(void)
+{
+	if (--this->tasksCount == 0)
+	{
+		std::lock_guard <std::mutex> lock(this->readyLock);
+		this->readyEvent.notify_one();
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* resume queued coroutines without wait */
+size_t ModbusCoroutineExecutor::RunReady(void)
+{
+	{
+		std::lock_guard <std::mutex> lock(this->readyLock);
+		this->resumedCoroutines.swap(this->readyCoroutines);
+	}
+	//coroutines resumed now can queue itself or others again - to next pass
+	size_t resumedCount = this->resumedCoroutines.size();
+	for (size_t i = 0; i < resumedCount; i++)
+	{
+		this->resumedCoroutines[i].resume();
+	}
+	this->resumedCoroutines.clear();
+	return resumedCount;
+}
+
+/* resume coroutines until all are finished or Stop is called */
+void ModbusCoroutineExecutor::Run(void)
+{
+	for (;;)
+	{
+		{
+			std::unique_lock <std::mutex> lock(this->readyLock);
+			this->readyEvent.wait(lock, [this]() {
+				return this->stopRequested || !this->readyCoroutines.empty() || !this->tasksCount; });
+			if (this->stopRequested)
+			{
+				this->stopRequested = false;
+				return;
+			}
+			if (this->readyCoroutines.empty())
+			{
+				//all coroutines are finished
+				return;
+			}
+		}
+		RunReady();
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* send request of awaiter, coroutine is resumed by executor after transaction */
+bool ModbusTransactionAwaiter::await_suspend(std::coroutine_handle <ModbusTask::promise_type> handle)
+{
+	//fields are set before send - answer can be received by other thread before return from send
+	this->executor = handle.promise().executor;
+	this->coroutineHandle = handle;
+	if (!this->master || !this->executor)
+	{
+		return false;
+	}
+	//callback captures only pointer to awaiter - it is stored inside std::function without allocation;
+	//awaiter can be destroyed by resumed coroutine at once after Post
+	ModbusProtocolMaster::TransactionCallbackFuncObj callback = [this](int transactionResult) {
+		this->result = transactionResult;
+		this->executor->Post(this->coroutineHandle);
+	};
+	bool requestSent = false;
+	switch (this->operation)
+	{
+		case AWAIT_READ_REQUEST:
+			requestSent = this->master->SendReadRequest(this->functionCode, this->startingAddress, this->quantityOfData, callback);
+			break;
+		case AWAIT_WRITE_REQUEST:
+			requestSent = this->master->SendWriteRequest(this->functionCode, this->startingAddress, this->quantityOfData, callback);
+			break;
+		case AWAIT_READ_ALL_REGISTERS:
+			requestSent = this->master->ReadAllRegistersAsync(callback);
+			break;
+	}
+	if (!requestSent)
+	{
+		this->result = ModbusProtocolMaster::MT_SEND_ERROR;
+	}
+	return requestSent;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* awaitable transactions of master */
+ModbusTransactionAwaiter ModbusProtocolMaster::AwaitReadRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData)
+{
+	return ModbusTransactionAwaiter(this, ModbusTransactionAwaiter::AWAIT_READ_REQUEST, functionCode, startingAddress, quantityOfData);
+}
+
+ModbusTransactionAwaiter ModbusProtocolMaster::AwaitWriteRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData)
+{
+	return ModbusTransactionAwaiter(this, ModbusTransactionAwaiter::AWAIT_WRITE_REQUEST, functionCode, startingAddress, quantityOfData);
+}
+
+ModbusTransactionAwaiter ModbusProtocolMaster::AwaitReadAllRegisters(void)
+{
+	return ModbusTransactionAwaiter(this, ModbusTransactionAwaiter::AWAIT_READ_ALL_REGISTERS);
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
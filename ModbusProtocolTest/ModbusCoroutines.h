@@ -0,0 +1,174 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//MODBUS master coroutines header file. Awaitable master transactions on single thread executor (C++20).
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#ifndef MODBUS_COROUTINES
+#define MODBUS_COROUTINES
+
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <condition_variable>
+#include "ModbusProtocolHandler.h"
+
+class ModbusCoroutineExecutor;
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* coroutine of executor - created suspended, started by ModbusCoroutineExecutor::Spawn, frame is destroyed at end */
+//e.g.: ModbusTask PollDevice(ModbusProtocolMaster& master) { int result = co_await master.AwaitReadRequest(3, 0, 10); ... }
+class ModbusTask
+{
+	public:
+		struct promise_type
+		{
+			//executor of coroutine, set by Spawn
+			ModbusCoroutineExecutor* executor = nullptr;
+
+			ModbusTask get_return_object(void)
+			{
+				return ModbusTask(std::coroutine_handle <promise_type>::from_promise(*this));
+			}
+			std::suspend_always initial_suspend(void) noexcept
+			{
+				return {};
+			}
+			std::suspend_never final_suspend(void) noexcept
+			{
+				return {};
+			}
+			void return_void(void)
+			{
+
+			}
+			void unhandled_exception(void)
+			{
+				std::terminate();
+			}
+			/* destructor - coroutine is finished */
+			~promise_type();
+		};
+
+		ModbusTask(ModbusTask&& other) noexcept : coroutineHandle(other.coroutineHandle)
+		{
+			other.coroutineHandle = nullptr;
+		}
+		ModbusTask(const ModbusTask&) = delete;
+		ModbusTask& operator=(const ModbusTask&) = delete;
+
+		/* destructor - coroutine isn't started */
+		~ModbusTask()
+		{
+			if (this->coroutineHandle)
+			{
+				this->coroutineHandle.destroy();
+			}
+		}
+
+	private:
+		friend class ModbusCoroutineExecutor;
+		explicit ModbusTask(std::coroutine_handle <promise_type> handle) : coroutineHandle(handle)
+		{
+
+		}
+		std::coroutine_handle <promise_type> coroutineHandle;
+};
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* single thread executor of coroutines - all coroutines are resumed by thread of Run */
+//completion of transaction (receive thread, timeout timer) only queues coroutine to executor
+class ModbusCoroutineExecutor
+{
+	public:
+		/* constructor */
+		ModbusCoroutineExecutor()
+		{
+			this->readyCoroutines.reserve(readyQueueReserve);
+			this->resumedCoroutines.reserve(readyQueueReserve);
+		}
+
+		/* destructor */
+		~ModbusCoroutineExecutor()
+		{
+
+		}
+
+		/* start coroutine - it runs up to first co_await in next Run */
+		void Spawn(ModbusTask task);
+		/* queue suspended coroutine for resume, may be called from any thread */
+		void Post(std::coroutine_handle <> handle);
+		/* resume coroutines in this thread until all coroutines are finished or Stop is called */
+		void Run(void);
+		/* resume queued coroutines without wait, returns count of resumed coroutines */
+		size_t RunReady(void);
+		/* stop Run, may be called from any thread */
+		void Stop(void);
+		/* count of not finished coroutines */
+		size_t GetTasksCount(void) const
+		{
+			return this->tasksCount;
+		}
+
+	private:
+		friend struct ModbusTask::promise_type;
+		/* coroutine is finished */
+		void taskFinished(void);
+
+		static const size_t readyQueueReserve = 1024;
+		//queue of coroutines ready to resume; queue is swapped with resumed list, so capacity is reused
+		std::mutex readyLock;
+		std::condition_variable readyEvent;
+		vector <std::coroutine_handle <>> readyCoroutines;
+		vector <std::coroutine_handle <>> resumedCoroutines;
+		std::atomic <size_t> tasksCount = 0;
+		bool stopRequested = false;
+};
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* awaitable transaction of master - result of co_await is result of transaction (see ModbusProtocolMaster::masterTransactionErrors) */
+//awaiter lives in coroutine frame, transaction callback refers to it - no allocation per request;
+//MT_SEND_ERROR is returned at once without suspend (window is full, RTU request in flight, request error)
+class ModbusTransactionAwaiter
+{
+	public:
+		enum awaitedOperations
+		{
+			AWAIT_READ_REQUEST,
+			AWAIT_WRITE_REQUEST,
+			AWAIT_READ_ALL_REGISTERS
+		};
+
+		ModbusTransactionAwaiter(ModbusProtocolMaster* master, awaitedOperations operation,
+			uint8_t functionCode = 0, uint16_t startingAddress = 0, uint16_t quantityOfData = 0) :
+			master(master), operation(operation), functionCode(functionCode), startingAddress(startingAddress), quantityOfData(quantityOfData)
+		{
+
+		}
+
+		bool await_ready(void) const noexcept
+		{
+			return false;
+		}
+		/* send request, false - request isn't sent, coroutine continues */
+		bool await_suspend(std::coroutine_handle <ModbusTask::promise_type> handle);
+		int await_resume(void) const noexcept
+		{
+			return this->result;
+		}
+
+	private:
+		ModbusProtocolMaster* master;
+		awaitedOperations operation;
+		uint8_t functionCode;
+		uint16_t startingAddress;
+		uint16_t quantityOfData;
+		int result = ModbusProtocolMaster::MT_SEND_ERROR;
+		ModbusCoroutineExecutor* executor = nullptr;
+		std::coroutine_handle <> coroutineHandle;
+};
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+#endif
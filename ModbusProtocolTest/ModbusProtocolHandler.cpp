@@ -8,70 +8,202 @@
 #include "ModbusProtocolHandler.h"
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* platform specified user defined functions for count timeout */
+/* functions for count timeout - timers of wheel with own thread on monotonic clock */
+//timerID - previous timer of caller, it is stopped
 UINT StartTimeoutTimer(int timeout, function <void()> callbackFunc, UINT timerID)
 {
-	return SetTimer(0, timerID, timeout, (TIMERPROC)&callbackFunc);
+	if (timerID)
+	{
+		ModbusTimerWheel::DefaultWheel().StopTimer(timerID);
+	}
+	return ModbusTimerWheel::DefaultWheel().StartTimer(timeout > 0 ? (uint32_t)timeout : 0, std::move(callbackFunc));
 }
 
 bool StopTimeoutTimer(UINT timerID)
 {
-	return (bool)KillTimer(0, timerID);
+	return ModbusTimerWheel::DefaultWheel().StopTimer(timerID);
+}
+
+void WaitTimeoutCallbacks(void)
+{
+	ModbusTimerWheel::DefaultWheel().WaitExpiredCallbacks();
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* private util function: not check this object state and port state, not check this object config */
-bool ModbusProtocolMaster::requestFunc_01_02_03_04(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData)
+/* expected length of request frame (master -> slave) by its header */
+int ModbusProtocolBase::requestFrameLength(const uint8_t* data, size_t size)
 {
-	//reset data of last request
-	this->lastRequestInfo.Reset();
-
-	//fill new request
-	this->inputDataBuffer[0] = this->deviceAddress; // 1: address of device
-	this->inputDataBuffer[1] = functionCode; // 2: current function code
-	this->inputDataBuffer[2] = (uint8_t)(startingAddress >> 8); // 3.2: address of first bit (coil) / register - MSB
-	this->inputDataBuffer[3] = (uint8_t)(startingAddress); // 3.1: address of first bit (coil) / register - LSB
-	this->inputDataBuffer[4] = (uint8_t)(quantityOfData >> 8); // 4.2: quantity of bits (coils) / registers - MSB
-	this->inputDataBuffer[5] = (uint8_t)(quantityOfData); // 4.1: quantity of bits (coils) / registers - LSB
-	uint16_t crcVal = ModbusCRC16(&(this->inputDataBuffer[0]), 6); // 5: CRC
-	this->inputDataBuffer[6] = (uint8_t)(crcVal >> 8); // 5.2: modbus CRC - MSB
-	this->inputDataBuffer[7] = (uint8_t)(crcVal); // 5.1: modbus CRC - LSB
-
-	//send request
- 	if (!this->sendDataFunc(&(this->inputDataBuffer[0]), 8))
+	//device address: 0 - broadcast, 1...247
+	if (!size)
 	{
-		return false;
+		return 0;
+	}
+	if (data[0] > 247)
+	{
+		return -1;
+	}
+	if (size < 2)
+	{
+		return 0;
+	}
+	switch (data[1])
+	{
+		case 0x01:
+		case 0x02:
+		case 0x03:
+		case 0x04:
+		case 0x05:
+		case 0x06:
+			//address, function, 2 x 16 bit fields, CRC
+			return 8;
+		case 0x0F:
+		case 0x10:
+			//address, function, 2 x 16 bit fields, bytes count, data, CRC
+			if (size < 7)
+			{
+				return 0;
+			}
+			return 9 + data[6];
+		default:
+			break;
+	}
+	return -1;
+}
+
+/* expected length of response frame (slave -> master) by its header */
+int ModbusProtocolBase::responseFrameLength(const uint8_t* data, size_t size)
+{
+	//device address: 1...247
+	if (!size)
+	{
+		return 0;
+	}
+	if (!data[0] || data[0] > 247)
+	{
+		return -1;
 	}
+	if (size < 2)
+	{
+		return 0;
+	}
+	switch (data[1])
+	{
+		case 0x01:
+		case 0x02:
+		case 0x03:
+		case 0x04:
+			//address, function, bytes count, data, CRC
+			if (size < 3)
+			{
+				return 0;
+			}
+			return 5 + data[2];
+		case 0x05:
+		case 0x06:
+		case 0x0F:
+		case 0x10:
+			//address, function, 2 x 16 bit fields, CRC
+			return 8;
+		case 0x81:
+		case 0x82:
+		case 0x83:
+		case 0x84:
+		case 0x85:
+		case 0x86:
+		case 0x8F:
+		case 0x90:
+			//address, function with error bit, exception code, CRC
+			return 5;
+		default:
+			break;
+	}
+	return -1;
+}
 
-	//save information of request
-	this->lastRequestInfo.functionCode = functionCode;
-	this->lastRequestInfo.bytesCount = 8;
-	this->lastRequestInfo.attemptsCount = this->numberOfAttempts;
+/* find first complete frame with valid CRC in data */
+//CRC is checked once for each possible frame - by crc states, without frame data; not complete frame stops dropping of bytes,
+//but frame after it is found, so false frame start in noise can't block valid frames
+size_t ModbusProtocolBase::findFrame(const ModbusRingBuffer& buffer, bool requestFrames, size_t scannedSize, size_t* framePos)
+{
+	const uint8_t* data = buffer.Data();
+	size_t size = buffer.Size();
+	//first position of not complete frame - bytes from it are kept
+	size_t keepPos = size;
+	for (size_t pos = 0; pos < size; pos++)
+	{
+		int frameLength = requestFrames ? requestFrameLength(data + pos, size - pos) : responseFrameLength(data + pos, size - pos);
+		if (frameLength < 0)
+		{
+			continue;
+		}
+		if (!frameLength || (size_t)frameLength > size - pos)
+		{
+			if (keepPos == size)
+			{
+				keepPos = pos;
+			}
+			continue;
+		}
+		//frame was complete on previous search - already checked
+		if (pos + frameLength <= scannedSize)
+		{
+			continue;
+		}
+		//check CRC by crc states saved on data receiving
+		if (buffer.CheckFrameCRC(pos, (size_t)frameLength))
+		{
+			*framePos = pos;
+			return (size_t)frameLength;
+		}
+	}
+	*framePos = keepPos;
+	return 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
 
-	//start timeout timer
-	this->lastRequestInfo.timerIdentifier = StartTimeoutTimer(this->responseTimeout,
-		std::bind(&ModbusProtocolMaster::timeoutExpired, this),
-		this->lastRequestInfo.timerIdentifier);
-	if (!this->lastRequestInfo.timerIdentifier)
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* send frame of segments */
+bool ModbusProtocolBase::sendFrame(const DataSegment* segments, size_t segmentsCount)
+{
+	if (this->sendDataSegmentsFunc)
+	{
+		return this->sendDataSegmentsFunc(segments, segmentsCount);
+	}
+	if (!this->sendDataFunc || !segmentsCount)
 	{
-		this->lastRequestInfo.Reset();
 		return false;
 	}
-
-	return true;
+	//one segment - without copy
+	if (segmentsCount == 1)
+	{
+		return this->sendDataFunc((uint8_t*)segments[0].data, segments[0].length);
+	}
+	//frame of RTU or Modbus TCP (MBAP header without unit identifier and RTU frame without CRC) - to one buffer
+	uint8_t frame[rtuFrameMaxSize + 6];
+	size_t frameLength = 0;
+	for (size_t i = 0; i < segmentsCount; i++)
+	{
+		if (segments[i].length > sizeof(frame) - frameLength)
+		{
+			return false;
+		}
+		memcpy(frame + frameLength, segments[i].data, segments[i].length);
+		frameLength += segments[i].length;
+	}
+	return this->sendDataFunc(frame, frameLength);
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 /* private util function: not check this object state and port state */
-int ModbusProtocolMaster::parsingAnswerFunc_01_02(vector <uint8_t>& inputBuffer)
+int ModbusProtocolMaster::parsingAnswerFunc_01_02(const uint8_t* request, const uint8_t* inputBuffer)
 {
 	//get request info
-	int startingAddress = this->inputDataBuffer[2] << 8 | this->inputDataBuffer[3];
-	int quantityOfBits = this->inputDataBuffer[4] << 8 | this->inputDataBuffer[5];
+	int startingAddress = request[2] << 8 | request[3];
+	int quantityOfBits = request[4] << 8 | request[5];
 	//get packet header
-	outputPackTemplateF01F04* packHeader = (outputPackTemplateF01F04*)&inputBuffer[0];
+	const outputPackTemplateF01F04* packHeader = (const outputPackTemplateF01F04*)inputBuffer;
 
 	//validate request and response bits count
 	if (quantityOfBits / 8 + (quantityOfBits % 8 != 0) != packHeader->byteCount)
@@ -79,14 +211,12 @@ int ModbusProtocolMaster::parsingAnswerFunc_01_02(vector <uint8_t>& inputBuffer)
 		return -1;
 	}
 
-	//parsing packet
-	for (int i = 0; i < quantityOfBits; i++)
+	//parsing packet - packed bits for all range at once
+	//bits without elements (holes in read block) are skipped
+	if (!this->modbusRegisterMap->SetBitsRange(packHeader->funcCode, (uint16_t)startingAddress, (uint16_t)quantityOfBits,
+		&inputBuffer[this->outputPackTemplateF01F04_Size], packHeader->byteCount, true))
 	{
-		uint8_t val = inputBuffer[this->inputPackTemplateF01F04_Size + i / 8] >> (i % 8) & 0x01;
-		if (!this->modbusRegisterMap->SetElementValue(packHeader->funcCode, startingAddress + i, &val, 1))
-		{
-			return -1;
-		}
+		return -1;
 	}
 	
 	//return packet size in bytes
@@ -96,13 +226,13 @@ int ModbusProtocolMaster::parsingAnswerFunc_01_02(vector <uint8_t>& inputBuffer)
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 /* private util function: not check this object state and port state */
-int ModbusProtocolMaster::parsingAnswerFunc_03_04(vector <uint8_t>& inputBuffer)
+int ModbusProtocolMaster::parsingAnswerFunc_03_04(const uint8_t* request, const uint8_t* inputBuffer)
 {
 	//get request info
-	int startingAddress = this->inputDataBuffer[2] << 8 | this->inputDataBuffer[3];
-	int quantityOfRegisters = this->inputDataBuffer[4] << 8 | this->inputDataBuffer[5];
+	int startingAddress = request[2] << 8 | request[3];
+	int quantityOfRegisters = request[4] << 8 | request[5];
 	//get packet header
-	outputPackTemplateF01F04* packHeader = (outputPackTemplateF01F04*)&inputBuffer[0];
+	const outputPackTemplateF01F04* packHeader = (const outputPackTemplateF01F04*)inputBuffer;
 
 	//validate request and response bytes count
 	if (quantityOfRegisters * 2 != packHeader->byteCount)
@@ -110,732 +240,1021 @@ int ModbusProtocolMaster::parsingAnswerFunc_03_04(vector <uint8_t>& inputBuffer)
 		return -1;
 	}
 
-	//parsing packet
-	for (int i = 0; i < quantityOfRegisters; i++)
+	//parsing packet - one database request for all range
+	//registers without elements (holes in read block) are skipped
+	if (!this->modbusRegisterMap->SetElementsRange(packHeader->funcCode, (uint16_t)startingAddress, (uint16_t)quantityOfRegisters,
+		&inputBuffer[this->outputPackTemplateF01F04_Size], packHeader->byteCount, true))
 	{
-		uint16_t val = inputBuffer[this->inputPackTemplateF01F04_Size + i*2] << 8 | inputBuffer[this->inputPackTemplateF01F04_Size + i*2 + 1];
-		if (!this->modbusRegisterMap->SetElementValue(packHeader->funcCode, startingAddress + i, (uint8_t*)&val, 2))
+		return -1;
+	}
+
+	//return packet size in bytes
+	return this->inputPackTemplateF01F04_Size + packHeader->byteCount + 2;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* private util function: not check this object state and port state */
+int ModbusProtocolMaster::parsingAnswerFunc_05_06(const uint8_t* request, const uint8_t* inputBuffer)
+{
+	//check response = request (echo) or not, CRC is checked on frame search (no CRC in Modbus TCP frame)
+	for (size_t i = 0; i < this->outputPackTemplateF05F06_Size - 2; i++)
+	{
+		if (request[i] != inputBuffer[i])
 		{
 			return -1;
 		}
 	}
-
+	
 	//return packet size in bytes
-	return this->inputPackTemplateF01F04_Size + packHeader->byteCount + 2;
+	return this->outputPackTemplateF05F06_Size;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* private util function: not check this object state and port state, not check this object config */
-bool ModbusProtocolMaster::requestFunc_05_06(uint8_t functionCode, uint16_t outputAddress)
+/* private util function: not check this object state and port state */
+int ModbusProtocolMaster::parsingAnswerFunc_15_16(const uint8_t* request, const uint8_t* inputBuffer)
 {
-	//reset data of last request
-	this->lastRequestInfo.Reset();
+	//get request data
+	uint16_t startingAddress = (uint16_t)request[2] << 8 | request[3];
+	uint16_t quantityOfData = (uint16_t)request[4] << 8 | request[5];
+	//response data - big-endian fields
+	uint16_t responseStartingAddress = (uint16_t)inputBuffer[2] << 8 | inputBuffer[3];
+	uint16_t responseQuantityOfData = (uint16_t)inputBuffer[4] << 8 | inputBuffer[5];
 
-	//read value from database
-	uint16_t val{};
-	uint16_t valBytesCount{};
-	if (!this->modbusRegisterMap->GetElementValue(functionCode, outputAddress, (uint8_t*)&val, 2, &valBytesCount) && valBytesCount != 2)
+	//check echo data
+	if (startingAddress != responseStartingAddress || quantityOfData != responseQuantityOfData)
 	{
-		return false;
+		return -1;
 	}
 
-	//if function 0x05 - write single coil
-	if (functionCode == 0x05 && val)
+	//return packet size in bytes
+	return this->outputPackTemplateF15F16_Size;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* modbus master - parse input packet */
+void ModbusProtocolMaster::inputPacketParse(uint8_t* inputBuffer, size_t inputLen)
+{
+	//Modbus TCP - answers of transactions in window, RTU - answer of one transaction
+	if (this->tcpMode)
 	{
-		//assign 0xFF00 value if logic "1"
-		val = 0xFF00;
+		inputTcpDataParse(inputBuffer, inputLen);
 	}
+	else
+	{
+		inputRtuDataParse(inputBuffer, inputLen);
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
 
-	//fill new request
-	this->inputDataBuffer[0] = this->deviceAddress;           // 1: address of device
-	this->inputDataBuffer[1] = functionCode;                  // 2: current function code
-	this->inputDataBuffer[2] = (uint8_t)(outputAddress >> 8); // 3.2: address of coil / register - MSB
-	this->inputDataBuffer[3] = (uint8_t)(outputAddress);      // 3.1: address of coil / register - LSB
-	this->inputDataBuffer[4] = (uint8_t)(val >> 8);           // 4.2: data of coil / register - MSB
-	this->inputDataBuffer[5] = (uint8_t)(val);                // 4.1: data of coil / register - LSB
-	uint16_t crcVal = ModbusCRC16(&(this->inputDataBuffer[0]), 6); // 5: CRC
-	this->inputDataBuffer[6] = (uint8_t)(crcVal >> 8);        // 5.2: modbus CRC - MSB
-	this->inputDataBuffer[7] = (uint8_t)(crcVal);             // 5.1: modbus CRC - LSB
-
-	//send request
-	if (!this->sendDataFunc(&(this->inputDataBuffer[0]), 8))
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* function for update all values of registers in modbus registers map - wait of asynchronous read */
+bool ModbusProtocolMaster::readAllRegisters()
+{
+	std::future <int> readResult = ReadAllRegistersAsync();
+	if (readResult.get() != NO_EXCEPTION)
 	{
+		outputErrorMessage("Modbus master - update all registers function error.");
 		return false;
 	}
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
 
-	//save information of request
-	this->lastRequestInfo.functionCode = functionCode;
-	this->lastRequestInfo.bytesCount = 8;
-	this->lastRequestInfo.attemptsCount = this->numberOfAttempts;
-
-	//start timeout timer
-	this->lastRequestInfo.timerIdentifier = StartTimeoutTimer(this->responseTimeout,
-		std::bind(&ModbusProtocolMaster::timeoutExpired, this),
-		this->lastRequestInfo.timerIdentifier);
-	if (!this->lastRequestInfo.timerIdentifier)
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* start read of all registers by read plan */
+bool ModbusProtocolMaster::ReadAllRegistersAsync(TransactionCallbackFuncObj callback)
+{
+	//check modbus database access and send function
+	if (!this->modbusRegisterMap || !sendFuncConfigured())
 	{
-		this->lastRequestInfo.Reset();
 		return false;
 	}
-
+	//one read of all registers at a time
+	if (this->readAllActive.exchange(true))
+	{
+		return false;
+	}
+	//blocks of neighbour elements
+	if (!buildReadPlan())
+	{
+		outputErrorMessage("Modbus master - update all registers function error. Create read plan fail.");
+		this->readAllActive = false;
+		return false;
+	}
+	this->readAllNext = 0;
+	this->readAllPending = 0;
+	this->readAllResult = NO_EXCEPTION;
+	this->readAllCallback = callback;
+	continueReadAll();
 	return true;
 }
+
+std::future <int> ModbusProtocolMaster::ReadAllRegistersAsync(void)
+{
+	//promise is shared by callback - callback object must be copyable
+	std::shared_ptr <std::promise <int>> readPromise = std::make_shared <std::promise <int>>();
+	std::future <int> readResult = readPromise->get_future();
+	if (!ReadAllRegistersAsync([readPromise](int result) { readPromise->set_value(result); }))
+	{
+		readPromise->set_value(MT_SEND_ERROR);
+	}
+	return readResult;
+}
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* private util function: not check this object state and port state */
-int ModbusProtocolMaster::parsingAnswerFunc_05_06(vector <uint8_t>& inputBuffer)
+/* send next blocks of read plan, read is finished when all blocks are finished or after first error */
+void ModbusProtocolMaster::continueReadAll(void)
 {
-	//check response = request (echo) or not
-	for (size_t i = 0; i < this->outputPackTemplateF05F06_Size; i++)
+	//answer can be received during send - requests are sent by first caller, calls during sending are repeated by it
+	if (this->readAllSendCalls.fetch_add(1))
 	{
-		if (this->inputDataBuffer[i] != inputBuffer[i])
+		return;
+	}
+	bool readFinished = false;
+	do
+	{
+		while (this->readAllNext < this->readPlan.size() && this->readAllResult == NO_EXCEPTION)
 		{
-			return -1;
+			const readPlanBlock& block = this->readPlan[this->readAllNext];
+			this->readAllPending++;
+			if (!sendTransaction(block.functionCode, block.startingAddress, block.quantityOfData,
+				[this](int result) { readAllBlockFinished(result); }))
+			{
+				//no free place - next block after answer; no blocks in flight - request can't be sent
+				if (!--this->readAllPending)
+				{
+					int noError = NO_EXCEPTION;
+					this->readAllResult.compare_exchange_strong(noError, MT_SEND_ERROR);
+				}
+				break;
+			}
+			this->readAllNext++;
+		}
+		if ((this->readAllNext >= this->readPlan.size() || this->readAllResult != NO_EXCEPTION) && !this->readAllPending)
+		{
+			readFinished = true;
+		}
+	} while (this->readAllSendCalls.fetch_sub(1) != 1);
+
+	//result of read, new read can be started from callback
+	if (readFinished)
+	{
+		TransactionCallbackFuncObj callback = std::move(this->readAllCallback);
+		this->readAllCallback = nullptr;
+		int result = this->readAllResult;
+		this->readAllActive = false;
+		if (callback)
+		{
+			callback(result);
 		}
 	}
-	
-	//return packet size in bytes
-	return this->outputPackTemplateF05F06_Size;
+}
+
+/* result of one block of read plan - first error is result of read */
+void ModbusProtocolMaster::readAllBlockFinished(int result)
+{
+	if (result != NO_EXCEPTION)
+	{
+		int noError = NO_EXCEPTION;
+		this->readAllResult.compare_exchange_strong(noError, result);
+	}
+	this->readAllPending--;
+	continueReadAll();
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* private util function: not check this object state and port state, not check this object config */
-bool ModbusProtocolMaster::requestFunc_15_16(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData)
+/* build read plan: elements of function codes 0x01 - 0x04 in order of addresses are joined to blocks */
+//element is added to block of previous elements if hole between them isn't larger than gap tolerance
+//and block with element isn't larger than max quantity of one request; element is never split between blocks
+bool ModbusProtocolMaster::buildReadPlan(void)
 {
-	//reset data of last request
-	this->lastRequestInfo.Reset();
-
-	//fill new request
-	this->inputDataBuffer[0] = this->deviceAddress;             // 1: address of device
-	this->inputDataBuffer[1] = functionCode;                    // 2: current function code
-	this->inputDataBuffer[2] = (uint8_t)(startingAddress >> 8); // 3.2: address of first coil / register - MSB
-	this->inputDataBuffer[3] = (uint8_t)(startingAddress);      // 3.1: address of first coil / register - LSB
-	this->inputDataBuffer[4] = (uint8_t)(quantityOfData >> 8);  // 4.2: count coils / registers - MSB
-	this->inputDataBuffer[5] = (uint8_t)(quantityOfData);       // 4.1: count coils / registers - LSB
-
-	//variant for modbus function 0x0F - write multiple coils
-	if (functionCode == 0x0F)
-	{
-		uint8_t dataByte{};
-		uint8_t dataBit{};
-		uint16_t valBytesCount{};
-		for (int i = 0; i < quantityOfData; i++)
+	this->readPlan.clear();
+	//end of current block - address after its last register
+	uint32_t blockEnd = 0;
+	try
+	{
+		//elements are got in order of function code and address
+		for (ModbusElementBase* regMapElement = this->modbusRegisterMap->GetFirstElement();
+			regMapElement != nullptr; regMapElement = this->modbusRegisterMap->GetNextElement())
 		{
-			//get coil value
-			if (!this->modbusRegisterMap->GetElementValue(functionCode, startingAddress + i, (uint8_t*)&dataBit, 1, &valBytesCount) && valBytesCount != 1)
+			uint8_t functionCode = regMapElement->GetFunctionCode();
+			if (functionCode < 0x01 || functionCode > 0x04)
 			{
-				return false;
+				continue;
 			}
-			valBytesCount = i % 8;
-			dataByte |= (dataBit & 0x01) << valBytesCount;
-			//save byte to request packet if ready
-			if (valBytesCount == 7)
+			//bits or registers of element, max quantity of request
+			bool bitsFunction = (functionCode <= 0x02);
+			uint32_t elementSize = bitsFunction ? 1 : ModbusDataTypeRegistersCount(regMapElement->GetDataType());
+			uint32_t quantityMax = bitsFunction ? 2000 : 125;
+			uint32_t elementAddress = regMapElement->GetRegisterAddress();
+			if (!elementSize || elementAddress + elementSize > 0x10000)
 			{
-				this->inputDataBuffer[7 + i / 8] = dataByte;
-				dataByte = 0;
+				continue;
 			}
-		}
-		this->inputDataBuffer[6] = quantityOfData / 8 + 1; // 5: data bytes count
-	}
 
-	//variant for modbus function 0x10 - write multiple registers
-	if (functionCode == 0x10)
-	{
-		uint16_t dataReg{};
-		uint16_t valBytesCount{};
-		for (int i = 0; i < quantityOfData; i++)
-		{
-			//get register value
-			if (!this->modbusRegisterMap->GetElementValue(functionCode, startingAddress + i, (uint8_t*)&dataReg, 2, &valBytesCount) && valBytesCount != 2)
+			//join to current block or start new block
+			if (this->readPlan.size())
 			{
-				return false;
+				readPlanBlock& block = this->readPlan.back();
+				if (block.functionCode == functionCode && elementAddress >= blockEnd &&
+					elementAddress - blockEnd <= this->readGapTolerance &&
+					elementAddress + elementSize - block.startingAddress <= quantityMax)
+				{
+					blockEnd = elementAddress + elementSize;
+					block.quantityOfData = (uint16_t)(blockEnd - block.startingAddress);
+					continue;
+				}
 			}
-			//save register to request packet
-			this->inputDataBuffer[7 + i * 2] = (uint8_t)(dataReg >> 8); // MSB
-			this->inputDataBuffer[7 + i * 2 + 1] = (uint8_t)dataReg; // LSB
+			this->readPlan.push_back({ functionCode, (uint16_t)elementAddress, (uint16_t)elementSize });
+			blockEnd = elementAddress + elementSize;
 		}
-		this->inputDataBuffer[6] = quantityOfData * 2; // 5: data bytes count
 	}
-
-	uint16_t crcVal = ModbusCRC16(&(this->inputDataBuffer[0]), 7 + this->inputDataBuffer[6]); // 5: CRC
-	this->inputDataBuffer[7 + this->inputDataBuffer[6]] = (uint8_t)(crcVal >> 8); // 5.2: modbus CRC - MSB
-	this->inputDataBuffer[8 + this->inputDataBuffer[6]] = (uint8_t)(crcVal);      // 5.1: modbus CRC - LSB
-
-	//save packet bytes count in temporary variable
-	uint16_t* packetBytesCount = &crcVal;
-	*packetBytesCount = 9 + this->inputDataBuffer[6];
-
-	//send request
-	if (!this->sendDataFunc(&(this->inputDataBuffer[0]), *packetBytesCount))
+	catch (...)
 	{
 		return false;
 	}
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
 
-	//save information of request
-	this->lastRequestInfo.functionCode = functionCode;
-	this->lastRequestInfo.bytesCount = *packetBytesCount;
-	this->lastRequestInfo.attemptsCount = this->numberOfAttempts;
-
-	//start timeout timer
-	this->lastRequestInfo.timerIdentifier = StartTimeoutTimer(this->responseTimeout,
-		std::bind(&ModbusProtocolMaster::timeoutExpired, this),
-		this->lastRequestInfo.timerIdentifier);
-	if (!this->lastRequestInfo.timerIdentifier)
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* enable or disable Modbus TCP framing */
+bool ModbusProtocolMaster::SetTcpMode(bool enable)
+{
+	if (this->transactionsInFlight || this->readAllActive)
 	{
-		this->lastRequestInfo.Reset();
 		return false;
 	}
-
+	this->tcpMode = enable;
+	this->inputDataBuffer.Clear();
+	this->inputScannedSize = 0;
 	return true;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* private util function: not check this object state and port state */
-int ModbusProtocolMaster::parsingAnswerFunc_15_16(vector <uint8_t>& inputBuffer)
+/* set max count of requests in flight */
+//slot of transaction is selected by low bits of transaction identifier, high bits are changed on each request,
+//so late answer of finished transaction isn't matched to new transaction of same slot
+bool ModbusProtocolMaster::SetTransactionsWindow(size_t windowSize)
 {
-	//get request data
-	uint16_t startingAddress = (uint16_t)this->inputDataBuffer[2] << 8 | this->inputDataBuffer[3];
-	uint16_t quantityOfData = (uint16_t)this->inputDataBuffer[4] << 8 | this->inputDataBuffer[5];
-	//response data
-	outputPackTemplateF15F16* responseData = (outputPackTemplateF15F16*)&inputBuffer[0];
+	if (!windowSize || windowSize > transactionsWindowMax || this->transactionsInFlight)
+	{
+		return false;
+	}
+	size_t slotsMask = 1;
+	while (slotsMask < windowSize)
+	{
+		slotsMask <<= 1;
+	}
+	try
+	{
+		this->transactions.resize(windowSize);
+		this->freeTransactions.clear();
+		this->freeTransactions.reserve(windowSize);
+	}
+	catch (...)
+	{
+		outputErrorMessage("Modbus master: no memory for transactions window.");
+		return false;
+	}
+	//first free slots are used first
+	for (size_t i = windowSize; i > 0; i--)
+	{
+		this->transactions[i - 1].state = MT_STATE_FREE;
+		this->freeTransactions.push_back((uint16_t)(i - 1));
+	}
+	this->transactionsMask = (uint16_t)(slotsMask - 1);
+	this->transactionsWindow = windowSize;
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
 
-	//check echo data
-	if (startingAddress != responseData->regAddress || quantityOfData != responseData->regsCount)
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* send requests - result by callback */
+bool ModbusProtocolMaster::SendReadRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData, TransactionCallbackFuncObj callback)
+{
+	if (functionCode < 0x01 || functionCode > 0x04)
 	{
-		return -1;
+		return false;
 	}
+	return sendTransaction(functionCode, startingAddress, quantityOfData, callback);
+}
 
-	//return packet size in bytes
-	return 9 + this->inputDataBuffer[6];
+bool ModbusProtocolMaster::SendWriteRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData, TransactionCallbackFuncObj callback)
+{
+	if (functionCode != 0x05 && functionCode != 0x06 && functionCode != 0x0F && functionCode != 0x10)
+	{
+		return false;
+	}
+	return sendTransaction(functionCode, startingAddress, quantityOfData, callback);
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/*  */
-void ModbusProtocolMaster::timeoutExpired(void)
+/* send requests - result by future */
+std::future <int> ModbusProtocolMaster::SendReadRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData)
 {
-	//check last request function code
-	if (!this->lastRequestInfo.functionCode)
+	//promise is shared by callback - callback object must be copyable
+	std::shared_ptr <std::promise <int>> requestPromise = std::make_shared <std::promise <int>>();
+	std::future <int> requestResult = requestPromise->get_future();
+	if (!SendReadRequest(functionCode, startingAddress, quantityOfData, [requestPromise](int result) { requestPromise->set_value(result); }))
 	{
-		this->masterCurrentState = MM_STATE_FREE;
-		return;
+		requestPromise->set_value(MT_SEND_ERROR);
 	}
+	return requestResult;
+}
 
-	//message
-	outputErrorMessage("Last request timeout expired.");
+std::future <int> ModbusProtocolMaster::SendWriteRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData)
+{
+	std::shared_ptr <std::promise <int>> requestPromise = std::make_shared <std::promise <int>>();
+	std::future <int> requestResult = requestPromise->get_future();
+	if (!SendWriteRequest(functionCode, startingAddress, quantityOfData, [requestPromise](int result) { requestPromise->set_value(result); }))
+	{
+		requestPromise->set_value(MT_SEND_ERROR);
+	}
+	return requestResult;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
 
-	//if need repeat request
-	if (this->lastRequestInfo.attemptsCount)
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* finish all transactions in flight */
+void ModbusProtocolMaster::CancelTransactions(void)
+{
+	for (size_t i = 0; i < this->transactions.size(); i++)
 	{
-		//try send request
-		if (!this->sendDataFunc(&(this->inputDataBuffer[0]), this->lastRequestInfo.bytesCount))
+		lockTransactions();
+		bool inFlight = (this->transactions[i].state == MT_STATE_IN_FLIGHT);
+		uint16_t transactionId = this->transactions[i].transactionId;
+		unlockTransactions();
+		if (inFlight)
 		{
-			outputErrorMessage("Fail repeat last request. Send data error.");
-			this->lastRequestInfo.Reset();
-			this->masterCurrentState = MM_STATE_FREE;
-			return;
-		}
-		//start timeout timer
-		if (!StartTimeoutTimer(this->responseTimeout,
-			std::bind(&ModbusProtocolMaster::timeoutExpired, this),
-			this->lastRequestInfo.timerIdentifier))
-		{
-			outputErrorMessage("Fail set request timeout.");
-			this->lastRequestInfo.Reset();
-			this->masterCurrentState = MM_STATE_FREE;
-			return;
+			finishTransaction(transactionId, nullptr, 0, MT_CANCELLED);
 		}
-		outputErrorMessage("Repeated request sent.");
-		this->lastRequestInfo.attemptsCount--;
 	}
-	else
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* lock and unlock transactions slots - short sections only, callbacks are called without lock */
+void ModbusProtocolMaster::lockTransactions(void)
+{
+	while (this->transactionsLock.test_and_set(std::memory_order_acquire))
 	{
-		this->lastRequestInfo.Reset();
-		this->masterCurrentState = MM_STATE_FREE;
 	}
 }
+
+void ModbusProtocolMaster::unlockTransactions(void)
+{
+	this->transactionsLock.clear(std::memory_order_release);
+}
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* modbus master - parse input packet */
-void ModbusProtocolMaster::inputPacketParse(uint8_t* inputBuffer, size_t inputLen)
+/* build request frame - address (unit identifier) and PDU, values for write requests are read from register map */
+//returns frame length, 0 - wrong request
+size_t ModbusProtocolMaster::buildRequestFrame(uint8_t* frame, uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData)
+{
+	frame[0] = this->deviceAddress;             // 1: address of device
+	frame[1] = functionCode;                    // 2: current function code
+	frame[2] = (uint8_t)(startingAddress >> 8); // 3.2: address of first coil / register - MSB
+	frame[3] = (uint8_t)(startingAddress);      // 3.1: address of first coil / register - LSB
+	frame[4] = (uint8_t)(quantityOfData >> 8);  // 4.2: count coils / registers - MSB
+	frame[5] = (uint8_t)(quantityOfData);       // 4.1: count coils / registers - LSB
+
+	switch (functionCode)
+	{
+		case 0x01:
+		case 0x02:
+			//read coils or discrete inputs - up to 2000 bits
+			return (quantityOfData && quantityOfData <= 2000) ? 6 : 0;
+		case 0x03:
+		case 0x04:
+			//read holding or input registers - up to 125 registers
+			return (quantityOfData && quantityOfData <= 125) ? 6 : 0;
+		case 0x05:
+		case 0x06:
+			{
+				//data of coil / register instead of count
+				uint16_t val{};
+				uint16_t valBytesCount{};
+				if (!this->modbusRegisterMap->GetElementValue(functionCode, startingAddress, (uint8_t*)&val, 2, &valBytesCount))
+				{
+					return 0;
+				}
+				//assign 0xFF00 value if logic "1"
+				if (functionCode == 0x05 && val)
+				{
+					val = 0xFF00;
+				}
+				frame[4] = (uint8_t)(val >> 8);
+				frame[5] = (uint8_t)(val);
+			}
+			return 6;
+		case 0x0F:
+			{
+				//write multiple coils - up to 1968 bits, packed bits for all range at once
+				if (!quantityOfData || quantityOfData > 1968)
+				{
+					return 0;
+				}
+				uint8_t dataBytesCount = (uint8_t)(quantityOfData / 8 + (quantityOfData % 8 > 0));
+				if (!this->modbusRegisterMap->GetBitsRange(functionCode, startingAddress, quantityOfData, &frame[7], dataBytesCount))
+				{
+					return 0;
+				}
+				frame[6] = dataBytesCount;
+			}
+			return 7 + (size_t)frame[6];
+		case 0x10:
+			{
+				//write multiple registers - up to 123 registers, one database request for all range
+				size_t valBytesCount{};
+				if (!quantityOfData || quantityOfData > 123 ||
+					!this->modbusRegisterMap->GetElementsRange(functionCode, startingAddress, quantityOfData,
+						&frame[7], (size_t)quantityOfData * 2, &valBytesCount))
+				{
+					return 0;
+				}
+				frame[6] = (uint8_t)valBytesCount;
+			}
+			return 7 + (size_t)frame[6];
+		default:
+			break;
+	}
+	return 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* start transaction: request in free slot of window, timeout timer, request is sent */
+bool ModbusProtocolMaster::sendTransaction(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData, TransactionCallbackFuncObj callback)
 {
-	//check request info
-	if (!this->lastRequestInfo.functionCode || this->masterCurrentState == MM_STATE_FREE)
+	//check config
+	if (!sendFuncConfigured() || !this->modbusRegisterMap)
 	{
-		//reset and exit
-		this->lastRequestInfo.Reset();
-		this->masterCurrentState = MM_STATE_FREE;
-		return;
+		return false;
 	}
-	//check input data
-	if (!inputBuffer || !inputLen || inputLen > inputBufferMaxSize)
+
+	//request frame: address (unit identifier) and PDU
+	uint8_t requestFrame[rtuFrameMaxSize];
+	size_t requestLength = buildRequestFrame(requestFrame, functionCode, startingAddress, quantityOfData);
+	if (!requestLength)
 	{
-		return;
+		return false;
 	}
-	//check modbus database access
-	if (!this->modbusRegisterMap)
+
+	//take free slot of window, RTU - one request on line
+	lockTransactions();
+	if (this->freeTransactions.empty() || (!this->tcpMode && this->transactionsInFlight))
 	{
-		//reset and exit
-		this->lastRequestInfo.Reset();
-		this->masterCurrentState = MM_STATE_FREE;
-		outputErrorMessage("Modbus master: not set valid Register Map.");
+		unlockTransactions();
+		return false;
+	}
+	uint16_t slot = this->freeTransactions.back();
+	this->freeTransactions.pop_back();
+	uint16_t transactionId = (uint16_t)(slot | (uint32_t)this->transactionsSequence++ * (this->transactionsMask + 1u));
+	masterTransaction* transaction = &this->transactions[slot];
+	transaction->state = MT_STATE_IN_FLIGHT;
+	transaction->transactionId = transactionId;
+	transaction->requestLength = (uint16_t)requestLength;
+	memcpy(transaction->request, requestFrame, requestLength);
+	transaction->attemptsCount = this->tcpMode ? 0 : this->numberOfAttempts;
+	transaction->callback = callback;
+	this->rtuTransactionId = transactionId;
+	this->transactionsInFlight++;
+	//timer is started before transaction is visible to receive path - answer always stops it;
+	//timer identifier is kept locally - slot can be finished and reused or timer restarted by repeat after unlock
+	UINT timerIdentifier = StartTimeoutTimer(this->responseTimeout,
+		[this, transactionId]() { transactionTimeoutExpired(transactionId); }, 0);
+	transaction->timerIdentifier = timerIdentifier;
+	unlockTransactions();
+
+	//send request from local frame - slot can be finished by timeout and reused while request is sent
+	if (timerIdentifier && sendRequestFrame(requestFrame, requestLength, transactionId))
+	{
+		return true;
+	}
+	//slot is free again on fail, if transaction isn't finished (callback is called) or repeated by timeout yet -
+	//else result is delivered by callback, so request is started
+	bool requestDropped = false;
+	lockTransactions();
+	if (transaction->state == MT_STATE_IN_FLIGHT && transaction->transactionId == transactionId &&
+		transaction->timerIdentifier == timerIdentifier)
+	{
+		StopTimeoutTimer(timerIdentifier);
+		transaction->state = MT_STATE_FREE;
+		transaction->callback = nullptr;
+		this->freeTransactions.push_back(slot);
+		this->transactionsInFlight--;
+		requestDropped = true;
+	}
+	unlockTransactions();
+	return !requestDropped;
+}
+
+/* send request frame of transaction - with MBAP header (Modbus TCP) or with CRC (RTU) */
+//request (unit identifier and PDU) is sent from copy of caller, not from transaction slot - slot can be reused while request is sent;
+//header or CRC - as separate segment
+bool ModbusProtocolMaster::sendRequestFrame(const uint8_t* request, size_t requestLength, uint16_t transactionId)
+{
+	uint8_t frameEdge[mbapHeaderSize - 1];
+	DataSegment segments[2];
+	if (this->tcpMode)
+	{
+		//MBAP header: transaction identifier, protocol identifier = 0, length of unit identifier and PDU
+		frameEdge[0] = (uint8_t)(transactionId >> 8);
+		frameEdge[1] = (uint8_t)(transactionId);
+		frameEdge[2] = 0;
+		frameEdge[3] = 0;
+		frameEdge[4] = (uint8_t)(requestLength >> 8);
+		frameEdge[5] = (uint8_t)(requestLength);
+		segments[0] = { frameEdge, mbapHeaderSize - 1 };
+		segments[1] = { request, requestLength };
+		return sendFrame(segments, 2);
+	}
+	uint16_t crcVal = ModbusCRC16(request, (uint16_t)requestLength);
+	frameEdge[0] = (uint8_t)(crcVal);          // modbus CRC - LSB
+	frameEdge[1] = (uint8_t)(crcVal >> 8);     // modbus CRC - MSB
+	segments[0] = { request, requestLength };
+	segments[1] = { frameEdge, 2 };
+	return sendFrame(segments, 2);
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* finish transaction by answer (answer is parsed) or with result, slot is free before callback - callback can send new request */
+void ModbusProtocolMaster::finishTransaction(uint16_t transactionId, const uint8_t* answer, size_t answerLength, int result)
+{
+	//transaction is finished once - by answer, timeout or cancel
+	uint16_t slot = transactionId & this->transactionsMask;
+	lockTransactions();
+	if (slot >= this->transactions.size() || this->transactions[slot].state != MT_STATE_IN_FLIGHT ||
+		this->transactions[slot].transactionId != transactionId)
+	{
+		unlockTransactions();
 		return;
 	}
-	//check input buffer free space, erase data if need
-	if (inputDataBuffer.size() + inputLen > inputBufferMaxSize)
+	masterTransaction* transaction = &this->transactions[slot];
+	transaction->state = MT_STATE_FINISHING;
+	unlockTransactions();
+
+	StopTimeoutTimer(transaction->timerIdentifier);
+	if (answer)
 	{
-		if (inputDataBuffer.size() + inputLen - inputBufferMaxSize == 1)
-		{
-			inputDataBuffer.erase(inputDataBuffer.begin());
-		}
-		else
-		{
-			inputDataBuffer.erase(inputDataBuffer.begin(), inputDataBuffer.begin() + (inputDataBuffer.size() + inputLen - inputBufferMaxSize));
-		}
+		result = parseAnswerFrame(transaction->request, answer, answerLength);
 	}
-	//copy input data to buffer
-	inputDataBuffer.insert(inputDataBuffer.end(), inputBuffer, inputBuffer + inputLen);
-	//if inputDataBuffer size < [inputPackTemplate_Size] bytes, exit; modbus request never less min base size = inputPackTemplate_Size bytes
-	if (inputDataBuffer.size() < this->outputPackTemplateError_Size)
+	TransactionCallbackFuncObj callback = std::move(transaction->callback);
+	transaction->callback = nullptr;
+
+	lockTransactions();
+	transaction->state = MT_STATE_FREE;
+	this->freeTransactions.push_back(slot);
+	this->transactionsInFlight--;
+	unlockTransactions();
+
+	if (callback)
+	{
+		callback(result);
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* timeout of transaction - RTU request is repeated while attempts left, Modbus TCP requests aren't repeated (reliable transport) */
+void ModbusProtocolMaster::transactionTimeoutExpired(uint16_t transactionId)
+{
+	uint16_t slot = transactionId & this->transactionsMask;
+	lockTransactions();
+	if (slot >= this->transactions.size() || this->transactions[slot].state != MT_STATE_IN_FLIGHT ||
+		this->transactions[slot].transactionId != transactionId)
 	{
+		unlockTransactions();
 		return;
 	}
+	masterTransaction* transaction = &this->transactions[slot];
+	bool repeatRequest = (transaction->attemptsCount > 0);
+	uint8_t requestFrame[rtuFrameMaxSize];
+	size_t requestLength = 0;
+	if (repeatRequest)
+	{
+		//timer of repeat is started before answer of repeat can come
+		transaction->attemptsCount--;
+		transaction->timerIdentifier = StartTimeoutTimer(this->responseTimeout,
+			[this, transactionId]() { transactionTimeoutExpired(transactionId); }, 0);
+		repeatRequest = (transaction->timerIdentifier != 0);
+		//request is copied under lock - answer can finish transaction and slot can be reused after unlock
+		requestLength = transaction->requestLength;
+		memcpy(requestFrame, transaction->request, requestLength);
+	}
+	unlockTransactions();
 
-	//local lambda for check modbus response for functions 01...04
-	auto checkModbusResponsePos_F01ToF04 = [this](uint8_t& i) -> bool
+	if (repeatRequest)
 	{
-		outputPackTemplateF01F04* packHeader = (outputPackTemplateF01F04*)&i;
-		if (packHeader->funcCode < 0x01 || packHeader->funcCode > 0x04)
-		{
-			return false;
-		}
-		uint16_t* packetCRC = (uint16_t*)(&i + (uint16_t)this->outputPackTemplateF01F04_Size + packHeader->byteCount);
-		return ModbusCRC16((uint8_t*)&i, (uint16_t)this->outputPackTemplateF01F04_Size + packHeader->byteCount) == *packetCRC;
-	};
-	//local lambda for check modbus response for functions 05...06
-	auto checkModbusResponsePos_F05ToF06 = [this](uint8_t& i) -> bool
-	{
-		outputPackTemplateF05F06* packHeader = (outputPackTemplateF05F06*)&i;
-		if (packHeader->funcCode != 0x05 && packHeader->funcCode != 0x06)
+		//repeat request, answer can finish transaction at any moment
+		outputErrorMessage("Last request timeout expired.");
+		if (sendRequestFrame(requestFrame, requestLength, transactionId))
 		{
-			return false;
+			return;
 		}
-		return ModbusCRC16((uint8_t*)&i, (uint16_t)this->outputPackTemplateF05F06_Size - 2) == packHeader->packetCRC;
-	};
-	//local lambda for check modbus response for functions 15...16
-	auto checkModbusResponsePos_F15ToF16 = [this](uint8_t& i) -> bool
+		outputErrorMessage("Fail repeat last request.");
+		finishTransaction(transactionId, nullptr, 0, MT_SEND_ERROR);
+		return;
+	}
+	finishTransaction(transactionId, nullptr, 0, MT_TIMEOUT);
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* parse answer frame (address or unit identifier and PDU, without CRC) of request frame */
+//returns NO_EXCEPTION if answer is parsed to register map, modbus exception code of answer or MT_PARSING_ERROR
+int ModbusProtocolMaster::parseAnswerFrame(const uint8_t* request, const uint8_t* answer, size_t answerLength)
+{
+	//check device address, function code and length of answer by its header
+	if (answerLength < 3 || answer[0] != request[0] || (answer[1] & 0x7F) != request[1])
 	{
-		outputPackTemplateF15F16* packHeader = (outputPackTemplateF15F16*)&i;
-		if (packHeader->funcCode != 0x0F && packHeader->funcCode != 0x10)
-		{
-			return false;
-		}
-		return ModbusCRC16((uint8_t*)&i, (uint16_t)this->outputPackTemplateF15F16_Size - 2) == packHeader->packetCRC;
-	};
-	//local lambda for check modbus exception (error) response
-	auto checkModbusResponsePos_Error = [this](uint8_t& i) -> bool
-	{
-		outputPackTemplateError* packHeader = (outputPackTemplateError*)&i;
-		return ModbusCRC16((uint8_t*)&i, (uint16_t)this->outputPackTemplateError_Size - 2) == packHeader->packetCRC;
-	};
-	//local lambda for check modbus response
-	auto checkModbusRequestPos = [&](uint8_t& i) -> bool
-	{
-		return checkModbusResponsePos_F01ToF04(i) || checkModbusResponsePos_F05ToF06(i) ||
-			checkModbusResponsePos_F15ToF16(i) || checkModbusResponsePos_Error(i);
-	};
-
-	//try find packet in buffer, from begin position to position [end - [this->outputPackTemplateF05F06_Size] byte]
-	int packetPos = -1;
-	vector<uint8_t>::iterator iterPos = find_if(inputDataBuffer.begin(), inputDataBuffer.end() - this->outputPackTemplateF05F06_Size, checkModbusRequestPos);
-	if (iterPos == inputDataBuffer.end())
-	{
-		//no valid data - no answer
+		return MT_PARSING_ERROR;
+	}
+	size_t expectedLength = (answer[1] & 0x80) ? 3 : ((answer[1] <= 0x04) ? 3 + (size_t)answer[2] : 6);
+	if (answerLength != expectedLength)
+	{
+		return MT_PARSING_ERROR;
+	}
+
+	switch (answer[1])
+	{
+		case 0x01:
+		case 0x02:
+			return (parsingAnswerFunc_01_02(request, answer) < 0) ? (int)MT_PARSING_ERROR : (int)NO_EXCEPTION;
+		case 0x03:
+		case 0x04:
+			return (parsingAnswerFunc_03_04(request, answer) < 0) ? (int)MT_PARSING_ERROR : (int)NO_EXCEPTION;
+		case 0x05:
+		case 0x06:
+			return (parsingAnswerFunc_05_06(request, answer) < 0) ? (int)MT_PARSING_ERROR : (int)NO_EXCEPTION;
+		case 0x0F:
+		case 0x10:
+			return (parsingAnswerFunc_15_16(request, answer) < 0) ? (int)MT_PARSING_ERROR : (int)NO_EXCEPTION;
+		default:
+			//modbus exception
+			return answer[2] ? (int)answer[2] : MT_PARSING_ERROR;
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* parse input data of RTU mode - answer of transaction in flight */
+void ModbusProtocolMaster::inputRtuDataParse(const uint8_t* inputBuffer, size_t inputLen)
+{
+	//check input data, received data can be longer than input buffer
+	if (!inputBuffer || !inputLen)
+	{
+		return;
+	}
+	//check modbus database access
+	if (!this->modbusRegisterMap)
+	{
+		outputErrorMessage("Modbus master: not set valid Register Map.");
 		return;
 	}
-	else
+	//data without request isn't answer
+	if (!this->transactionsInFlight)
 	{
-		packetPos = iterPos - inputDataBuffer.begin();
+		inputDataBuffer.Clear();
+		this->inputScannedSize = 0;
+		return;
 	}
-
-	//if finded pos > 0, delete excess bytes
-	if (packetPos > 0)
+	//whole answer in received data - it is processed in place, without input buffer
+	if (!inputDataBuffer.Size() && responseFrameLength(inputBuffer, inputLen) == (int)inputLen &&
+		!ModbusCRC16(inputBuffer, (uint16_t)inputLen))
 	{
-		inputDataBuffer.erase(inputDataBuffer.begin(), inputDataBuffer.begin() + packetPos);
-		packetPos = 0;
+		processAnswerFrame(inputBuffer, inputLen);
+		return;
 	}
-
-	//access to input packet data
-	outputPackTemplateF01F04* outputPacket = (outputPackTemplateF01F04*)&inputDataBuffer[0];
-
-	//count bytes to erase from input packet
-	int countInputBytesToErase = 0;
-
-	//check device address and function code
-	if (outputPacket->address == this->deviceAddress && (outputPacket->funcCode & 0x7F) == this->lastRequestInfo.functionCode)
+	//copy input data to buffer, oldest data is dropped if no free space - search from begin;
+	//answer of one request in flight is at end of received data, only last bytes are kept if data is longer than buffer
+	if (inputDataBuffer.Size() + inputLen > inputDataBuffer.Capacity())
 	{
-		//stop timeout timer
-		if (!StopTimeoutTimer(this->lastRequestInfo.timerIdentifier))
-		{
-			//timer stop error
-			outputErrorMessage("Error: timeout timer stop function returned fail.");
-			//reset and exit
-			this->lastRequestInfo.Reset();
-			this->masterCurrentState = MM_STATE_FREE;
-			return;
-		}
-		try
-		{
-			//if device address match
-			//check function code
-			switch (outputPacket->funcCode)
-			{
-				case 0x01:
-				case 0x02:
-					//read coils - 0x01
-					//or read discrete inputs - 0x02
-					countInputBytesToErase = parsingAnswerFunc_01_02(inputDataBuffer);
-					//if return error code
-					if (countInputBytesToErase < 0)
-					{
-						//calc packet size
-						countInputBytesToErase = this->outputPackTemplateF01F04_Size + outputPacket->byteCount + 2;
-						//error message
-						throw "Error: modbus function 0x01 (0x02) response parsing error.";
-					}
-				break;
-				case 0x03:
-				case 0x04:
-					//read analog output - read holding registers (0x03)
-					//or read analog input - read input registers (0x04)
-					countInputBytesToErase = parsingAnswerFunc_03_04(inputDataBuffer);
-					//if return error code
-					if (countInputBytesToErase < 0)
-					{
-						//calc packet size
-						countInputBytesToErase = this->outputPackTemplateF01F04_Size + outputPacket->byteCount + 2;
-						//error message
-						throw "Error: modbus function 0x03 (0x04) response parsing error.";
-					}
-				break;
-				case 0x05:
-				case 0x06:
-					//write single coil - 0x05
-					//or write single register - 0x06
-					countInputBytesToErase = parsingAnswerFunc_05_06(inputDataBuffer);
-					//if return error code
-					if (countInputBytesToErase < 0)
-					{
-						//calc packet size
-						countInputBytesToErase = this->outputPackTemplateF05F06_Size;
-						//error message
-						throw "Error: modbus function 0x05 (0x06) response parsing error.";
-					}
-				break;
-				case 0x0F:
-				case 0x10:
-					//write multiple coils - 0x0F
-					//or write multiple registers - 0x10
-					countInputBytesToErase = parsingAnswerFunc_15_16(inputDataBuffer);
-					//if return error code
-					if (countInputBytesToErase < 0)
-					{
-						//calc packet size
-						countInputBytesToErase = 9 + this->inputDataBuffer[6];
-						//error message
-						throw "Error: modbus function 0x0F (0x10) response parsing error.";
-					}
-				break;
-				case 0x81:
-				case 0x82:
-				case 0x83:
-				case 0x84:
-				case 0x85:
-				case 0x86:
-				case 0x8F:
-				case 0x90:
-					{
-						//modbus exception
-						countInputBytesToErase = outputPackTemplateError_Size;
-						outputPackTemplateError* packHeader = (outputPackTemplateError*)&this->inputDataBuffer[0];
-						//return exception messages
-						if (packHeader->exceptionCode == ILLEGAL_FUNCTION) throw "Error: modbus exception, illegal function.";
-						if (packHeader->exceptionCode == ILLEGAL_DATA_ADDRESS) throw "Error: modbus exception, illegal data address.";
-						if (packHeader->exceptionCode == ILLEGAL_DATA_VALUE) throw "Error: modbus exception, illegal data value.";
-						if (packHeader->exceptionCode == SERVER_DEVICE_FAILURE) throw "Error: modbus exception, server device failure.";
-						//unknown exception
-						throw "Error: modbus exception, unknown error.";
-					}
-				break;
-				default:
-					//error - unknown function code
-					//error message
-					throw "Error: modbus response unknown function code.";
-				break;
-			}
-		}
-		catch (const char* str)
-		{
-			outputErrorMessage(str);
-		}
+		this->inputScannedSize = 0;
 	}
-	else
+	inputDataBuffer.Push(inputBuffer, inputLen);
+	//modbus answer is never less than exception answer
+	if (inputDataBuffer.Size() < this->outputPackTemplateError_Size)
 	{
-		//if not match device address
 		return;
 	}
 
-	//erase prepared packet
-	if (countInputBytesToErase)
+	//find response frame in buffer, drop bytes before frame
+	size_t framePos = 0;
+	size_t frameLength = findFrame(inputDataBuffer, false, this->inputScannedSize, &framePos);
+	inputDataBuffer.Consume(framePos);
+	//bytes after found frame are searched again after frame processing
+	this->inputScannedSize = frameLength ? 0 : inputDataBuffer.Size();
+	if (!frameLength)
 	{
-		inputDataBuffer.erase(inputDataBuffer.begin(), inputDataBuffer.begin() + countInputBytesToErase);
+		//no complete frame - wait data
+		return;
 	}
 
-	//reset and exit
-	this->lastRequestInfo.Reset();
-	this->masterCurrentState = MM_STATE_RESPONSE_READY;
+	//answer is copied - callback of transaction can send next request and parse its answer at once
+	uint8_t answerFrame[rtuFrameMaxSize];
+	memcpy(answerFrame, inputDataBuffer.Data(), frameLength);
+	inputDataBuffer.Consume(frameLength);
+	processAnswerFrame(answerFrame, frameLength);
 }
-/*-----------------------------------------------------------------------------------------------------------------------------*/
 
-/*-----------------------------------------------------------------------------------------------------------------------------*/
-/* function for update all values of registers in modbus registers map */
-bool ModbusProtocolMaster::readAllRegisters()
+/* finish transaction of RTU request by answer frame with CRC */
+void ModbusProtocolMaster::processAnswerFrame(const uint8_t* answerFrame, size_t frameLength)
 {
-	//check access to this modbus master object
-	if (this->masterCurrentState != MM_STATE_FREE)
-	{
-		return false;
-	}
-
-	//lock access
-	this->masterCurrentState = MM_STATE_BUSY;
-
-	//check modbus database access
-	if (!this->modbusRegisterMap)
+	//frame of other device or function is dropped, answer of request is waited further
+	lockTransactions();
+	uint16_t transactionId = this->rtuTransactionId;
+	const masterTransaction* transaction = &this->transactions[transactionId & this->transactionsMask];
+	bool answerOfRequest = (transaction->state == MT_STATE_IN_FLIGHT && transaction->transactionId == transactionId &&
+		answerFrame[0] == transaction->request[0] && (answerFrame[1] & 0x7F) == transaction->request[1]);
+	unlockTransactions();
+	if (answerOfRequest)
 	{
-		//unlock
-		this->masterCurrentState = MM_STATE_FREE;
-		return false;
+		finishTransaction(transactionId, answerFrame, frameLength - 2, NO_EXCEPTION);
 	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
 
-	for (ModbusElementBase* regMapElement = this->modbusRegisterMap->GetFirstElement();
-		regMapElement != nullptr; regMapElement = this->modbusRegisterMap->GetNextElement())
-	{
-		switch (regMapElement->GetFunctionCode())
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* finish transactions of all complete Modbus TCP frames in data, parsed length - size of processed frames */
+//false - wrong MBAP header, stream of frames is lost
+bool ModbusProtocolMaster::parseTcpFrames(const uint8_t* data, size_t dataLength, size_t* parsedLength)
+{
+	size_t position = 0;
+	while (dataLength - position >= mbapHeaderSize)
+	{
+		//MBAP header: transaction identifier, protocol identifier = 0, length of unit identifier and PDU, unit identifier
+		const uint8_t* frame = data + position;
+		uint16_t protocolId = (uint16_t)frame[2] << 8 | frame[3];
+		uint16_t length = (uint16_t)frame[4] << 8 | frame[5];
+		if (protocolId != 0 || length < 2 || length > 254)
 		{
-			case 0x01:
-			case 0x02:
-			case 0x03:
-			case 0x04:
-			//case 0x15:
-			//case 0x16:
-				//request
-				if (!requestFunc_01_02_03_04(regMapElement->GetFunctionCode(), regMapElement->GetRegisterAddress(), 1))
-				{
-					outputErrorMessage("Modbus master - update all registers function error. Create request fail.");
-					//unlock access
-					this->masterCurrentState = MM_STATE_FREE;
-					//exit
-					return false;
-				}
-				//wait response
-				while (this->masterCurrentState == MM_STATE_BUSY) {};
-				//check errors
-				if (this->masterCurrentState == MM_STATE_FREE)
-				{
-					outputErrorMessage("Modbus master - update all registers function error.");
-					//exit
-					return false;
-				}
+			*parsedLength = position;
+			return false;
+		}
+		if (dataLength - position < (size_t)length + 6)
+		{
+			//not complete frame
 			break;
-
-			//case 0x05:
-			//case 0x06:
-			//	//request
-			//	if (!requestFunc_05_06((&regMapElement)->GetFunctionCode(), (&regMapElement)->GetRegisterAddress()))
-			//	{
-			//		outputErrorMessage("Modbus master - update all registers function error. Create request fail.");
-			//		//unlock access
-			//		this->masterCurrentState = MM_STATE_FREE;
-			//		//exit
-			//		return false;
-			//	}
-			//	//wait response
-			//	while (this->masterCurrentState == MM_STATE_BUSY) {};
-			//	//check errors
-			//	if (this->masterCurrentState == MM_STATE_FREE)
-			//	{
-			//		outputErrorMessage("Modbus master - update all registers function error.");
-			//		//exit
-			//		return false;
-			//	}
-			//break;
 		}
+		//answer of unknown or finished transaction is dropped
+		finishTransaction((uint16_t)frame[0] << 8 | frame[1], frame + mbapHeaderSize - 1, length, NO_EXCEPTION);
+		position += (size_t)length + 6;
 	}
-
-	//unlock access
-	this->masterCurrentState = MM_STATE_FREE;
+	*parsedLength = position;
 	return true;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* parse input packet (in buffer) */
-void ModbusProtocolSlave::inputPacketParse(uint8_t* inputBuffer, size_t inputLen)
+/* parse input data of Modbus TCP mode - frames are parsed in place, not complete frame is kept in input buffer */
+void ModbusProtocolMaster::inputTcpDataParse(const uint8_t* inputBuffer, size_t inputLen)
 {
 	//check input data
-	if (!inputBuffer || !inputLen || inputLen > inputBufferMaxSize)
+	if (!inputBuffer || !inputLen)
 	{
 		return;
 	}
-
-	//check modbus database access
 	if (!this->modbusRegisterMap)
 	{
+		outputErrorMessage("Modbus master: not set valid Register Map.");
 		return;
 	}
 
-	//check input buffer free space, erase data if need
-	if (inputDataBuffer.size() + inputLen > inputBufferMaxSize)
+	size_t parsedLength = 0;
+	while (inputLen)
 	{
-		if (inputDataBuffer.size() + inputLen - inputBufferMaxSize == 1)
+		bool framesValid;
+		if (!this->inputDataBuffer.Size())
 		{
-			inputDataBuffer.erase(inputDataBuffer.begin());
+			//all complete frames directly from input data, rest - not complete frame - to buffer
+			framesValid = parseTcpFrames(inputBuffer, inputLen, &parsedLength);
+			if (framesValid)
+			{
+				this->inputDataBuffer.Push(inputBuffer + parsedLength, inputLen - parsedLength);
+				return;
+			}
 		}
 		else
 		{
-			inputDataBuffer.erase(inputDataBuffer.begin(), inputDataBuffer.begin() + (inputDataBuffer.size() + inputLen - inputBufferMaxSize));
+			//end of not complete frame from previous data, frame is never larger than buffer
+			size_t pushLength = std::min(inputLen, this->inputDataBuffer.Capacity() - this->inputDataBuffer.Size());
+			this->inputDataBuffer.Push(inputBuffer, pushLength);
+			inputBuffer += pushLength;
+			inputLen -= pushLength;
+			framesValid = parseTcpFrames(this->inputDataBuffer.Data(), this->inputDataBuffer.Size(), &parsedLength) &&
+				(pushLength || parsedLength);
+			this->inputDataBuffer.Consume(parsedLength);
+		}
+		if (!framesValid)
+		{
+			//wrong MBAP header - all data is dropped, transactions of lost answers are finished by timeout
+			outputErrorMessage("Modbus master: wrong MBAP header, received data is dropped.");
+			this->inputDataBuffer.Clear();
+			return;
 		}
 	}
-	//copy input data to buffer
-	inputDataBuffer.insert(inputDataBuffer.end(), inputBuffer, inputBuffer + inputLen);
-	//if inputDataBuffer size < [inputPackTemplate_Size] bytes, exit; modbus request never less min base size = inputPackTemplate_Size bytes
-	if (inputDataBuffer.size() < this->inputPackTemplateF01F04_Size)
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* parse input packet (in buffer) */
+void ModbusProtocolSlave::inputPacketParse(uint8_t* inputBuffer, size_t inputLen)
+{
+	//check input data, received data can be longer than input buffer
+	if (!inputBuffer || !inputLen)
 	{
 		return;
 	}
 
-	//local lambda for check modbus request for functions 01...04
-	auto checkModbusRequestPos_F01ToF04 = [this](uint8_t& i) -> bool
+	//check modbus database access
+	if (!this->modbusRegisterMap)
 	{
-		if (((inputPackTemplateF01F04*)&i)->funcCode < 0x01 || ((inputPackTemplateF01F04*)&i)->funcCode > 0x04)
-		{
-			return false;
-		}
-		return ModbusCRC16((uint8_t*)&i, (uint16_t)this->inputPackTemplateF01F04_Size - 2) == (((inputPackTemplateF01F04*)&i)->packetCRC);
-	};
-	//local lambda for check modbus request for functions 05...06
-	auto checkModbusRequestPos_F05ToF06 = [this](uint8_t& i) -> bool
+		return;
+	}
+
+	//no queued data - complete frames at begin of received data are processed in place, only rest is queued
+	size_t processedLength = inputDataBuffer.Size() ? 0 : processReceivedFrames(inputBuffer, inputLen);
+	while (processedLength < inputLen)
 	{
-		if (((inputPackTemplateF05F06*)&i)->funcCode != 0x05 && ((inputPackTemplateF05F06*)&i)->funcCode != 0x06)
+		//copy rest of input data to buffer by parts not longer than free space, buffer is full - oldest data is dropped, search from begin
+		size_t pushLength = std::min(inputLen - processedLength, inputDataBuffer.Capacity() - inputDataBuffer.Size());
+		if (!pushLength)
 		{
-			return false;
+			pushLength = std::min(inputLen - processedLength, inputDataBuffer.Capacity());
+			this->inputScannedSize = 0;
 		}
-		return ModbusCRC16((uint8_t*)&i, (uint16_t)this->inputPackTemplateF05F06_Size - 2) == (((inputPackTemplateF01F04*)&i)->packetCRC);
-	};
-	//local lambda for check modbus request for functions 15...16 - NEED IMPROVEMENT!!!
-	auto checkModbusRequestPos_F15ToF16 = [this](uint8_t& i) -> bool
-	{
-		if (((inputPackTemplateF15F16*)&i)->funcCode != 0x0F && ((inputPackTemplateF15F16*)&i)->funcCode != 0x10)
+		inputDataBuffer.Push(inputBuffer + processedLength, pushLength);
+		processedLength += pushLength;
+
+		//process all complete frames in buffer, not only first
+		while (processInputFrame())
 		{
-			return false;
 		}
-		uint16_t requestLength = (uint16_t)((inputPackTemplateF15F16*)&i)->bytesCount + (uint16_t)this->inputPackTemplateF15F16_Size;
-		return ModbusCRC16((uint8_t*)&i, requestLength) == *((uint16_t*)(&i + requestLength));
-	};
-	//local lambda for check modbus request
-	auto checkModbusRequestPos = [&](uint8_t& i) -> bool
+	}
+
+	//send batched answers at once
+	if (this->responsesBatchBuffer.size())
 	{
-		return checkModbusRequestPos_F01ToF04(i) || checkModbusRequestPos_F05ToF06(i) || checkModbusRequestPos_F15ToF16(i);
-	};
+		DataSegment segment = { this->responsesBatchBuffer.data(), this->responsesBatchBuffer.size() };
+		sendFrame(&segment, 1);
+		this->responsesBatchBuffer.clear();
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
 
-	//try find packet in buffer, from begin position to position [end - [this->inputPackTemplate_Size] byte]
-	int packetPos = -1;
-	vector<uint8_t>::iterator iterPos = find_if(inputDataBuffer.begin(), inputDataBuffer.end() - this->inputPackTemplateF01F04_Size, checkModbusRequestPos);
-	if (iterPos == inputDataBuffer.end())
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* find and process first request frame in input buffer, return false if no complete frame */
+bool ModbusProtocolSlave::processInputFrame(void)
+{
+	//if inputDataBuffer size < [inputPackTemplate_Size] bytes, exit; modbus request never less min base size = inputPackTemplate_Size bytes
+	if (inputDataBuffer.Size() < this->inputPackTemplateF01F04_Size)
 	{
-		//no valid data - no answer
-		return;
+		return false;
 	}
-	else
+
+	//find request frame in buffer, drop bytes before frame
+	size_t framePos = 0;
+	size_t frameLength = findFrame(inputDataBuffer, true, this->inputScannedSize, &framePos);
+	inputDataBuffer.Consume(framePos);
+	//bytes after found frame are searched again after frame processing
+	this->inputScannedSize = frameLength ? 0 : inputDataBuffer.Size();
+	if (!frameLength)
+	{
+		//no complete frame - wait data
+		return false;
+	}
+
+	processFrame(inputDataBuffer.Data(), frameLength);
+
+	//erase prepared packet - whole frame for any result of processing
+	inputDataBuffer.Consume(frameLength);
+	return true;
+}
+
+/* process complete request frames with valid CRC from begin of data, stop at first not complete or not valid frame */
+//frames split by reads or with noise before them are found by input buffer
+size_t ModbusProtocolSlave::processReceivedFrames(const uint8_t* data, size_t dataLength)
+{
+	size_t position = 0;
+	while (dataLength - position >= this->inputPackTemplateF01F04_Size)
 	{
-		packetPos = iterPos - inputDataBuffer.begin();
+		int frameLength = requestFrameLength(data + position, dataLength - position);
+		if (frameLength <= 0 || (size_t)frameLength > dataLength - position || ModbusCRC16(data + position, (uint16_t)frameLength))
+		{
+			break;
+		}
+		processFrame(data + position, (size_t)frameLength);
+		position += (size_t)frameLength;
 	}
+	return position;
+}
 
-	//if finded pos > 0, delete excess bytes
-	if (packetPos > 0)
+/* process request frame and send answer */
+void ModbusProtocolSlave::processFrame(const uint8_t* frame, size_t frameLength)
+{
+	//copy frame, copy is changed by bytes rotation
+	uint8_t inputFrame[rtuFrameMaxSize];
+	memcpy(inputFrame, frame, frameLength);
+
+	//process request and send answer
+	uint8_t* answer = nullptr;
+	size_t answerLength = processRequest(inputFrame, &answer);
+	if (answerLength)
 	{
-		inputDataBuffer.erase(inputDataBuffer.begin(), inputDataBuffer.begin() + packetPos);
-		packetPos = 0;
+		sendResponse(answer, answerLength);
 	}
+}
 
+/* process request from frame (address and PDU), frame is changed; answer with CRC - in cache or in answer frame */
+//returns answer length, 0 - no answer (request to other device or broadcast request)
+size_t ModbusProtocolSlave::processRequest(uint8_t* inputFrame, uint8_t** answer)
+{
 	//manually rotate bytes - for all modbus functions type
-	auto swapBytes = [&](uint8_t a, uint8_t b) { uint8_t c = inputDataBuffer[a]; inputDataBuffer[a] = inputDataBuffer[b]; inputDataBuffer[b] = c; };
+	auto swapBytes = [&](uint8_t a, uint8_t b) { uint8_t c = inputFrame[a]; inputFrame[a] = inputFrame[b]; inputFrame[b] = c; };
 	swapBytes(2, 3);
 	swapBytes(4, 5);
 
 	//access to input packet data
-	inputPackTemplateF01F04* inputPacket = (inputPackTemplateF01F04*)&inputDataBuffer[0];
+	inputPackTemplateF01F04* inputPacket = (inputPackTemplateF01F04*)inputFrame;
 
-	//count bytes to erase from input packet
-	int countInputBytesToErase = 0;
+	//read request - answer from cache if table of function code not changed after answer caching
+	responseCacheEntry* cacheEntry = getResponseCacheEntry(inputPacket);
+	uint32_t tableVersion = 0;
+	if (cacheEntry)
+	{
+		tableVersion = this->modbusRegisterMap->GetTableVersion(inputPacket->funcCode);
+		if (cacheEntry->responseLength && cacheEntry->registerMap == this->modbusRegisterMap && cacheEntry->tableVersion == tableVersion &&
+			!memcmp(cacheEntry->request, inputPacket, sizeof(cacheEntry->request)))
+		{
+			this->responseCacheHits++;
+			*answer = cacheEntry->response;
+			return cacheEntry->responseLength;
+		}
+		this->responseCacheMisses++;
+	}
 
 	//****** read question and create answer in output buffer
+	//clear answer frame - no answer for request to other device
+	this->responseFrame.Clear();
 	//check device address
 	if (inputPacket->address == this->deviceAddress || inputPacket->address == 0)
 	{
-		try
+		//if device address match
+		//add device address to answer frame
+		this->responseFrame.PutU8(inputPacket->address);
+		//check function code, processing functions return modbus exception code for error answer
+		modbusExceptionCode excepCode;
+		switch (inputPacket->funcCode)
 		{
-			//if device address match
-			//clear output data buffer
-			outputDataBuffer.clear();
-			//add device address to output buffer
-			outputDataBuffer.push_back(inputPacket->address);
-			//check function code
-			switch (inputPacket->funcCode)
-			{
-				case 0x01:
-				case 0x02:
-					//read coils - 0x01
-					//or read discrete inputs - 0x02
-					countInputBytesToErase = processingFunc01_02(inputPacket);
-				break;
-				case 0x03:
-				case 0x04:
-					//read analog output - read holding registers (0x03)
-					//or read analog input - read input registers (0x04)
-					countInputBytesToErase = processingFunc03_04(inputPacket);
-				break;
-				case 0x05:
-					//write single coil - 0x05
-					countInputBytesToErase = processingFunc05((inputPackTemplateF05F06*)inputPacket);
-				break;
-				case 0x06:
-					//write single register - 0x06
-					countInputBytesToErase = processingFunc06((inputPackTemplateF05F06*)inputPacket);
-				break;
-				case 0x0F:
-					//write multiple coils - 0x0F
-					countInputBytesToErase = processingFunc15((inputPackTemplateF15F16*)inputPacket);
-				break;
-				case 0x10:
-					//write multiple registers - 0x10
-					countInputBytesToErase = processingFunc16((inputPackTemplateF15F16*)inputPacket);
-				break;
-				default:
-					//error - unknown function code
-					throw modbusExceptionCode::ILLEGAL_FUNCTION;
-				break;
-			}
+			case 0x01:
+			case 0x02:
+				//read coils - 0x01
+				//or read discrete inputs - 0x02
+				excepCode = processingFunc01_02(inputPacket);
+			break;
+			case 0x03:
+			case 0x04:
+				//read analog output - read holding registers (0x03)
+				//or read analog input - read input registers (0x04)
+				excepCode = processingFunc03_04(inputPacket);
+			break;
+			case 0x05:
+				//write single coil - 0x05
+				excepCode = processingFunc05((inputPackTemplateF05F06*)inputPacket);
+			break;
+			case 0x06:
+				//write single register - 0x06
+				excepCode = processingFunc06((inputPackTemplateF05F06*)inputPacket);
+			break;
+			case 0x0F:
+				//write multiple coils - 0x0F
+				excepCode = processingFunc15((inputPackTemplateF15F16*)inputPacket);
+			break;
+			case 0x10:
+				//write multiple registers - 0x10
+				excepCode = processingFunc16((inputPackTemplateF15F16*)inputPacket);
+			break;
+			default:
+				//error - unknown function code
+				excepCode = modbusExceptionCode::ILLEGAL_FUNCTION;
+			break;
 		}
-		catch (modbusExceptionCode excepCode)
+		if (excepCode != modbusExceptionCode::NO_EXCEPTION)
 		{
-			countInputBytesToErase = processingExceptionResponse(inputPacket, excepCode);
+			processingExceptionResponse(inputPacket, excepCode);
+			//exception answers are not cached
+			cacheEntry = nullptr;
 		}
 	}
 	else
@@ -844,312 +1263,313 @@ void ModbusProtocolSlave::inputPacketParse(uint8_t* inputBuffer, size_t inputLen
 		// - no answer
 	}
 
-	//send answer, if output buffer not empty, set send data function, device address not zero (not response for broadcast)
-	if (outputDataBuffer.size() && this->sendDataFunc && inputPacket->address != 0)
+	//answer, if answer frame not empty, device address not zero (not response for broadcast)
+	if (this->responseFrame.Size() && inputPacket->address != 0)
+	{
+		//add modbus CRC16
+		this->responseFrame.PutCRC();
+		//save answer to cache
+		if (cacheEntry && this->responseFrame.Size() <= sizeof(cacheEntry->response))
+		{
+			memcpy(cacheEntry->request, inputPacket, sizeof(cacheEntry->request));
+			cacheEntry->registerMap = this->modbusRegisterMap;
+			cacheEntry->tableVersion = tableVersion;
+			cacheEntry->responseLength = (uint16_t)this->responseFrame.Size();
+			memcpy(cacheEntry->response, this->responseFrame.Data(), this->responseFrame.Size());
+		}
+		*answer = this->responseFrame.Data();
+		return this->responseFrame.Size();
+	}
+	return 0;
+}
+
+/* send answer or add it to batch of answers */
+void ModbusProtocolSlave::sendResponse(uint8_t* response, size_t responseLength)
+{
+	if (!sendFuncConfigured())
+	{
+		return;
+	}
+	if (this->responsesBatching)
+	{
+		this->responsesBatchBuffer.insert(this->responsesBatchBuffer.end(), response, response + responseLength);
+		return;
+	}
+	DataSegment segment = { response, responseLength };
+	sendFrame(&segment, 1);
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* process request PDU of transport with own framing (Modbus TCP) */
+size_t ModbusProtocolSlave::ProcessRequestPDU(uint8_t unitId, const uint8_t* pdu, size_t pduLength, uint8_t* response, size_t responseCapacity)
+{
+	//check input data and modbus database access
+	if (!pdu || !pduLength || pduLength > rtuFrameMaxSize - 3 || !response || !this->modbusRegisterMap)
+	{
+		return 0;
+	}
+
+	//frame as RTU frame without CRC, unit identifiers 0xFF and 0 - this device
+	uint8_t inputFrame[rtuFrameMaxSize] = {};
+	inputFrame[0] = (unitId == 0xFF || unitId == 0) ? this->deviceAddress : unitId;
+	memcpy(inputFrame + 1, pdu, pduLength);
+	//request length must match its header, unknown function - exception answer
+	int frameLength = requestFrameLength(inputFrame, pduLength + 3);
+	if (!frameLength || (frameLength > 0 && (size_t)frameLength != pduLength + 3) || inputFrame[0] > 247)
+	{
+		return 0;
+	}
+
+	//process request, answer PDU - answer without address and CRC
+	uint8_t* answer = nullptr;
+	size_t answerLength = processRequest(inputFrame, &answer);
+	if (answerLength < 4 || answerLength - 3 > responseCapacity)
 	{
-		//calc modbus CRC16
-		uint16_t outputCRC = ModbusCRC16(&outputDataBuffer[0], (uint16_t)outputDataBuffer.size());
-		//add CRC16
-		outputDataBuffer.push_back((uint8_t)(outputCRC & 0x00FF));
-		outputDataBuffer.push_back((uint8_t)((outputCRC & 0xFF00) >> 8));
-		//send
-		this->sendDataFunc(&outputDataBuffer[0], outputDataBuffer.size());
+		return 0;
 	}
+	memcpy(response, answer + 1, answerLength - 3);
+	return answerLength - 3;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
 
-	//erase prepared packet
-	if (countInputBytesToErase)
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* get cache entry for read request, nullptr if answer for request can't be cached */
+ModbusProtocolSlave::responseCacheEntry* ModbusProtocolSlave::getResponseCacheEntry(inputPackTemplateF01F04* inputPacket)
+{
+	//only read functions, no answer for broadcast and for other device
+	if (!this->responseCacheEnabled || inputPacket->funcCode < 0x01 || inputPacket->funcCode > 0x04 ||
+		inputPacket->address == 0 || inputPacket->address != this->deviceAddress)
 	{
-		inputDataBuffer.erase(inputDataBuffer.begin(), inputDataBuffer.begin() + countInputBytesToErase);
+		return nullptr;
 	}
+	//entry selected by hash of request, different requests with same hash replace each other
+	uint32_t requestHash = ((uint32_t)inputPacket->regAddress * 31 + inputPacket->regsCount) * 31 + inputPacket->funcCode;
+	return &this->responseCache[(requestHash ^ (requestHash >> 8)) % responseCacheSize];
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 /* modbus functions 01 and 02 processing - 0x01 Read Coils and 0x02 Read Discrete Inputs */
-int ModbusProtocolSlave::processingFunc01_02(inputPackTemplateF01F04* inputPacket)
+ModbusProtocolSlave::modbusExceptionCode ModbusProtocolSlave::processingFunc01_02(inputPackTemplateF01F04* inputPacket)
 {
 	//check quantity of coils
 	if (!inputPacket->regsCount || inputPacket->regsCount > 0x07D0)
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_VALUE;
+		return modbusExceptionCode::ILLEGAL_DATA_VALUE;
 	}
 	//check address range
 	if ((uint32_t)inputPacket->regAddress + (uint32_t)inputPacket->regsCount - 1 > 0x0000FFFF)
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
+		return modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
 	}
-	//add data to output buffer
+	//add data to answer frame
 	//add function code
-	outputDataBuffer.push_back(inputPacket->funcCode);	
+	this->responseFrame.PutU8(inputPacket->funcCode);
 	//add output data bytes count
-	uint8_t oneDataByte = inputPacket->regsCount / 8 + (inputPacket->regsCount % 8 > 0);
-	outputDataBuffer.push_back(oneDataByte);
-	//add registers data
-	uint8_t outputValueBuf;
-	uint16_t outputValueBytesCount = 0;
-	uint8_t bitNumber = 0;
-	oneDataByte = 0;
-	for (int i = inputPacket->regAddress; i < (inputPacket->regAddress + inputPacket->regsCount); i++)
-	{
-		//database request && check count of returned bytes
-		if (this->modbusRegisterMap->GetElementValue(inputPacket->funcCode, i, &outputValueBuf, 1, &outputValueBytesCount) && outputValueBytesCount)
-		{
-			//add one bit to output byte
-			oneDataByte |= (outputValueBuf & 0x01) << bitNumber++;
-			//if bits count > 7, add to output buffer and clear
-			if (bitNumber > 7)
-			{
-				outputDataBuffer.push_back(oneDataByte);
-				oneDataByte = 0;
-				bitNumber = 0;
-			}
-		}
-		else
-		{
-			//error - unknown address of register
-			throw modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
-		}
-	}
-	//check last data byte, add to output buffer if not empty
-	if (bitNumber)
+	uint8_t dataBytesCount = inputPacket->regsCount / 8 + (inputPacket->regsCount % 8 > 0);
+	this->responseFrame.PutU8(dataBytesCount);
+	//add registers data - packed bits for all range at once
+	uint8_t* outputData = this->responseFrame.Reserve(dataBytesCount);
+	if (!outputData || !this->modbusRegisterMap->GetBitsRange(inputPacket->funcCode, inputPacket->regAddress, inputPacket->regsCount,
+		outputData, dataBytesCount))
 	{
-		outputDataBuffer.push_back(oneDataByte);
+		//error - unknown address of register
+		return modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
 	}
 
-	//return size of input packet
-	return this->inputPackTemplateF01F04_Size;
+	return modbusExceptionCode::NO_EXCEPTION;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 /* modbus function 03 and 04 processing - 0x03 Read Holding Registers and 0x04 Read Input Registers */
-int ModbusProtocolSlave::processingFunc03_04(inputPackTemplateF01F04* inputPacket)
+ModbusProtocolSlave::modbusExceptionCode ModbusProtocolSlave::processingFunc03_04(inputPackTemplateF01F04* inputPacket)
 {
 	//check quantity of registers
 	if (!inputPacket->regsCount || inputPacket->regsCount > 0x007D)
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_VALUE;
+		return modbusExceptionCode::ILLEGAL_DATA_VALUE;
 	}
 	//check address range
 	if ((uint32_t)inputPacket->regAddress + (uint32_t)inputPacket->regsCount - 1 > 0x0000FFFF)
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
+		return modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
 	}
-	//add data to output buffer
+	//add data to answer frame
 	//add function code
-	outputDataBuffer.push_back(inputPacket->funcCode);
+	this->responseFrame.PutU8(inputPacket->funcCode);
 #ifdef MODBUS_SLAVE_DEBUG
 	//add bytes count
-	outputDataBuffer.push_back(inputPacket->regsCount * 2);
+	this->responseFrame.PutU8(inputPacket->regsCount * 2);
 	//add data registers
 	for (int i = inputPacket->regAddress; i < (inputPacket->regAddress + inputPacket->regsCount); i++)
 	{
-		outputDataBuffer.push_back((uint8_t)((i & 0xFF00) >> 8));
-		outputDataBuffer.push_back((uint8_t)(i & 0x00FF));
+		this->responseFrame.PutU16BE((uint16_t)i);
 	}
 #else
-	uint8_t outputValueBuf[4];
-	uint16_t outputValueBytesCount = 0;
+	size_t outputValueBytesCount = 0;
 	//add bytes count = 0
-	outputDataBuffer.push_back(0);
-	//add registers data
-	for (uint16_t i = inputPacket->regAddress; i < (inputPacket->regAddress + inputPacket->regsCount); i++)
+	this->responseFrame.PutU8(0);
+	//add registers data - one database request for all range
+	uint8_t* outputData = this->responseFrame.Reserve((size_t)inputPacket->regsCount * 2);
+	if (!outputData || !this->modbusRegisterMap->GetElementsRange(inputPacket->funcCode, inputPacket->regAddress, inputPacket->regsCount,
+		outputData, (size_t)inputPacket->regsCount * 2, &outputValueBytesCount))
 	{
-		//database request && check count of returned bytes
-		if (this->modbusRegisterMap->GetElementValue(inputPacket->funcCode, i, outputValueBuf, 4, &outputValueBytesCount) && outputValueBytesCount)
-		{
-			while (outputValueBytesCount--)
-			{
-				outputDataBuffer.push_back(outputValueBuf[outputValueBytesCount]);
-			}
-		}
-		else
-		{
-			//error - unknown address of register
-			throw modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
-		}
+		//error - unknown address of register
+		return modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
 	}
 	//update bytes count
-	outputDataBuffer[2] = (uint8_t)outputDataBuffer.size() - 3;
+	this->responseFrame.SetU8(2, (uint8_t)outputValueBytesCount);
 #endif
 
-	//return size of input packet
-	return this->inputPackTemplateF01F04_Size;
+	return modbusExceptionCode::NO_EXCEPTION;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 // modbus function 05 processing - 0x05 Write Single Coil
-int ModbusProtocolSlave::processingFunc05(inputPackTemplateF05F06* inputPacket)
+ModbusProtocolSlave::modbusExceptionCode ModbusProtocolSlave::processingFunc05(inputPackTemplateF05F06* inputPacket)
 {
 	//check output value
 	if (inputPacket->regValue != 0x0000 && inputPacket->regValue != 0xFF00)
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_VALUE;
+		return modbusExceptionCode::ILLEGAL_DATA_VALUE;
 	}
 	//try set new register value
 	uint8_t newRegValue = (inputPacket->regValue == 0xFF00) ? 0x01 : 0x00;
 	if (!this->modbusRegisterMap->SetElementValue(inputPacket->funcCode, inputPacket->regAddress, &newRegValue, 1))
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
+		return modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
 	}
-	//add data to output buffer
+	//add data to answer frame
 	//add function code
-	outputDataBuffer.push_back(inputPacket->funcCode);
+	this->responseFrame.PutU8(inputPacket->funcCode);
 	//add register address
-	outputDataBuffer.push_back((uint8_t)((inputPacket->regAddress & 0xFF00) >> 8));
-	outputDataBuffer.push_back((uint8_t)(inputPacket->regAddress & 0x00FF));
+	this->responseFrame.PutU16BE(inputPacket->regAddress);
 	//add register value
-	outputDataBuffer.push_back((uint8_t)((inputPacket->regValue & 0xFF00) >> 8));
-	outputDataBuffer.push_back((uint8_t)(inputPacket->regValue & 0x00FF));
+	this->responseFrame.PutU16BE(inputPacket->regValue);
 
-	//return size of input packet
-	return this->inputPackTemplateF05F06_Size;
+	return modbusExceptionCode::NO_EXCEPTION;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 // modbus function 06 processing - 0x06 Write Single Register
-int ModbusProtocolSlave::processingFunc06(inputPackTemplateF05F06* inputPacket)
+ModbusProtocolSlave::modbusExceptionCode ModbusProtocolSlave::processingFunc06(inputPackTemplateF05F06* inputPacket)
 {
 	//try set new register value
 	if (!this->modbusRegisterMap->SetElementValue(inputPacket->funcCode, inputPacket->regAddress, (uint8_t*)&inputPacket->regValue, 2))
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
+		return modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
 	}
-	//add data to output buffer
+	//add data to answer frame
 	//add function code
-	outputDataBuffer.push_back(inputPacket->funcCode);
+	this->responseFrame.PutU8(inputPacket->funcCode);
 	//add register address
-	outputDataBuffer.push_back((uint8_t)((inputPacket->regAddress & 0xFF00) >> 8));
-	outputDataBuffer.push_back((uint8_t)(inputPacket->regAddress & 0x00FF));
+	this->responseFrame.PutU16BE(inputPacket->regAddress);
 	//add register value
-	outputDataBuffer.push_back((uint8_t)((inputPacket->regValue & 0xFF00) >> 8));
-	outputDataBuffer.push_back((uint8_t)(inputPacket->regValue & 0x00FF));
+	this->responseFrame.PutU16BE(inputPacket->regValue);
 
-	//return size of input packet
-	return this->inputPackTemplateF05F06_Size;
+	return modbusExceptionCode::NO_EXCEPTION;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 // modbus function 15 processing - 0x0F Write Multiple Coils
-int ModbusProtocolSlave::processingFunc15(inputPackTemplateF15F16* inputPacket)
+ModbusProtocolSlave::modbusExceptionCode ModbusProtocolSlave::processingFunc15(inputPackTemplateF15F16* inputPacket)
 {
 	//check quantity of coils
 	if (!inputPacket->regsCount || inputPacket->regsCount > 0x07B0)
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_VALUE;
+		return modbusExceptionCode::ILLEGAL_DATA_VALUE;
 	}
 	//check bytes count
 	uint8_t dataBytesCount = inputPacket->regsCount / 8 + (inputPacket->regsCount % 8 > 0);
 	if (inputPacket->bytesCount != dataBytesCount)
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_VALUE;
+		return modbusExceptionCode::ILLEGAL_DATA_VALUE;
 	}
 	//check address range
 	if ((uint32_t)inputPacket->startRegAddress + (uint32_t)inputPacket->regsCount - 1 > 0x0000FFFF)
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
+		return modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
 	}
-	//write coils
-	uint16_t currentReg = 0;
-	for (int i = 0; i < inputPacket->bytesCount; i++)
+	//write coils - packed bits for all range at once
+	if (!this->modbusRegisterMap->SetBitsRange(inputPacket->funcCode, inputPacket->startRegAddress, inputPacket->regsCount,
+		(uint8_t*)inputPacket + this->inputPackTemplateF15F16_Size, inputPacket->bytesCount))
 	{
-		uint8_t oneDataByte = *((uint8_t*)(inputPacket + this->inputPackTemplateF15F16_Size + i));
-		for (int bitNumber = 0; bitNumber < 8 && currentReg < inputPacket->regsCount; bitNumber++, currentReg++)
-		{
-			uint8_t newRegValue = (oneDataByte & (0x01 << bitNumber)) != 0;
-			if (!this->modbusRegisterMap->SetElementValue(inputPacket->funcCode, inputPacket->startRegAddress + currentReg, &newRegValue, 1))
-			{
-				throw modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
-			}
-		}
+		return modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
 	}
-	//add data to output buffer
+	//add data to answer frame
 	//add function code
-	outputDataBuffer.push_back(inputPacket->funcCode);
+	this->responseFrame.PutU8(inputPacket->funcCode);
 	//add start register address
-	outputDataBuffer.push_back((uint8_t)((inputPacket->startRegAddress & 0xFF00) >> 8));
-	outputDataBuffer.push_back((uint8_t)(inputPacket->startRegAddress & 0x00FF));
+	this->responseFrame.PutU16BE(inputPacket->startRegAddress);
 	//add quantity of coils
-	outputDataBuffer.push_back((uint8_t)((inputPacket->regsCount & 0xFF00) >> 8));
-	outputDataBuffer.push_back((uint8_t)(inputPacket->regsCount & 0x00FF));
+	this->responseFrame.PutU16BE(inputPacket->regsCount);
 
-	//return size of input packet
-	return (this->inputPackTemplateF15F16_Size + inputPacket->bytesCount);
+	return modbusExceptionCode::NO_EXCEPTION;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 // modbus function 16 processing - 0x10 Write Multiple Registers
-int ModbusProtocolSlave::processingFunc16(inputPackTemplateF15F16* inputPacket)
+ModbusProtocolSlave::modbusExceptionCode ModbusProtocolSlave::processingFunc16(inputPackTemplateF15F16* inputPacket)
 {
 	//check quantity of registers
 	if (!inputPacket->regsCount || inputPacket->regsCount > 0x007B)
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_VALUE;
+		return modbusExceptionCode::ILLEGAL_DATA_VALUE;
 	}
 	//check bytes count
 	if (inputPacket->bytesCount != inputPacket->regsCount * 2)
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_VALUE;
+		return modbusExceptionCode::ILLEGAL_DATA_VALUE;
 	}
 	//check address range
 	if ((uint32_t)inputPacket->startRegAddress + (uint32_t)inputPacket->regsCount - 1 > 0x0000FFFF)
 	{
-		throw modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
+		return modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
 	}
-	//write registers
-	for (uint16_t i = 0; i < inputPacket->regsCount; i++)
+	//write registers - one database request for all range, data in packet already in wire format
+	if (!this->modbusRegisterMap->SetElementsRange(inputPacket->funcCode, inputPacket->startRegAddress, inputPacket->regsCount,
+		(uint8_t*)inputPacket + this->inputPackTemplateF15F16_Size, inputPacket->bytesCount))
 	{
-		uint16_t newRegValue = *((uint8_t*)(inputPacket + this->inputPackTemplateF15F16_Size + i * 2));
-		newRegValue = (newRegValue << 8) & 0xFF00;
-		newRegValue += *((uint8_t*)(inputPacket + this->inputPackTemplateF15F16_Size + i * 2 + 1));
-		if (!this->modbusRegisterMap->SetElementValue(inputPacket->funcCode, inputPacket->startRegAddress + i, (uint8_t*)&newRegValue, 2))
-		{
-			throw modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
-		}
+		return modbusExceptionCode::ILLEGAL_DATA_ADDRESS;
 	}
-	//add data to output buffer
+	//add data to answer frame
 	//add function code
-	outputDataBuffer.push_back(inputPacket->funcCode);
+	this->responseFrame.PutU8(inputPacket->funcCode);
 	//add start register address
-	outputDataBuffer.push_back((uint8_t)((inputPacket->startRegAddress & 0xFF00) >> 8));
-	outputDataBuffer.push_back((uint8_t)(inputPacket->startRegAddress & 0x00FF));
+	this->responseFrame.PutU16BE(inputPacket->startRegAddress);
 	//add quantity of registers
-	outputDataBuffer.push_back((uint8_t)((inputPacket->regsCount & 0xFF00) >> 8));
-	outputDataBuffer.push_back((uint8_t)(inputPacket->regsCount & 0x00FF));
+	this->responseFrame.PutU16BE(inputPacket->regsCount);
 
-	//return size of input packet
-	return (this->inputPackTemplateF15F16_Size + inputPacket->bytesCount);
+	return modbusExceptionCode::NO_EXCEPTION;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* modbus exception processing */
-int ModbusProtocolSlave::processingExceptionResponse(inputPackTemplateF01F04* inputPacket, modbusExceptionCode excepCode)
+/* modbus exception processing - exception answer in answer frame */
+void ModbusProtocolSlave::processingExceptionResponse(inputPackTemplateF01F04* inputPacket, modbusExceptionCode excepCode)
 {
-	//clear all already added data - clear output data buffer
-	outputDataBuffer.clear();
-	//add data to output buffer
+	//clear all already added data - clear answer frame
+	this->responseFrame.Clear();
+	//add data to answer frame
 	//add device address
-	outputDataBuffer.push_back(inputPacket->address);
+	this->responseFrame.PutU8(inputPacket->address);
 	//add function code with error bit
-	outputDataBuffer.push_back(inputPacket->funcCode | 0x80);
+	this->responseFrame.PutU8(inputPacket->funcCode | 0x80);
 	//add exception code
-	outputDataBuffer.push_back((uint8_t)excepCode);
-
-	//return size of input packet - now full size of input buffer
-	return this->inputDataBuffer.size();
+	this->responseFrame.PutU8((uint8_t)excepCode);
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* calculate modbus crc16 */
-uint16_t ModbusCRC16(const uint8_t *inputData, uint16_t dataLength)
-{
-	static const uint16_t wCRCTable[] = {
+/* modbus crc16 tables */
+//reference table - crc of one byte
+static constexpr uint16_t wCRCTable[] = {
 	0X0000, 0XC0C1, 0XC181, 0X0140, 0XC301, 0X03C0, 0X0280, 0XC241,
 	0XC601, 0X06C0, 0X0780, 0XC741, 0X0500, 0XC5C1, 0XC481, 0X0440,
 	0XCC01, 0X0CC0, 0X0D80, 0XCD41, 0X0F00, 0XCFC1, 0XCE81, 0X0E40,
@@ -1183,9 +1603,72 @@ uint16_t ModbusCRC16(const uint8_t *inputData, uint16_t dataLength)
 	0X4400, 0X84C1, 0X8581, 0X4540, 0X8701, 0X47C0, 0X4680, 0X8641,
 	0X8201, 0X42C0, 0X4380, 0X8341, 0X4100, 0X81C1, 0X8081, 0X4040 };
 
-	uint8_t nTemp;
+//tables for slicing algorithm: crcSliceTables.table[k][b] - crc of byte b followed by k zero bytes
+struct ModbusCRC16SliceTables
+{
+	uint16_t table[8][256];
+	constexpr ModbusCRC16SliceTables() : table()
+	{
+		for (int b = 0; b < 256; b++)
+		{
+			uint16_t crc = (uint16_t)b;
+			for (int bit = 0; bit < 8; bit++)
+			{
+				crc = (crc & 0x0001) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+			}
+			this->table[0][b] = crc;
+		}
+		for (int k = 1; k < 8; k++)
+		{
+			for (int b = 0; b < 256; b++)
+			{
+				this->table[k][b] = (uint16_t)((this->table[k - 1][b] >> 8) ^ this->table[0][this->table[k - 1][b] & 0xFF]);
+			}
+		}
+	}
+};
+static constexpr ModbusCRC16SliceTables crcSliceTables;
+
+//generated table of one byte must be equal to reference table
+static constexpr bool checkCRC16SliceTables()
+{
+	for (int b = 0; b < 256; b++)
+	{
+		if (crcSliceTables.table[0][b] != wCRCTable[b])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+static_assert(checkCRC16SliceTables(), "Modbus CRC16 slice tables don't match reference table.");
+
+/* calculate modbus crc16 */
+//slicing-by-8 for blocks of 8 bytes, slicing-by-4 for rest block of 4 bytes, reference table for last bytes;
+//data is read by bytes - no alignment requirements and same result on any byte order
+uint16_t ModbusCRC16(const uint8_t *inputData, uint16_t dataLength)
+{
+	const uint16_t (*T)[256] = crcSliceTables.table;
 	uint16_t wCRCWord = 0xFFFF;
 
+	while (dataLength >= 8)
+	{
+		wCRCWord ^= (uint16_t)inputData[0] | ((uint16_t)inputData[1] << 8);
+		wCRCWord = T[7][wCRCWord & 0xFF] ^ T[6][wCRCWord >> 8] ^ T[5][inputData[2]] ^ T[4][inputData[3]] ^
+			T[3][inputData[4]] ^ T[2][inputData[5]] ^ T[1][inputData[6]] ^ T[0][inputData[7]];
+		inputData += 8;
+		dataLength -= 8;
+	}
+	if (dataLength >= 4)
+	{
+		wCRCWord ^= (uint16_t)inputData[0] | ((uint16_t)inputData[1] << 8);
+		wCRCWord = T[3][wCRCWord & 0xFF] ^ T[2][wCRCWord >> 8] ^ T[1][inputData[2]] ^ T[0][inputData[3]];
+		inputData += 4;
+		dataLength -= 4;
+	}
+
+	//last bytes - one byte at a time
+	uint8_t nTemp;
 	while (dataLength--)
 	{
 		nTemp = *inputData++ ^ wCRCWord;
@@ -1194,4 +1677,88 @@ uint16_t ModbusCRC16(const uint8_t *inputData, uint16_t dataLength)
 	}
 	return wCRCWord;
 }
+
+//crc16 state after N zero bytes for each bit of state: crcShiftTable.bits[N][bit], N up to max RTU frame size
+struct ModbusCRC16ShiftTable
+{
+	static const size_t maxBytesCount = 9 + 255;
+	uint16_t bits[maxBytesCount + 1][16];
+	constexpr ModbusCRC16ShiftTable() : bits()
+	{
+		for (int bit = 0; bit < 16; bit++)
+		{
+			this->bits[0][bit] = (uint16_t)(1 << bit);
+		}
+		for (size_t n = 1; n <= maxBytesCount; n++)
+		{
+			for (int bit = 0; bit < 16; bit++)
+			{
+				uint16_t crc = this->bits[n - 1][bit];
+				this->bits[n][bit] = (uint16_t)((crc >> 8) ^ crcSliceTables.table[0][crc & 0xFF]);
+			}
+		}
+	}
+};
+static constexpr ModbusCRC16ShiftTable crcShiftTable;
+
+/* modbus crc16 state after zero bytes */
+uint16_t ModbusCRC16Shift(uint16_t crcState, size_t zeroBytesCount)
+{
+	//long data - by steps of max table length
+	uint16_t shiftedState = crcState;
+	while (zeroBytesCount)
+	{
+		size_t stepBytesCount = (zeroBytesCount < crcShiftTable.maxBytesCount) ? zeroBytesCount : crcShiftTable.maxBytesCount;
+		const uint16_t* stepBits = crcShiftTable.bits[stepBytesCount];
+		uint16_t stepState = 0;
+		for (int bit = 0; bit < 16; bit++)
+		{
+			//column of bit if bit is set, without branch
+			stepState ^= stepBits[bit] & (uint16_t)(0 - ((shiftedState >> bit) & 0x0001));
+		}
+		shiftedState = stepState;
+		zeroBytesCount -= stepBytesCount;
+	}
+	return shiftedState;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* add data to input queue end, oldest data is dropped if no free space */
+void ModbusRingBuffer::Push(const uint8_t* data, size_t length)
+{
+	//only last bytes can be kept
+	if (length > this->capacity)
+	{
+		data += length - this->capacity;
+		length = this->capacity;
+	}
+	if (this->size + length > this->capacity)
+	{
+		this->Consume(this->size + length - this->capacity);
+	}
+	//write to position and to mirror position, second part after wrap - to buffer begin
+	size_t tail = (this->head + this->size) % this->capacity;
+	size_t firstPartLength = (length < this->capacity - tail) ? length : this->capacity - tail;
+	memcpy(this->buffer + tail, data, firstPartLength);
+	memcpy(this->buffer + tail + this->capacity, data, firstPartLength);
+	memcpy(this->buffer, data + firstPartLength, length - firstPartLength);
+	memcpy(this->buffer + this->capacity, data + firstPartLength, length - firstPartLength);
+	//save crc state before each byte, state in local variable - stores can alias members
+	uint16_t state = this->crcState;
+	uint16_t* states = this->crcStates + tail;
+	for (size_t i = 0; i < firstPartLength; i++)
+	{
+		states[i] = state;
+		state = (state >> 8) ^ wCRCTable[(uint8_t)(state ^ data[i])];
+	}
+	states = this->crcStates;
+	for (size_t i = firstPartLength; i < length; i++)
+	{
+		*states++ = state;
+		state = (state >> 8) ^ wCRCTable[(uint8_t)(state ^ data[i])];
+	}
+	this->crcState = state;
+	this->size += length;
+}
 /*-----------------------------------------------------------------------------------------------------------------------------*/
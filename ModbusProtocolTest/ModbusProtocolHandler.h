@@ -9,13 +9,25 @@
 #define MODBUS_PROTOCOL_HANDLER
 
 #include <stdint.h>
+#include <string.h>
 #include <vector>
 #include <algorithm>
 #include <functional>
 #include <atomic>
+#include <future>
+#include <memory>
 #include <iostream>
+#ifdef _WIN32
 #include <windows.h>
+#else
+typedef unsigned int UINT;
+#endif
 #include "ModbusRegisterMap.h"
+#include "ModbusTimerWheel.h"
+#include "DataSegments.h"
+
+//awaitable transaction of master, see ModbusCoroutines.h
+class ModbusTransactionAwaiter;
 
 using std::cout;
 using std::wcout;
@@ -32,9 +44,11 @@ using std::vector;
 //#define MODBUS_ENABLE_DEBUG_MESSAGES_TO_WINDLG
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* platform specified user defined functions for count timeout */
+/* functions for count timeout (ms) - callback is called by thread of timers, 0 - timer isn't started */
 UINT StartTimeoutTimer(int timeout, function <void()> callbackFunc, UINT timerID);
 bool StopTimeoutTimer(UINT timerID);
+//wait callbacks that can't be stopped already - they are being called by thread of timers
+void WaitTimeoutCallbacks(void);
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
@@ -64,6 +78,178 @@ inline void outputErrorMessageW(const wchar_t* text)
 
 /* calculate modbus crc16 */
 uint16_t ModbusCRC16(const uint8_t* inputData, uint16_t dataLength);
+/* modbus crc16 state after zero bytes, it's linear function of state */
+uint16_t ModbusCRC16Shift(uint16_t crcState, size_t zeroBytesCount);
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+//fixed capacity byte queue for input data of protocol parser
+//each byte is written twice - to its position and to mirror position after buffer end,
+//so all queued data from head is one contiguous block for frame parsers without moving data;
+//running modbus crc16 state is saved for each byte on adding, so CRC of any frame in queue is checked without its data
+class ModbusRingBuffer
+{
+	public:
+		/* constructor & destructor */
+		ModbusRingBuffer()
+		{
+
+		}
+		~ModbusRingBuffer()
+		{
+			delete[] this->buffer;
+			delete[] this->crcStates;
+		}
+		ModbusRingBuffer(const ModbusRingBuffer&) = delete;
+		ModbusRingBuffer& operator=(const ModbusRingBuffer&) = delete;
+
+		/* set capacity of buffer, queued data is dropped */
+		void Resize(size_t newCapacity)
+		{
+			uint8_t* newBuffer = new uint8_t[newCapacity * 2];
+			uint16_t* newCRCStates = nullptr;
+			try
+			{
+				newCRCStates = new uint16_t[newCapacity];
+			}
+			catch (...)
+			{
+				delete[] newBuffer;
+				throw;
+			}
+			delete[] this->buffer;
+			delete[] this->crcStates;
+			this->buffer = newBuffer;
+			this->crcStates = newCRCStates;
+			this->capacity = newCapacity;
+			this->Clear();
+		}
+
+		/* drop all queued data */
+		void Clear(void)
+		{
+			this->head = 0;
+			this->size = 0;
+		}
+
+		/* add data to queue end, oldest data is dropped if no free space */
+		void Push(const uint8_t* data, size_t length);
+
+		/* remove data from queue begin */
+		void Consume(size_t length)
+		{
+			if (length >= this->size)
+			{
+				this->Clear();
+				return;
+			}
+			this->head = (this->head + length) % this->capacity;
+			this->size -= length;
+		}
+
+		/* contiguous view of all queued data */
+		const uint8_t* Data(void) const
+		{
+			return this->buffer + this->head;
+		}
+		size_t Size(void) const
+		{
+			return this->size;
+		}
+		size_t Capacity(void) const
+		{
+			return this->capacity;
+		}
+
+		/* check CRC of frame at offset from queue begin - CRC over frame with its CRC bytes must be zero */
+		bool CheckFrameCRC(size_t offset, size_t frameLength) const
+		{
+			//crc states before frame and after frame
+			size_t frameStart = this->head + offset;
+			uint16_t stateBefore = this->crcStates[frameStart % this->capacity];
+			uint16_t stateAfter = (offset + frameLength < this->size) ? this->crcStates[(frameStart + frameLength) % this->capacity] : this->crcState;
+			//state after = shift(state before) ^ crc(frame from zero state), frame CRC starts from 0xFFFF
+			return ModbusCRC16Shift(stateBefore ^ 0xFFFF, frameLength) == stateAfter;
+		}
+
+	private:
+		//memory for data and its mirror - 2 x capacity
+		uint8_t* buffer = nullptr;
+		size_t capacity = 0;
+		//position of first byte and count of queued bytes
+		size_t head = 0;
+		size_t size = 0;
+		//crc16 state before each byte and state after last added byte
+		uint16_t* crcStates = nullptr;
+		uint16_t crcState = 0xFFFF;
+};
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+//builder of one RTU frame in fixed size buffer of object, data is added at cursor (frame end)
+//capacity is max size of RTU frame (256 bytes) - caller checks that data fits into frame by protocol limits
+class ModbusFrameBuilder
+{
+	public:
+		//max size of RTU frame - address, PDU up to 253 bytes, CRC
+		static const size_t frameMaxSize = 256;
+
+		/* drop frame data */
+		void Clear(void)
+		{
+			this->size = 0;
+		}
+
+		/* add byte and 16-bit value in big-endian (modbus) byte order */
+		void PutU8(uint8_t value)
+		{
+			this->data[this->size++] = value;
+		}
+		void PutU16BE(uint16_t value)
+		{
+			this->data[this->size] = (uint8_t)(value >> 8);
+			this->data[this->size + 1] = (uint8_t)value;
+			this->size += 2;
+		}
+		/* add CRC of frame data, modbus CRC is transmitted low byte first */
+		void PutCRC(void)
+		{
+			uint16_t crc = ModbusCRC16(this->data, (uint16_t)this->size);
+			this->data[this->size] = (uint8_t)crc;
+			this->data[this->size + 1] = (uint8_t)(crc >> 8);
+			this->size += 2;
+		}
+		/* add place for length bytes, returns pointer to it for direct writing, nullptr if frame has no space */
+		uint8_t* Reserve(size_t length)
+		{
+			if (length > frameMaxSize - this->size)
+			{
+				return nullptr;
+			}
+			uint8_t* place = this->data + this->size;
+			this->size += length;
+			return place;
+		}
+		/* change already added byte */
+		void SetU8(size_t position, uint8_t value)
+		{
+			this->data[position] = value;
+		}
+
+		/* frame data */
+		uint8_t* Data(void)
+		{
+			return this->data;
+		}
+		size_t Size(void) const
+		{
+			return this->size;
+		}
+
+	private:
+		uint8_t data[frameMaxSize];
+		size_t size = 0;
+};
+/*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 //base class for modbus protocol parser
@@ -71,18 +257,19 @@ class ModbusProtocolBase
 {
 	//type for send data callback
 	typedef function <bool(uint8_t*, size_t)> SendDataFuncObj;
+	//type for send data callback with frame as segments (scatter-gather), e.g. IndustryDataStreamAL::SendDataSegments
+	typedef function <bool(const DataSegment*, size_t)> SendDataSegmentsFuncObj;
 
 	public:
 		/* constructor */
 		ModbusProtocolBase()
 		{
-			inputDataBuffer.clear();
 			outputDataBuffer.clear();
 
 			//try reserve memory for input and output buffers
 			try
 			{
-				inputDataBuffer.reserve(inputBufferMaxSize);
+				inputDataBuffer.Resize(inputBufferMaxSize);
 				outputDataBuffer.reserve(outputBufferMaxSize);
 			}
 			catch (...)
@@ -95,7 +282,7 @@ class ModbusProtocolBase
 		/* destructor*/
 		virtual ~ModbusProtocolBase()
 		{
-			inputDataBuffer.clear();
+			inputDataBuffer.Clear();
 			outputDataBuffer.clear();
 		};
 
@@ -109,6 +296,17 @@ class ModbusProtocolBase
 			}
 			return false;
 		}
+		/* set send data callback for frames of segments - used instead of send data callback, frame isn't gathered to one buffer */
+		//segments are valid only during call
+		bool SetSendDataSegmentsFunc(SendDataSegmentsFuncObj sendFunc)
+		{
+			if (sendFunc)
+			{
+				this->sendDataSegmentsFunc = sendFunc;
+				return true;
+			}
+			return false;
+		}
 
 		/* set modbus registers map */
 		bool SetRegisterMap(ModbusRegMap* map)
@@ -193,6 +391,7 @@ class ModbusProtocolBase
 		/* constants for modbus exceptions */
 		enum modbusExceptionCode
 		{
+			NO_EXCEPTION = 0x00,
 			ILLEGAL_FUNCTION = 0x01,
 			ILLEGAL_DATA_ADDRESS,
 			ILLEGAL_DATA_VALUE,
@@ -204,12 +403,34 @@ class ModbusProtocolBase
 			GATEWAY_TARGET_RESPOND_FAILED
 		};
 
+		/* expected length of RTU frame by its header: > 0 - frame length, 0 - need more bytes, -1 - no frame at this position */
+		static int requestFrameLength(const uint8_t* data, size_t size);
+		static int responseFrameLength(const uint8_t* data, size_t size);
+		/* find first complete frame with valid CRC, bytes before framePos are not frames and can be dropped */
+		//complete frames ending in first scannedSize bytes were checked by previous call and are skipped;
+		//return frame length at framePos or 0 if no complete frame yet
+		static size_t findFrame(const ModbusRingBuffer& buffer, bool requestFrames, size_t scannedSize, size_t* framePos);
+
+		//max size of RTU frame - functions 0x0F and 0x10 with 255 data bytes
+		static const size_t rtuFrameMaxSize = 9 + 255;
+
 		//input & output buffers
-		vector <uint8_t> inputDataBuffer;
+		ModbusRingBuffer inputDataBuffer;
+		//count of input bytes from buffer begin already checked by frame search
+		size_t inputScannedSize = 0;
 		vector <uint8_t> outputDataBuffer;
 
-		//send data callback
+		//send data callbacks
 		SendDataFuncObj sendDataFunc = nullptr;
+		SendDataSegmentsFuncObj sendDataSegmentsFunc = nullptr;
+
+		/* send callback is set */
+		bool sendFuncConfigured(void) const
+		{
+			return this->sendDataFunc || this->sendDataSegmentsFunc;
+		}
+		/* send frame of segments by segments callback, or gathered to one buffer by send data callback */
+		bool sendFrame(const DataSegment* segments, size_t segmentsCount);
 
 		//device modbus address
 		uint8_t deviceAddress = 1;
@@ -221,71 +442,192 @@ class ModbusProtocolBase
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 //modbus protocol master class
+//all requests are asynchronous transactions: request is sent at once, result is returned by callback or future
+//from receive path (inputPacketParse) or from timeout timer, so one thread can serve many masters;
+//RTU mode - one request at a time, repeated on timeout; Modbus TCP mode - window of requests in flight,
+//answers are matched to requests by transaction identifier of MBAP header
 class ModbusProtocolMaster: public ModbusProtocolBase
 {
 	public:
+		/* results of transaction besides NO_EXCEPTION (0, answer is parsed to register map) and modbus exception codes of slave */
+		enum masterTransactionErrors
+		{
+			MT_PARSING_ERROR = -1,
+			MT_TIMEOUT = -2,
+			MT_CANCELLED = -3,
+			MT_SEND_ERROR = -4
+		};
+		//transaction result callback, called from receive path (or from timeout timer)
+		typedef function <void(int)> TransactionCallbackFuncObj;
+
 		/* constructor */
 		ModbusProtocolMaster()
 		{
-
+			SetTransactionsWindow(1);
 		}
 
-		/* destructor */
+		/* destructor - timers of transactions in flight are stopped, expired timers of this master are waited */
 		~ModbusProtocolMaster()
 		{
-
+			//timeout callback can't be stopped after it is taken by thread of timers - it is waited,
+			//callbacks of results can start new transactions - they are canceled too
+			do
+			{
+				CancelTransactions();
+				WaitTimeoutCallbacks();
+			} while (this->transactionsInFlight);
 		}
 
 		/* parse input packet (in buffer) */
 		void inputPacketParse(uint8_t* inputBuffer, size_t inputLen);
 
 		/* read all registers to register map */
+		//elements of each function code are read by blocks of neighbour addresses - up to 125 registers or 2000 bits per request;
+		//thread waits result without load of processor, don't call from receive path of this master
 		bool readAllRegisters(void);
+		/* start read of all registers, result - NO_EXCEPTION or first error of blocks - by callback or future */
+		//false (or MT_SEND_ERROR) - read of all registers is in process or no register map
+		bool ReadAllRegistersAsync(TransactionCallbackFuncObj callback);
+		std::future <int> ReadAllRegistersAsync(void);
+		/* set max count of registers (bits) without elements between elements of one read block, 0 by default */
+		//registers of holes are read from device too, device must answer for all addresses of block
+		void SetReadGapTolerance(uint16_t registersCount)
+		{
+			this->readGapTolerance = registersCount;
+		}
+		uint16_t GetReadGapTolerance(void) const
+		{
+			return this->readGapTolerance;
+		}
 
-	private:
-		/* modbus master current states */
-		enum modbusMasterCurrentStates
+		/* set timeout of answer (ms) and count of repeats of request after timeout (RTU mode) */
+		void SetResponseTimeout(int timeout)
 		{
-			MM_STATE_FREE = 0,
-			MM_STATE_BUSY,
-			MM_STATE_RESPONSE_READY
-		};
+			this->responseTimeout = timeout;
+		}
+		void SetNumberOfAttempts(int attemptsCount)
+		{
+			this->numberOfAttempts = attemptsCount;
+		}
 
-		// modbus master current state
-		std::atomic_int masterCurrentState = MM_STATE_FREE;
+		/* enable or disable Modbus TCP framing (MBAP header instead of CRC), only without transactions in flight */
+		bool SetTcpMode(bool enable);
+		/* set max count of requests in flight for Modbus TCP mode, only without transactions in flight */
+		bool SetTransactionsWindow(size_t windowSize);
+		size_t GetTransactionsWindow(void) const
+		{
+			return this->transactionsWindow;
+		}
+		/* count of requests in flight */
+		size_t GetTransactionsInFlight(void) const
+		{
+			return this->transactionsInFlight;
+		}
 
-		//data of last request
-		struct
+		/* send request, transaction result is returned by callback or future */
+		//false (or MT_SEND_ERROR) - no free place for request (window is full, RTU request in flight) or request error, callback isn't called;
+		//true - callback is called once, also when send fails after transaction is finished by timeout or cancel;
+		//read requests: functions 0x01 - 0x04, answer values are written to register map;
+		//write requests: functions 0x05, 0x06, 0x0F, 0x10, values are read from register map (quantity is ignored for 0x05, 0x06)
+		bool SendReadRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData, TransactionCallbackFuncObj callback);
+		bool SendWriteRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData, TransactionCallbackFuncObj callback);
+		std::future <int> SendReadRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData);
+		std::future <int> SendWriteRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData);
+		/* finish all transactions in flight with MT_CANCELLED result, e.g. on connection loss */
+		void CancelTransactions(void);
+
+		/* awaitable requests for coroutines of ModbusCoroutineExecutor (ModbusCoroutines.h), co_await returns transaction result */
+		ModbusTransactionAwaiter AwaitReadRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData);
+		ModbusTransactionAwaiter AwaitWriteRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData);
+		ModbusTransactionAwaiter AwaitReadAllRegisters(void);
+
+	private:
+		//block of read plan - one request for neighbour elements of function code
+		struct readPlanBlock
 		{
 			uint8_t functionCode;
-			uint16_t bytesCount;
-			int attemptsCount;
-			UINT timerIdentifier;
-			void Reset(void)
-			{
-				this->functionCode = 0;
-				this->bytesCount = 0;
-				this->attemptsCount = 0;
-				this->timerIdentifier = 0;
-			}
-		} lastRequestInfo = {};
+			uint16_t startingAddress;
+			uint16_t quantityOfData;
+		};
+		//read plan of all elements of register map and max hole inside block
+		vector <readPlanBlock> readPlan;
+		uint16_t readGapTolerance = 0;
+		/* build read plan for all elements of register map */
+		bool buildReadPlan(void);
+		//read of all registers by plan: next block of plan, blocks in flight, first error of blocks, result callback;
+		//requests are sent by one thread at a time, calls of other threads are repeated by it
+		std::atomic <bool> readAllActive = false;
+		size_t readAllNext = 0;
+		std::atomic <size_t> readAllPending = 0;
+		std::atomic <int> readAllResult = 0;
+		std::atomic <int> readAllSendCalls = 0;
+		TransactionCallbackFuncObj readAllCallback = nullptr;
+		/* send next blocks of plan while there is free place, finish read after last block */
+		void continueReadAll(void);
+		void readAllBlockFinished(int result);
 
 		//timeout, ms
 		int responseTimeout = 2000;
 		//number of attempts if request error
 		int numberOfAttempts = 3;
 
-		/*  */
-		void timeoutExpired(void);
-
 		/* private utils functions */
-		bool requestFunc_01_02_03_04(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData);
-		int parsingAnswerFunc_01_02(vector <uint8_t>& inputBuffer);
-		int parsingAnswerFunc_03_04(vector <uint8_t>& inputBuffer);
-		bool requestFunc_05_06(uint8_t functionCode, uint16_t outputAddress);
-		int parsingAnswerFunc_05_06(vector <uint8_t>& inputBuffer);
-		bool requestFunc_15_16(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData);
-		int parsingAnswerFunc_15_16(vector <uint8_t>& inputBuffer);
+		//answer parsing functions get request frame (address and PDU) and answer frame
+		int parsingAnswerFunc_01_02(const uint8_t* request, const uint8_t* inputBuffer);
+		int parsingAnswerFunc_03_04(const uint8_t* request, const uint8_t* inputBuffer);
+		int parsingAnswerFunc_05_06(const uint8_t* request, const uint8_t* inputBuffer);
+		int parsingAnswerFunc_15_16(const uint8_t* request, const uint8_t* inputBuffer);
+
+		//-----------transactions-----------
+		//MBAP header size
+		static const size_t mbapHeaderSize = 7;
+		//max window - transaction identifier keeps slot of transaction in low bits
+		static const size_t transactionsWindowMax = 1024;
+		//states of transaction slot
+		enum masterTransactionStates
+		{
+			MT_STATE_FREE = 0,
+			MT_STATE_IN_FLIGHT,
+			MT_STATE_FINISHING
+		};
+		//transaction: request frame (address or unit identifier and PDU) for answer parsing and repeats,
+		//timeout timer, repeats left, result callback
+		struct masterTransaction
+		{
+			int state = MT_STATE_FREE;
+			uint16_t transactionId = 0;
+			uint16_t requestLength = 0;
+			uint8_t request[rtuFrameMaxSize];
+			UINT timerIdentifier = 0;
+			int attemptsCount = 0;
+			TransactionCallbackFuncObj callback = nullptr;
+		};
+		bool tcpMode = false;
+		size_t transactionsWindow = 1;
+		//slots count - power of 2, not less than window; free slots stack
+		vector <masterTransaction> transactions;
+		vector <uint16_t> freeTransactions;
+		uint16_t transactionsMask = 0;
+		uint16_t transactionsSequence = 0;
+		//transaction in flight of RTU mode
+		uint16_t rtuTransactionId = 0;
+		std::atomic <size_t> transactionsInFlight = 0;
+		//transactions are started by user threads and finished by receive path and timers
+		std::atomic_flag transactionsLock = ATOMIC_FLAG_INIT;
+
+		/* transactions processing */
+		void lockTransactions(void);
+		void unlockTransactions(void);
+		size_t buildRequestFrame(uint8_t* frame, uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData);
+		bool sendTransaction(uint8_t functionCode, uint16_t startingAddress, uint16_t quantityOfData, TransactionCallbackFuncObj callback);
+		bool sendRequestFrame(const uint8_t* request, size_t requestLength, uint16_t transactionId);
+		void finishTransaction(uint16_t transactionId, const uint8_t* answer, size_t answerLength, int result);
+		void transactionTimeoutExpired(uint16_t transactionId);
+		int parseAnswerFrame(const uint8_t* request, const uint8_t* answer, size_t answerLength);
+		bool parseTcpFrames(const uint8_t* data, size_t dataLength, size_t* parsedLength);
+		void inputTcpDataParse(const uint8_t* inputBuffer, size_t inputLen);
+		void inputRtuDataParse(const uint8_t* inputBuffer, size_t inputLen);
+		void processAnswerFrame(const uint8_t* answerFrame, size_t frameLength);
 };
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
@@ -309,16 +651,90 @@ class ModbusProtocolSlave: public ModbusProtocolBase
 		/* parse input packet (in buffer) */
 		void inputPacketParse(uint8_t* inputBuffer, size_t inputLen);
 
-	private:
+		/* process request PDU of transport with own framing (Modbus TCP), answer PDU is written to response */
+		//unit identifier 0xFF or 0 addresses this device; returns answer PDU length, 0 - no answer
+		size_t ProcessRequestPDU(uint8_t unitId, const uint8_t* pdu, size_t pduLength, uint8_t* response, size_t responseCapacity);
 
-		/* modbus functions processing */
-		int processingFunc01_02(inputPackTemplateF01F04* inputPacket);
-		int processingFunc03_04(inputPackTemplateF01F04* inputPacket);
-		int processingFunc05(inputPackTemplateF05F06* inputPacket);
-		int processingFunc06(inputPackTemplateF05F06* inputPacket);
-		int processingFunc15(inputPackTemplateF15F16* inputPacket);
-		int processingFunc16(inputPackTemplateF15F16* inputPacket);
-		int processingExceptionResponse(inputPackTemplateF01F04* inputPacket, modbusExceptionCode excepCode);
+		/* enable or disable sending of all answers for one received data block by one send call, disabled by default */
+		//for transports without frame timing only (TCP, gateways) - RTU line needs silent interval between frames
+		void SetResponsesBatching(bool enable)
+		{
+			this->responsesBatching = enable;
+		}
+
+		/* enable or disable cache of answers for read requests (functions 0x01 to 0x04), enabled by default */
+		void SetResponseCacheEnabled(bool enable)
+		{
+			this->responseCacheEnabled = enable;
+			this->ResetResponseCache();
+		}
+		/* drop all cached answers */
+		void ResetResponseCache(void)
+		{
+			for (size_t i = 0; i < responseCacheSize; i++)
+			{
+				this->responseCache[i].responseLength = 0;
+			}
+		}
+		/* counters of read requests answered from cache and built from register map */
+		uint64_t GetResponseCacheHits(void) const
+		{
+			return this->responseCacheHits;
+		}
+		uint64_t GetResponseCacheMisses(void) const
+		{
+			return this->responseCacheMisses;
+		}
+
+	private:
+		/* cached answer for read request */
+		struct responseCacheEntry
+		{
+			//request bytes without CRC, after bytes rotation
+			uint8_t request[sizeof(inputPackTemplateF01F04) - 2];
+			//register map and version of its table for answer
+			ModbusRegMap* registerMap;
+			uint32_t tableVersion;
+			//answer with CRC, 0 - entry is empty
+			uint16_t responseLength;
+			uint8_t response[256];
+		};
+		//count of cache entries, entry for request is selected by hash of request
+		static const size_t responseCacheSize = 16;
+		responseCacheEntry responseCache[responseCacheSize] = {};
+		bool responseCacheEnabled = true;
+		uint64_t responseCacheHits = 0;
+		uint64_t responseCacheMisses = 0;
+
+		//answer frame for current request
+		ModbusFrameBuilder responseFrame;
+
+		//answers batching mode and answers for one received data block
+		bool responsesBatching = false;
+		vector <uint8_t> responsesBatchBuffer;
+
+		/* process first complete request frame from input buffer */
+		bool processInputFrame(void);
+		/* process complete request frames from begin of received data without input buffer, returns length of processed frames */
+		size_t processReceivedFrames(const uint8_t* data, size_t dataLength);
+		/* process request frame with CRC, frame isn't changed */
+		void processFrame(const uint8_t* frame, size_t frameLength);
+		/* process request frame (address and PDU), returns answer with CRC and its length, 0 - no answer */
+		size_t processRequest(uint8_t* inputFrame, uint8_t** answer);
+		/* send answer or add it to answers batch */
+		void sendResponse(uint8_t* response, size_t responseLength);
+
+		/* get cache entry for read request, nullptr if request answer can't be cached */
+		responseCacheEntry* getResponseCacheEntry(inputPackTemplateF01F04* inputPacket);
+
+		/* modbus functions processing, return NO_EXCEPTION or exception code for error answer */
+		modbusExceptionCode processingFunc01_02(inputPackTemplateF01F04* inputPacket);
+		modbusExceptionCode processingFunc03_04(inputPackTemplateF01F04* inputPacket);
+		modbusExceptionCode processingFunc05(inputPackTemplateF05F06* inputPacket);
+		modbusExceptionCode processingFunc06(inputPackTemplateF05F06* inputPacket);
+		modbusExceptionCode processingFunc15(inputPackTemplateF15F16* inputPacket);
+		modbusExceptionCode processingFunc16(inputPackTemplateF15F16* inputPacket);
+		void processingExceptionResponse(inputPackTemplateF01F04* inputPacket, modbusExceptionCode excepCode);
 };
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
@@ -9,11 +9,15 @@
 #include <string>
 #include <fstream>
 #include <functional>
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include "ModbusRegisterMap.h"
 #include "ModbusProtocolHandler.h"
 #include "IndustryDataStreamsAL.h"
 
+#ifdef _WIN32
+//modbus RTU slave on COM port, configuration from config.ini
 int main()
 {
 	setlocale(LC_ALL, "en_US.UTF-8");
@@ -121,3 +125,156 @@ int main()
 
 	return 0;
 }
+#else
+//modbus RTU slave on serial device (tty or pseudo-terminal)
+static int runSerialSlave(const char* mapFileName, const char* deviceName, int deviceAddress, int baudRate)
+{
+	if (deviceAddress < 0 || deviceAddress > 247)
+	{
+		std::cout << "Invalid device address. Exit..." << endl;
+		return 0;
+	}
+
+	//string for input text
+	string inputStr("");
+
+	//create and load registers map
+	ModbusRegMap registerMap;
+	if (!registerMap.LoadFromFile(mapFileName))
+	{
+		std::cout << "Can't load registers map. Exit..." << endl;
+		return 0;
+	}
+	std::cout << "Protocol name = " << registerMap.GetModbusProtocolName() << endl;
+	std::cout << "Protocol version = " << registerMap.GetModbusProtocolVersion() << endl;
+
+	//create modbus slave device
+	ModbusProtocolSlave modbusSlave;
+	if (!modbusSlave.SetRegisterMap(&registerMap) || !modbusSlave.SetDeviceAddress(deviceAddress))
+	{
+		std::cout << "Can't configuration modbus slave device. Exit..." << endl;
+		return 0;
+	}
+
+	//configuration and open serial device
+	DataStreamSerial serialStream;
+	if (!serialStream.SetDeviceName(deviceName) || !serialStream.SetBaudRate((uint32_t)baudRate))
+	{
+		std::cout << "Invalid serial device config, device = " << deviceName << ", BR = " << baudRate << endl;
+		std::cout << "Exit..." << endl;
+		return 0;
+	}
+	serialStream.SetDataReceiveFunc(
+		std::bind(&ModbusProtocolSlave::inputPacketParse, &modbusSlave, std::placeholders::_1, std::placeholders::_2));
+	modbusSlave.SetSendDataFunc(
+		std::bind(&DataStreamSerial::SendData, &serialStream, std::placeholders::_1, std::placeholders::_2));
+	if (!serialStream.StreamStart())
+	{
+		std::cout << "Can't open serial device. Exit..." << endl;
+		return 0;
+	}
+	std::cout << "Open serial device " << deviceName << " at BR = " << baudRate << endl;
+	while (std::cin >> inputStr && inputStr != "exit")
+	{
+	}
+	serialStream.StreamStop();
+
+	return 0;
+}
+
+//modbus TCP slave: ModbusProtocolTest <registers map file> [TCP port] [device address] [workers count] [epoll|uring]
+//modbus RTU slave: ModbusProtocolTest <registers map file> <serial device> [device address] [baud rate]
+int main(int argc, char* argv[])
+{
+	setlocale(LC_ALL, "en_US.UTF-8");
+	std::cout << "Start program here...\n";
+
+	//read registers map file name, TCP port, device address, count of server threads and sockets backend
+	if (argc < 2)
+	{
+		std::cout << "Usage: ModbusProtocolTest <registers map file> [TCP port] [device address] [workers count] [epoll|uring]" << endl;
+		std::cout << "       ModbusProtocolTest <registers map file> <serial device> [device address] [baud rate]" << endl;
+		return 0;
+	}
+	//path of serial device instead of TCP port
+	if (argc > 2 && argv[2][0] == '/')
+	{
+		return runSerialSlave(argv[1], argv[2], (argc > 3) ? atoi(argv[3]) : 1, (argc > 4) ? atoi(argv[4]) : 9600);
+	}
+	int tcpPort = (argc > 2) ? atoi(argv[2]) : 502;
+	int deviceAddress = (argc > 3) ? atoi(argv[3]) : 1;
+	int workersCount = (argc > 4) ? atoi(argv[4]) : 1;
+	string backend = (argc > 5) ? argv[5] : "epoll";
+	if (tcpPort <= 0 || tcpPort > 65535)
+	{
+		std::cout << "Invalid TCP port, port = " << tcpPort << endl;
+		std::cout << "Exit..." << endl;
+		return 0;
+	}
+	if (deviceAddress < 0 || deviceAddress > 247)
+	{
+		std::cout << "Invalid device address. Exit..." << endl;
+		return 0;
+	}
+	if (workersCount < 1 || workersCount > 256)
+	{
+		std::cout << "Invalid workers count. Exit..." << endl;
+		return 0;
+	}
+	if (backend != "epoll" && backend != "uring")
+	{
+		std::cout << "Invalid sockets backend, epoll or uring. Exit..." << endl;
+		return 0;
+	}
+
+	//string for input text
+	string inputStr("");
+
+	//create and load registers map
+	ModbusRegMap registerMap;
+	if (!registerMap.LoadFromFile(argv[1]))
+	{
+		std::cout << "Can't load registers map. Exit..." << endl;
+		return 0;
+	}
+	std::cout << "Protocol name = " << registerMap.GetModbusProtocolName() << endl;
+	std::cout << "Protocol version = " << registerMap.GetModbusProtocolVersion() << endl;
+
+	//create modbus slave device for each server thread, all devices share one registers map
+	vector <ModbusProtocolSlave> modbusSlaves(workersCount);
+	for (ModbusProtocolSlave& modbusSlave : modbusSlaves)
+	{
+		if (!modbusSlave.SetRegisterMap(&registerMap) || !modbusSlave.SetDeviceAddress(deviceAddress))
+		{
+			std::cout << "Can't configuration modbus slave device. Exit..." << endl;
+			return 0;
+		}
+	}
+
+	//start modbus TCP server, requests of clients of each thread are processed by own slave device;
+	//threads are pinned to cores for several threads
+	DataStreamEthernet ethernetStream((uint16_t)tcpPort);
+	ethernetStream.SetWorkersCount((size_t)workersCount);
+	ethernetStream.SetWorkersPinning(workersCount > 1);
+	ethernetStream.SetIoUringMode(backend == "uring");
+	for (int i = 0; i < workersCount; i++)
+	{
+		ethernetStream.SetWorkerRequestHandler((size_t)i,
+			std::bind(&ModbusProtocolSlave::ProcessRequestPDU, &modbusSlaves[i], std::placeholders::_1, std::placeholders::_2,
+				std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
+	}
+	if (!ethernetStream.StreamStart())
+	{
+		std::cout << "Can't start modbus TCP server. Exit..." << endl;
+		return 0;
+	}
+	std::cout << "Modbus TCP server at port " << tcpPort << ", threads: " << workersCount <<
+		", backend: " << (ethernetStream.IsIoUringActive() ? "io_uring" : "epoll") << endl;
+	while (std::cin >> inputStr && inputStr != "exit")
+	{
+	}
+	ethernetStream.StreamStop();
+
+	return 0;
+}
+#endif
@@ -6,6 +6,7 @@
 //*********************************************************************************************************//
 
 #include <fstream>
+#include <math.h>
 #include "ModbusRegisterMap.h"
 
 using std::enable_if_t;
@@ -18,6 +19,67 @@ using std::is_integral;
 #define assertJsonConditionObj(condition) if ((!condition)) {this->Clear(); return false;}
 #define assertJsonTwoConditionsObj(condition1, condition2) if (!(condition1 && condition2)) {this->Clear(); return false;}
 
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* get memory for object from arena */
+void* ModbusRegArena::Allocate(size_t size, size_t alignment)
+{
+	//align position in current block
+	uintptr_t alignedPos = ((uintptr_t)this->currentBlockPos + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	if (!this->currentBlockPos || alignedPos + size > (uintptr_t)this->currentBlockEnd)
+	{
+		//new block, big object gets own block
+		size_t newBlockSize = (size + alignment > this->BlockSize) ? size + alignment : this->BlockSize;
+		char* newBlock = new (std::nothrow) char[newBlockSize];
+		if (!newBlock)
+		{
+			return nullptr;
+		}
+		try
+		{
+			this->Blocks.push_back(newBlock);
+		}
+		catch (...)
+		{
+			delete[] newBlock;
+			return nullptr;
+		}
+		this->currentBlockPos = newBlock;
+		this->currentBlockEnd = newBlock + newBlockSize;
+		alignedPos = ((uintptr_t)this->currentBlockPos + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	}
+	this->currentBlockPos = (char*)(alignedPos + size);
+	return (void*)alignedPos;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* create copy of c-string in arena */
+char* ModbusRegArena::CopyString(const char* str)
+{
+	size_t strSize = strlen(str) + 1;
+	char* newStr = (char*)this->Allocate(strSize, 1);
+	if (newStr)
+	{
+		memcpy(newStr, str, strSize);
+	}
+	return newStr;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* release all arena blocks */
+void ModbusRegArena::Release()
+{
+	for (char* block : this->Blocks)
+	{
+		delete[] block;
+	}
+	this->Blocks.clear();
+	this->currentBlockPos = nullptr;
+	this->currentBlockEnd = nullptr;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 /* constructor */
 ModbusRegMap::ModbusRegMap()
@@ -38,35 +100,411 @@ ModbusRegMap::~ModbusRegMap()
 /* clear this object */
 void ModbusRegMap::Clear()
 {
-	//clear map container
-	if (this->MainRegMap.size())
+	//clear map container - delete elements, pages and tables
+	for (uint32_t tableIndex = 0; tableIndex < RegTablesCount; tableIndex++)
 	{
-		for (map <int, ModbusElementBase*>::iterator iter = this->MainRegMap.begin(); iter != this->MainRegMap.end(); ++iter)
+		ModbusRegTable* regTable = this->RegTables[tableIndex];
+		if (!regTable)
+		{
+			continue;
+		}
+		beginTableWrite((uint8_t)tableIndex);
+		for (uint32_t pageIndex = 0; pageIndex < RegPagesCount; pageIndex++)
 		{
-			ModbusElementBase* modbusElement = iter->second->GetModElObject();
-			if (modbusElement)
+			ModbusRegPage* regPage = regTable->pages[pageIndex];
+			if (!regPage)
 			{
-				delete modbusElement;
+				continue;
 			}
+			for (uint32_t cellIndex = 0; cellIndex < RegPageSize; cellIndex++)
+			{
+				if (!regPage->elements[cellIndex])
+				{
+					continue;
+				}
+				//element in arena - only destroy, memory is released with arena
+				if (this->UseArena)
+				{
+					regPage->elements[cellIndex]->~ModbusElementBase();
+				}
+				else
+				{
+					delete regPage->elements[cellIndex];
+				}
+			}
+			delete regPage;
+		}
+		if (regTable->bits)
+		{
+			delete regTable->bits;
 		}
-		this->MainRegMap.clear();
+		ModbusWireImage* wireImage = regTable->wire.load(std::memory_order_relaxed);
+		if (wireImage)
+		{
+			delete wireImage;
+		}
+		delete regTable;
+		this->RegTables[tableIndex] = nullptr;
+		endTableWrite((uint8_t)tableIndex);
 	}
+	this->RegElementsCount = 0;
+	//release all arena memory at once
+	this->ElementsArena.Release();
 	//clear variables
 	this->ProtocolName = "";
 	this->ProtocolVersion = "";
 	//reset iterator
-	currentElementIter = this->MainRegMap.begin();
+	currentElementKey = RegKeysCount;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* find and get element by function code and register address, nullptr if not exist */
+ModbusElementBase* ModbusRegMap::getModbusElement(uint8_t functionCode, uint16_t registerAddress)
+{
+	//table of function code
+	ModbusRegTable* regTable = this->RegTables[functionCode];
+	if (!regTable)
+	{
+		return nullptr;
+	}
+	//page of address
+	ModbusRegPage* regPage = regTable->pages[registerAddress / RegPageSize];
+	if (!regPage)
+	{
+		return nullptr;
+	}
+	//element in page
+	return regPage->elements[registerAddress % RegPageSize];
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* get cell for new element by function code and register address, create table and page if not exist */
+ModbusElementBase** ModbusRegMap::createModbusElementCell(uint8_t functionCode, uint16_t registerAddress)
+{
+	//table of function code
+	ModbusRegTable*& regTable = this->RegTables[functionCode];
+	if (!regTable)
+	{
+		regTable = new ModbusRegTable();
+	}
+	//page of address
+	ModbusRegPage*& regPage = regTable->pages[registerAddress / RegPageSize];
+	if (!regPage)
+	{
+		regPage = new ModbusRegPage();
+	}
+	//cell in page
+	return &regPage->elements[registerAddress % RegPageSize];
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
 /*-----------------------------------------------------------------------------------------------------------------------------*/
-/* find and get element by function code and register address */
-map <int, ModbusElementBase*>::iterator ModbusRegMap::getModbusElement(uint8_t functionCode, uint16_t registerAddress)
+/* local functions for bulk access to packed bits, word (64 bits) at a time */
+//get up to 64 bits from bit position, unused high bits are zero
+inline uint64_t getBitsWord(const uint64_t* words, uint32_t wordsCount, uint32_t bitPos, uint32_t bitsCount)
 {
-	//calc key value
-	uint32_t key = ((uint32_t)functionCode << 16) | (uint32_t)registerAddress;
-	//find element by key
-	return this->MainRegMap.find(key);
+	uint32_t wordIndex = bitPos / 64;
+	uint32_t bitShift = bitPos % 64;
+	uint64_t bitsWord = words[wordIndex] >> bitShift;
+	if (bitShift && wordIndex + 1 < wordsCount)
+	{
+		bitsWord |= words[wordIndex + 1] << (64 - bitShift);
+	}
+	if (bitsCount < 64)
+	{
+		bitsWord &= ((uint64_t)1 << bitsCount) - 1;
+	}
+	return bitsWord;
+}
+//put up to 64 bits to bit position, other bits are not changed
+inline void putBitsWord(uint64_t* words, uint32_t wordsCount, uint32_t bitPos, uint32_t bitsCount, uint64_t bitsWord)
+{
+	uint32_t wordIndex = bitPos / 64;
+	uint32_t bitShift = bitPos % 64;
+	uint64_t bitsMask = (bitsCount < 64) ? ((uint64_t)1 << bitsCount) - 1 : ~(uint64_t)0;
+	words[wordIndex] = (words[wordIndex] & ~(bitsMask << bitShift)) | ((bitsWord & bitsMask) << bitShift);
+	if (bitShift && bitShift + bitsCount > 64 && wordIndex + 1 < wordsCount)
+	{
+		words[wordIndex + 1] = (words[wordIndex + 1] & ~(bitsMask >> (64 - bitShift))) | ((bitsWord & bitsMask) >> (64 - bitShift));
+	}
+}
+//extract bits from bit offset to bytes buffer, first bit in LSB of first byte
+inline void extractBits(const uint64_t* words, uint32_t wordsCount, uint32_t bitOffset, uint32_t bitsCount, uint8_t* buffer)
+{
+	for (uint32_t bitIndex = 0; bitIndex < bitsCount; bitIndex += 64)
+	{
+		uint32_t chunkBitsCount = (bitsCount - bitIndex < 64) ? bitsCount - bitIndex : 64;
+		uint64_t bitsWord = getBitsWord(words, wordsCount, bitOffset + bitIndex, chunkBitsCount);
+		for (uint32_t byteIndex = 0; byteIndex < (chunkBitsCount + 7) / 8; byteIndex++)
+		{
+			buffer[bitIndex / 8 + byteIndex] = (uint8_t)(bitsWord >> (byteIndex * 8));
+		}
+	}
+}
+//get up to 64 bits from bytes buffer, first bit in LSB of first byte
+inline uint64_t loadBitsWord(const uint8_t* buffer, uint32_t bitIndex, uint32_t bitsCount)
+{
+	uint64_t bitsWord = 0;
+	for (uint32_t byteIndex = 0; byteIndex < (bitsCount + 7) / 8; byteIndex++)
+	{
+		bitsWord |= (uint64_t)buffer[bitIndex / 8 + byteIndex] << (byteIndex * 8);
+	}
+	if (bitsCount < 64)
+	{
+		bitsWord &= ((uint64_t)1 << bitsCount) - 1;
+	}
+	return bitsWord;
+}
+//deposit bits from bytes buffer to bit offset
+inline void depositBits(uint64_t* words, uint32_t wordsCount, uint32_t bitOffset, uint32_t bitsCount, const uint8_t* buffer)
+{
+	for (uint32_t bitIndex = 0; bitIndex < bitsCount; bitIndex += 64)
+	{
+		uint32_t chunkBitsCount = (bitsCount - bitIndex < 64) ? bitsCount - bitIndex : 64;
+		putBitsWord(words, wordsCount, bitOffset + bitIndex, chunkBitsCount, loadBitsWord(buffer, bitIndex, chunkBitsCount));
+	}
+}
+//check all bits of range are set
+inline bool checkBitsSet(const uint64_t* words, uint32_t wordsCount, uint32_t bitOffset, uint32_t bitsCount)
+{
+	for (uint32_t bitIndex = 0; bitIndex < bitsCount; bitIndex += 64)
+	{
+		uint32_t chunkBitsCount = (bitsCount - bitIndex < 64) ? bitsCount - bitIndex : 64;
+		uint64_t bitsMask = (chunkBitsCount < 64) ? ((uint64_t)1 << chunkBitsCount) - 1 : ~(uint64_t)0;
+		if (getBitsWord(words, wordsCount, bitOffset + bitIndex, chunkBitsCount) != bitsMask)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* add one bit element to packed values of its table, create packed values if not exist */
+bool ModbusRegMap::addBitElement(ModbusElementBase* modElBase)
+{
+	ModbusRegTable* regTable = this->RegTables[modElBase->GetFunctionCode()];
+	if (!regTable->bits)
+	{
+		regTable->bits = new (std::nothrow) ModbusBitTable();
+		if (!regTable->bits)
+		{
+			return false;
+		}
+	}
+	ModbusElement <uint8_t>* modbusElement = (ModbusElement <uint8_t>*)modElBase;
+	uint16_t registerAddress = modElBase->GetRegisterAddress();
+	uint64_t bitMask = (uint64_t)1 << (registerAddress % 64);
+	uint64_t* bitWord;
+	//mark element exists
+	regTable->bits->present[registerAddress / 64] |= bitMask;
+	//mark allowed values - inside min/max range of element
+	uint8_t minValue = modbusElement->GetMinDataValue();
+	uint8_t maxValue = modbusElement->GetMaxDataValue();
+	bitWord = &regTable->bits->allowZero[registerAddress / 64];
+	*bitWord = (minValue == 0) ? (*bitWord | bitMask) : (*bitWord & ~bitMask);
+	bitWord = &regTable->bits->allowOne[registerAddress / 64];
+	*bitWord = (minValue <= 1 && maxValue >= 1) ? (*bitWord | bitMask) : (*bitWord & ~bitMask);
+	//default value
+	storeBitElement(modElBase);
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* value of one bit element from packed values - packed values are main storage, element isn't changed by readers */
+uint8_t ModbusRegMap::loadBitElement(const ModbusElementBase* modElBase) const
+{
+	ModbusBitTable* bitTable = this->RegTables[modElBase->GetFunctionCode()]->bits;
+	uint16_t registerAddress = modElBase->GetRegisterAddress();
+	return (uint8_t)((bitTable->values[registerAddress / 64] >> (registerAddress % 64)) & 0x01);
+}
+
+/* copy value of one bit element to packed values */
+void ModbusRegMap::storeBitElement(ModbusElementBase* modElBase)
+{
+	ModbusBitTable* bitTable = this->RegTables[modElBase->GetFunctionCode()]->bits;
+	uint16_t registerAddress = modElBase->GetRegisterAddress();
+	uint64_t bitMask = (uint64_t)1 << (registerAddress % 64);
+	if (((ModbusElement <uint8_t>*)modElBase)->GetDataValue() & 0x01)
+	{
+		bitTable->values[registerAddress / 64] |= bitMask;
+	}
+	else
+	{
+		bitTable->values[registerAddress / 64] &= ~bitMask;
+	}
+}
+
+/* update data depending on element value after value change */
+void ModbusRegMap::elementValueChanged(ModbusElementBase* modElBase)
+{
+	//one bit element value is stored packed
+	if (modElBase->GetDataType() == ModbusDataType::OneBit)
+	{
+		storeBitElement(modElBase);
+	}
+	//register value is stored in wire format image too
+	ModbusWireImage* wireImage = this->RegTables[modElBase->GetFunctionCode()]->wire.load(std::memory_order_relaxed);
+	if (wireImage)
+	{
+		storeWireElement(wireImage, modElBase);
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* lock and unlock writers - for changes without change of values */
+void ModbusRegMap::lockWriters(void)
+{
+	while (this->WriteLock.test_and_set(std::memory_order_acquire))
+	{
+	}
+}
+
+void ModbusRegMap::unlockWriters(void)
+{
+	this->WriteLock.clear(std::memory_order_release);
+}
+
+/* begin change of table - lock writers, odd version of table */
+void ModbusRegMap::beginTableWrite(uint8_t functionCode)
+{
+	lockWriters();
+	this->TableVersions[functionCode].store(this->TableVersions[functionCode].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+/* end change of table - even version of table, unlock writers */
+void ModbusRegMap::endTableWrite(uint8_t functionCode)
+{
+	this->TableVersions[functionCode].store(this->TableVersions[functionCode].load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	unlockWriters();
+}
+
+/* begin read of table - wait end of table change, returns version of table for check after reading */
+uint32_t ModbusRegMap::beginTableRead(uint8_t functionCode) const
+{
+	uint32_t tableVersion;
+	while ((tableVersion = this->TableVersions[functionCode].load(std::memory_order_acquire)) & 1)
+	{
+	}
+	return tableVersion;
+}
+
+/* end read of table - false if table was changed during reading and data must be read again */
+bool ModbusRegMap::endTableRead(uint8_t functionCode, uint32_t tableVersion) const
+{
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return this->TableVersions[functionCode].load(std::memory_order_relaxed) == tableVersion;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* create wire format image of table and fill it with values of existing elements */
+bool ModbusRegMap::createWireImage(ModbusRegTable* regTable)
+{
+	//image is filled before publishing - concurrent readers see no image or complete image
+	ModbusWireImage* wireImage = new (std::nothrow) ModbusWireImage();
+	if (!wireImage)
+	{
+		return false;
+	}
+	for (uint32_t pageIndex = 0; pageIndex < RegPagesCount; pageIndex++)
+	{
+		ModbusRegPage* regPage = regTable->pages[pageIndex];
+		if (!regPage)
+		{
+			continue;
+		}
+		for (uint32_t cellIndex = 0; cellIndex < RegPageSize; cellIndex++)
+		{
+			if (regPage->elements[cellIndex])
+			{
+				addWireElement(wireImage, regPage->elements[cellIndex]);
+			}
+		}
+	}
+	regTable->wire.store(wireImage, std::memory_order_release);
+	return true;
+}
+
+/* add element registers to wire format image */
+//one bit elements are stored packed and not included to image, range with such element is read element by element
+void ModbusRegMap::addWireElement(ModbusWireImage* wireImage, ModbusElementBase* modElBase)
+{
+	if (wireImage->overlapped || modElBase->GetDataType() == ModbusDataType::OneBit)
+	{
+		return;
+	}
+	uint32_t registerAddress = modElBase->GetRegisterAddress();
+	uint32_t elRegistersCount = ModbusDataTypeRegistersCount(modElBase->GetDataType());
+	if (!elRegistersCount || registerAddress + elRegistersCount > 0x10000)
+	{
+		return;
+	}
+	//registers of elements overlap - image can't represent element by element reading, don't use image
+	if (getBitsWord(wireImage->covered, BitWordsCount, registerAddress, elRegistersCount))
+	{
+		wireImage->overlapped = true;
+		return;
+	}
+	putBitsWord(wireImage->covered, BitWordsCount, registerAddress, elRegistersCount, ~(uint64_t)0);
+	if (elRegistersCount > 1)
+	{
+		putBitsWord(wireImage->continued, BitWordsCount, registerAddress + 1, elRegistersCount - 1, ~(uint64_t)0);
+	}
+	elementToWireData(modElBase, &wireImage->data[registerAddress * 2]);
+}
+
+/* copy value of element to wire format image */
+void ModbusRegMap::storeWireElement(ModbusWireImage* wireImage, ModbusElementBase* modElBase)
+{
+	uint16_t registerAddress = modElBase->GetRegisterAddress();
+	if (wireImage->overlapped || modElBase->GetDataType() == ModbusDataType::OneBit ||
+		!getBitsWord(wireImage->covered, BitWordsCount, registerAddress, 1))
+	{
+		return;
+	}
+	elementToWireData(modElBase, &wireImage->data[registerAddress * 2]);
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* find first existing element with key (function code << 16 | address) not less than start key */
+ModbusElementBase* ModbusRegMap::findNextElement(uint32_t startKey, uint32_t* foundKey)
+{
+	for (uint32_t key = startKey; key < RegKeysCount; )
+	{
+		//skip not existing table
+		ModbusRegTable* regTable = this->RegTables[key >> 16];
+		if (!regTable || !regTable->elementsCount)
+		{
+			key = ((key >> 16) + 1) << 16;
+			continue;
+		}
+		//skip not existing page
+		ModbusRegPage* regPage = regTable->pages[(key & 0xFFFF) / RegPageSize];
+		if (!regPage)
+		{
+			key = (key / RegPageSize + 1) * RegPageSize;
+			continue;
+		}
+		//check cells of page
+		for (uint32_t cellIndex = key % RegPageSize; cellIndex < RegPageSize; cellIndex++, key++)
+		{
+			if (regPage->elements[cellIndex])
+			{
+				*foundKey = key;
+				return regPage->elements[cellIndex];
+			}
+		}
+	}
+	*foundKey = RegKeysCount;
+	return nullptr;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
@@ -77,7 +515,7 @@ bool ModbusRegMap::AddNewElement(uint8_t functionCode, uint16_t registerAddress,
 	uint8_t decimalPoints, ModElType& value, ModElType& minDataValue, ModElType& maxDataValue, const char* registerUnit)
 {
 	//find existing value
-	if (getModbusElement(functionCode, registerAddress) != this->MainRegMap.end())
+	if (getModbusElement(functionCode, registerAddress))
 	{
 		return false;
 	}
@@ -85,18 +523,62 @@ bool ModbusRegMap::AddNewElement(uint8_t functionCode, uint16_t registerAddress,
 	if (!bytesCount) return false;
 	if (dataType < ModbusDataType::FirstDataType || dataType > ModbusDataType::LastDataType) return false;
 	if (!registerName) return false;
+	if (dataType == ModbusDataType::OneBit && !is_same<ModElType, uint8_t>::value) return false;
 
+	tableWriteSection writeSection(this, functionCode);
 	try
 	{
-		//new modbus element object
-		ModbusElement <ModElType>* newModbusElement = new ModbusElement <ModElType>(registerName, functionCode,
-			registerAddress, bytesCount, dataType, decimalPoints, value, minDataValue, maxDataValue, registerUnit);
+		//new modbus element object - in arena or in heap
+		ModbusElement <ModElType>* newModbusElement = nullptr;
+		if (this->UseArena)
+		{
+			void* elementMemory = this->ElementsArena.Allocate(sizeof(ModbusElement <ModElType>), alignof(ModbusElement <ModElType>));
+			if (elementMemory)
+			{
+				newModbusElement = new (elementMemory) ModbusElement <ModElType>(registerName, functionCode,
+					registerAddress, bytesCount, dataType, decimalPoints, value, minDataValue, maxDataValue, registerUnit, &this->ElementsArena);
+			}
+		}
+		else
+		{
+			newModbusElement = new ModbusElement <ModElType>(registerName, functionCode,
+				registerAddress, bytesCount, dataType, decimalPoints, value, minDataValue, maxDataValue, registerUnit);
+		}
 		if (newModbusElement)
 		{
-			//calc key value
-			uint32_t key = ((uint32_t)functionCode << 16) | (uint32_t)registerAddress;
 			//insert new element
-			this->MainRegMap.insert(std::pair<int, ModbusElementBase*>(key, (ModbusElementBase*)newModbusElement));
+			ModbusElementBase** elementCell;
+			try
+			{
+				elementCell = createModbusElementCell(functionCode, registerAddress);
+				//one bit element value is stored packed
+				if (dataType == ModbusDataType::OneBit && !addBitElement(newModbusElement))
+				{
+					throw - 1;
+				}
+			}
+			catch (...)
+			{
+				//arena memory of element is released with arena
+				if (this->UseArena)
+				{
+					newModbusElement->~ModbusElement <ModElType>();
+				}
+				else
+				{
+					delete newModbusElement;
+				}
+				throw;
+			}
+			*elementCell = (ModbusElementBase*)newModbusElement;
+			this->RegTables[functionCode]->elementsCount++;
+			//registers of element to wire format image, if image of table is used
+			ModbusWireImage* wireImage = this->RegTables[functionCode]->wire.load(std::memory_order_relaxed);
+			if (wireImage)
+			{
+				addWireElement(wireImage, newModbusElement);
+			}
+			this->RegElementsCount++;
 		}
 		else
 		{
@@ -116,7 +598,20 @@ bool ModbusRegMap::AddNewElement(uint8_t functionCode, uint16_t registerAddress,
 /* get elements count */
 size_t ModbusRegMap::ElementsCount()
 {
-	return this->MainRegMap.size();
+	return this->RegElementsCount;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* enable or disable arena allocation of elements - for empty register map only */
+bool ModbusRegMap::SetArenaAllocation(bool enable)
+{
+	if (this->RegElementsCount)
+	{
+		return false;
+	}
+	this->UseArena = enable;
+	return true;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
@@ -124,7 +619,7 @@ size_t ModbusRegMap::ElementsCount()
 /* find element by function code and register address, return exist or not */
 bool ModbusRegMap::ModbusElementExist(uint8_t functionCode, uint16_t registerAddress)
 {
-	return this->getModbusElement(functionCode, registerAddress) != this->MainRegMap.end();
+	return this->getModbusElement(functionCode, registerAddress) != nullptr;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
 
@@ -132,12 +627,7 @@ bool ModbusRegMap::ModbusElementExist(uint8_t functionCode, uint16_t registerAdd
 /* get element type */
 ModbusDataType ModbusRegMap::GetElementType(uint8_t functionCode, uint16_t registerAddress)
 {
-	map <int, ModbusElementBase*>::iterator elementIterator = getModbusElement(functionCode, registerAddress);
-	if (elementIterator == this->MainRegMap.end())
-	{
-		return ModbusDataType::UnknownDataType;
-	}
-	ModbusElementBase* modbusElement = elementIterator->second->GetModElObject();
+	ModbusElementBase* modbusElement = getModbusElement(functionCode, registerAddress);
 	if (!modbusElement)
 	{
 		return ModbusDataType::UnknownDataType;
@@ -461,7 +951,11 @@ bool ModbusRegMap::SaveToFile(const string& sourceFilePath)
 
 	//try open file
 	FILE* outputFile = nullptr;
+#ifdef _WIN32
 	fopen_s(&outputFile, sourceFilePath.c_str(), "wb");
+#else
+	outputFile = fopen(sourceFilePath.c_str(), "wb");
+#endif
 	if (outputFile == nullptr)
 	{
 		return false;
@@ -489,24 +983,26 @@ bool ModbusRegMap::SaveToFile(const string& sourceFilePath)
 	//save registers data to document
 	Value jsonRegistersArray;
 	jsonRegistersArray.SetArray();
-	for (auto regMapIter = this->MainRegMap.cbegin(); regMapIter != this->MainRegMap.cend(); ++regMapIter)
+	uint32_t regMapKey;
+	for (ModbusElementBase* regMapElement = findNextElement(0, &regMapKey); regMapElement != nullptr;
+		regMapElement = findNextElement(regMapKey + 1, &regMapKey))
 	{
 		try
 		{
 			//json val -> object
 			jsonVal.SetObject();
 			//write [Modbus Function Code]
-			jsonVal.AddMember(StringRef(ModbusElFunctionCodeStr), regMapIter->second->GetFunctionCode(), outputDoc.GetAllocator());
+			jsonVal.AddMember(StringRef(ModbusElFunctionCodeStr), regMapElement->GetFunctionCode(), outputDoc.GetAllocator());
 			//write [Modbus Register Address]
-			jsonVal.AddMember(StringRef(ModbusElAddressStr), regMapIter->second->GetRegisterAddress(), outputDoc.GetAllocator());
+			jsonVal.AddMember(StringRef(ModbusElAddressStr), regMapElement->GetRegisterAddress(), outputDoc.GetAllocator());
 			//write [Modbus Register Data Type]
-			jsonVal.AddMember(StringRef(ModbusElDataTypeStr), StringRef(ModbusDataTypeStrings[regMapIter->second->GetDataType()]), outputDoc.GetAllocator());
+			jsonVal.AddMember(StringRef(ModbusElDataTypeStr), StringRef(ModbusDataTypeStrings[regMapElement->GetDataType()]), outputDoc.GetAllocator());
 			//write [Modbus Register Bytes Count]
-			jsonVal.AddMember(StringRef(ModbusElBytesCountStr), regMapIter->second->GetBytesCount(), outputDoc.GetAllocator());
+			jsonVal.AddMember(StringRef(ModbusElBytesCountStr), regMapElement->GetBytesCount(), outputDoc.GetAllocator());
 			//write [Modbus Register Text Name]
-			if (regMapIter->second->GetRegisterName() != nullptr)
+			if (regMapElement->GetRegisterName() != nullptr)
 			{
-				jsonVal.AddMember(StringRef(ModbusElRegName), StringRef(regMapIter->second->GetRegisterName()), outputDoc.GetAllocator());
+				jsonVal.AddMember(StringRef(ModbusElRegName), StringRef(regMapElement->GetRegisterName()), outputDoc.GetAllocator());
 			}
 			else
 			{
@@ -514,38 +1010,38 @@ bool ModbusRegMap::SaveToFile(const string& sourceFilePath)
 			}
 			
 			//get data type and save to JSON depending on data type
-			ModbusDataType valDataType = regMapIter->second->GetDataType();
+			ModbusDataType valDataType = regMapElement->GetDataType();
 			switch (valDataType)
 			{
 				case ModbusDataType::UnknownDataType:
 					throw 0;
 				break;
 				case ModbusDataType::OneBit:
-					if (!addDefMinMaxToJSON<uint8_t>(regMapIter->second, &jsonVal, &outputDoc)) { throw 0; };
+					if (!addDefMinMaxToJSON<uint8_t>(regMapElement, &jsonVal, &outputDoc)) { throw 0; };
 				break;
 				case ModbusDataType::UInt16:
 				case ModbusDataType::UInt16ToFloat:
-					if (!addDefMinMaxToJSON<uint16_t>(regMapIter->second, &jsonVal, &outputDoc)) { throw 0; };
+					if (!addDefMinMaxToJSON<uint16_t>(regMapElement, &jsonVal, &outputDoc)) { throw 0; };
 				break;
 				case ModbusDataType::SInt16:
 				case ModbusDataType::SInt16ToFloat:
-					if (!addDefMinMaxToJSON<int16_t>(regMapIter->second, &jsonVal, &outputDoc)) { throw 0; };
+					if (!addDefMinMaxToJSON<int16_t>(regMapElement, &jsonVal, &outputDoc)) { throw 0; };
 				break;
 				case ModbusDataType::UInt32:
 				case ModbusDataType::UInt32ToFloat:
-					if (!addDefMinMaxToJSON<uint32_t>(regMapIter->second, &jsonVal, &outputDoc)) { throw 0; };
+					if (!addDefMinMaxToJSON<uint32_t>(regMapElement, &jsonVal, &outputDoc)) { throw 0; };
 				break;
 				case ModbusDataType::SInt32:
 				case ModbusDataType::SInt32ToFloat:
-					if (!addDefMinMaxToJSON<int32_t>(regMapIter->second, &jsonVal, &outputDoc)) { throw 0; };
+					if (!addDefMinMaxToJSON<int32_t>(regMapElement, &jsonVal, &outputDoc)) { throw 0; };
 				break;
 				case ModbusDataType::Float32:
-					if (!addDefMinMaxToJSON<float>(regMapIter->second, &jsonVal, &outputDoc)) { throw 0; };
+					if (!addDefMinMaxToJSON<float>(regMapElement, &jsonVal, &outputDoc)) { throw 0; };
 				break;
 				case ModbusDataType::Char2Byte:
 				case ModbusDataType::Char4Byte:
 					string* modbusElStr;
-					if (!GetElementValue<string>(regMapIter->second, (const string**)&modbusElStr)) { throw 0; }
+					if (!GetElementValue<string>(regMapElement, (const string**)&modbusElStr)) { throw 0; }
 					else { jsonVal.AddMember(StringRef(ModbusElDefaultValueStr), StringRef(modbusElStr->c_str()), outputDoc.GetAllocator()); }
 				break;
 			}
@@ -553,12 +1049,12 @@ bool ModbusRegMap::SaveToFile(const string& sourceFilePath)
 			if (valDataType == ModbusDataType::UInt16ToFloat || valDataType == ModbusDataType::SInt16ToFloat ||
 				valDataType == ModbusDataType::UInt32ToFloat || valDataType == ModbusDataType::SInt32ToFloat)
 			{
-				jsonVal.AddMember(StringRef(ModbusElDecimalPointsStr), regMapIter->second->GetDecimalPoints(), outputDoc.GetAllocator());
+				jsonVal.AddMember(StringRef(ModbusElDecimalPointsStr), regMapElement->GetDecimalPoints(), outputDoc.GetAllocator());
 			}
 			//write [Modbus Register Unit]
-			if (regMapIter->second->GetRegisterUnit() != nullptr)
+			if (regMapElement->GetRegisterUnit() != nullptr)
 			{
-				jsonVal.AddMember(StringRef(ModbusElUnitStr), StringRef(regMapIter->second->GetRegisterUnit()), outputDoc.GetAllocator());
+				jsonVal.AddMember(StringRef(ModbusElUnitStr), StringRef(regMapElement->GetRegisterUnit()), outputDoc.GetAllocator());
 			}
 			else
 			{
@@ -681,13 +1177,13 @@ template <typename ModElType>
 bool ModbusRegMap::SetElementValue(uint8_t functionCode, uint16_t registerAddress, ModElType& value)
 {
 	//find modbus reg map element
-	map <int, ModbusElementBase*>::iterator elementIterator = getModbusElement(functionCode, registerAddress);
-	if (elementIterator == this->MainRegMap.end())
+	ModbusElementBase* modbusElementBase = getModbusElement(functionCode, registerAddress);
+	if (!modbusElementBase)
 	{
 		return false;
 	}
 	//try access to inherited class
-	ModbusElement <ModElType>* modbusElement = (ModbusElement <ModElType>*)elementIterator->second->GetModElObject();
+	ModbusElement <ModElType>* modbusElement = (ModbusElement <ModElType>*)modbusElementBase->GetModElObject();
 	if (!modbusElement)
 	{
 		return false;
@@ -698,7 +1194,10 @@ bool ModbusRegMap::SetElementValue(uint8_t functionCode, uint16_t registerAddres
 		return false;
 	}
 	//set new value
+	beginTableWrite(functionCode);
 	modbusElement->SetDataValue(value);
+	elementValueChanged(modbusElementBase);
+	endTableWrite(functionCode);
 	return true;
 }
 
@@ -717,7 +1216,10 @@ bool ModbusRegMap::SetElementValue(ModbusElementBase* modbusElementBase, ModElTy
 		return false;
 	}
 	//set new value
+	beginTableWrite(modbusElementBase->GetFunctionCode());
 	((ModbusElement <ModElType>*)modbusElementBase)->SetDataValue(value);
+	elementValueChanged(modbusElementBase);
+	endTableWrite(modbusElementBase->GetFunctionCode());
 	return true;
 }
 
@@ -731,49 +1233,58 @@ bool ModbusRegMap::SetElementValue(uint8_t functionCode, uint16_t registerAddres
 	}
 
 	//find modbus reg map element
-	map <int, ModbusElementBase*>::iterator elementIterator = getModbusElement(functionCode, registerAddress);
-	if (elementIterator == this->MainRegMap.end())
+	ModbusElementBase* modbusElementBase = getModbusElement(functionCode, registerAddress);
+	if (!modbusElementBase)
 	{
 		return false;
 	}
 
 	//parse element depending on type
-	switch (elementIterator->second->GetDataType())
+	bool setResult = false;
+	beginTableWrite(functionCode);
+	switch (modbusElementBase->GetDataType())
 	{
 	case ModbusDataType::UnknownDataType:
 		//no data type
 		break;
 	case ModbusDataType::OneBit:
-		return copyRAWDataToElement<uint8_t>(elementIterator->second, ModbusDataType::OneBit, buffer, bytesCount);
+		setResult = copyRAWDataToElement<uint8_t>(modbusElementBase, ModbusDataType::OneBit, buffer, bytesCount);
 		break;
 	case ModbusDataType::UInt16:
 	case ModbusDataType::UInt16ToFloat:
 	case ModbusDataType::FileRecord:
-		return copyRAWDataToElement<uint16_t>(elementIterator->second, ModbusDataType::UInt16, buffer, bytesCount);
+		setResult = copyRAWDataToElement<uint16_t>(modbusElementBase, ModbusDataType::UInt16, buffer, bytesCount);
 		break;
 	case ModbusDataType::SInt16:
 	case ModbusDataType::SInt16ToFloat:
-		return copyRAWDataToElement<int16_t>(elementIterator->second, ModbusDataType::SInt16, buffer, bytesCount);
+		setResult = copyRAWDataToElement<int16_t>(modbusElementBase, ModbusDataType::SInt16, buffer, bytesCount);
 		break;
 	case ModbusDataType::UInt32:
 	case ModbusDataType::UInt32ToFloat:
-		return copyRAWDataToElement<uint32_t>(elementIterator->second, ModbusDataType::UInt32, buffer, bytesCount);
+		setResult = copyRAWDataToElement<uint32_t>(modbusElementBase, ModbusDataType::UInt32, buffer, bytesCount);
 		break;
 	case ModbusDataType::SInt32:
 	case ModbusDataType::SInt32ToFloat:
-		return copyRAWDataToElement<int32_t>(elementIterator->second, ModbusDataType::SInt32, buffer, bytesCount);
+		setResult = copyRAWDataToElement<int32_t>(modbusElementBase, ModbusDataType::SInt32, buffer, bytesCount);
 		break;
 	case ModbusDataType::Float32:
-		return copyRAWDataToElement<float>(elementIterator->second, ModbusDataType::Float32, buffer, bytesCount);
+		setResult = copyRAWDataToElement<float>(modbusElementBase, ModbusDataType::Float32, buffer, bytesCount);
 		break;
 	case ModbusDataType::Char2Byte:
-		return copyRAWDataToElement<string>(elementIterator->second, ModbusDataType::Char2Byte, buffer, bytesCount);
+		setResult = copyRAWDataToElement<string>(modbusElementBase, ModbusDataType::Char2Byte, buffer, bytesCount);
 		break;
 	case ModbusDataType::Char4Byte:
-		return copyRAWDataToElement<string>(elementIterator->second, ModbusDataType::Char4Byte, buffer, bytesCount);
+		setResult = copyRAWDataToElement<string>(modbusElementBase, ModbusDataType::Char4Byte, buffer, bytesCount);
+		break;
+	default:
 		break;
 	}
-	return false;
+	if (setResult)
+	{
+		elementValueChanged(modbusElementBase);
+	}
+	endTableWrite(functionCode);
+	return setResult;
 }
 
 //overload #1 - Get
@@ -786,17 +1297,25 @@ bool ModbusRegMap::GetElementValue(uint8_t functionCode, uint16_t registerAddres
 		return false;
 	}
 	//find modbus reg map element
-	map <int, ModbusElementBase*>::iterator elementIterator = getModbusElement(functionCode, registerAddress);
-	if (elementIterator == this->MainRegMap.end())
+	ModbusElementBase* modbusElementBase = getModbusElement(functionCode, registerAddress);
+	if (!modbusElementBase)
 	{
 		return false;
 	}
 	//try access to inherited class
-	ModbusElement <ModElType>* modbusElement = (ModbusElement <ModElType>*)elementIterator->second->GetModElObject();
+	ModbusElement <ModElType>* modbusElement = (ModbusElement <ModElType>*)modbusElementBase->GetModElObject();
 	if (!modbusElement)
 	{
 		return false;
 	}
+	//one bit element value is stored packed, value of element is its copy - copy is updated by one thread at a time
+	if (modbusElementBase->GetDataType() == ModbusDataType::OneBit)
+	{
+		lockWriters();
+		uint8_t bitValue = loadBitElement(modbusElementBase);
+		((ModbusElement <uint8_t>*)modbusElementBase)->SetDataValue(bitValue);
+		unlockWriters();
+	}
 	//get data value
 	*value = &(modbusElement->GetDataValue());
 	return true;
@@ -815,6 +1334,14 @@ bool ModbusRegMap::GetElementValue(ModbusElementBase* modbusElementBase, const M
 	{
 		return false;
 	}
+	//one bit element value is stored packed, value of element is its copy - copy is updated by one thread at a time
+	if (modbusElementBase->GetDataType() == ModbusDataType::OneBit)
+	{
+		lockWriters();
+		uint8_t bitValue = loadBitElement(modbusElementBase);
+		((ModbusElement <uint8_t>*)modbusElementBase)->SetDataValue(bitValue);
+		unlockWriters();
+	}
 	//get data value
 	*value = &(((ModbusElement <ModElType>*)modbusElementBase)->GetDataValue());
 	return true;
@@ -829,48 +1356,493 @@ bool ModbusRegMap::GetElementValue(uint8_t functionCode, uint16_t registerAddres
 	}
 
 	//find modbus reg map element
-	map <int, ModbusElementBase*>::iterator elementIterator = getModbusElement(functionCode, registerAddress);
-	if (elementIterator == this->MainRegMap.end())
+	ModbusElementBase* modbusElementBase = getModbusElement(functionCode, registerAddress);
+	if (!modbusElementBase)
 	{
 		return false;
 	}
 
 	//parse element depending on type
-	switch (elementIterator->second->GetDataType())
+	switch (modbusElementBase->GetDataType())
 	{
 		case ModbusDataType::UnknownDataType:
 			//no data type
 		break;
 		case ModbusDataType::OneBit:
-			return copyElementToRAWData<uint8_t>(elementIterator->second, ModbusDataType::OneBit, buffer, bufferLength, bytesCount);
+		{
+			//value from packed values, read again if table is changed by other thread during reading
+			uint8_t bitValue;
+			uint32_t tableVersion;
+			do
+			{
+				tableVersion = beginTableRead(functionCode);
+				bitValue = loadBitElement(modbusElementBase);
+			} while (!endTableRead(functionCode, tableVersion));
+			buffer[0] = bitValue;
+			*bytesCount = 1;
+			return true;
+		}
 		break;
 		case ModbusDataType::UInt16:
 		case ModbusDataType::UInt16ToFloat:
 		case ModbusDataType::FileRecord:
-			return copyElementToRAWData<uint16_t>(elementIterator->second, ModbusDataType::UInt16, buffer, bufferLength, bytesCount);
+			return copyElementToRAWData<uint16_t>(modbusElementBase, ModbusDataType::UInt16, buffer, bufferLength, bytesCount);
 		break;
 		case ModbusDataType::SInt16:
 		case ModbusDataType::SInt16ToFloat:
-			return copyElementToRAWData<int16_t>(elementIterator->second, ModbusDataType::SInt16, buffer, bufferLength, bytesCount);
+			return copyElementToRAWData<int16_t>(modbusElementBase, ModbusDataType::SInt16, buffer, bufferLength, bytesCount);
 		break;
 		case ModbusDataType::UInt32:
 		case ModbusDataType::UInt32ToFloat:
-			return copyElementToRAWData<uint32_t>(elementIterator->second, ModbusDataType::UInt32, buffer, bufferLength, bytesCount);
+			return copyElementToRAWData<uint32_t>(modbusElementBase, ModbusDataType::UInt32, buffer, bufferLength, bytesCount);
 		break;
 		case ModbusDataType::SInt32:
 		case ModbusDataType::SInt32ToFloat:
-			return copyElementToRAWData<int32_t>(elementIterator->second, ModbusDataType::SInt32, buffer, bufferLength, bytesCount);
+			return copyElementToRAWData<int32_t>(modbusElementBase, ModbusDataType::SInt32, buffer, bufferLength, bytesCount);
 		break;
 		case ModbusDataType::Float32:
-			return copyElementToRAWData<float>(elementIterator->second, ModbusDataType::Float32, buffer, bufferLength, bytesCount);
+			return copyElementToRAWData<float>(modbusElementBase, ModbusDataType::Float32, buffer, bufferLength, bytesCount);
 		break;
 		case ModbusDataType::Char2Byte:
-			return copyElementToRAWData<string>(elementIterator->second, ModbusDataType::Char2Byte, buffer, bufferLength, bytesCount);
+			return copyElementToRAWData<string>(modbusElementBase, ModbusDataType::Char2Byte, buffer, bufferLength, bytesCount);
 		break;
 		case ModbusDataType::Char4Byte:
-			return copyElementToRAWData<string>(elementIterator->second, ModbusDataType::Char4Byte, buffer, bufferLength, bytesCount);
+			return copyElementToRAWData<string>(modbusElementBase, ModbusDataType::Char4Byte, buffer, bufferLength, bytesCount);
 		break;
 	}
 	return false;
 }
 /*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+//helper function for copy element data to buffer in modbus wire format
+template <typename ModElType>
+void ModbusRegMap::copyElementToWireData(ModbusElementBase* modElBase, uint8_t* buffer, uint16_t wireBytesCount)
+{
+	//value bytes in reverse order (big-endian), bytes of registers not used by value are zero
+	const ModElType& elValue = ((ModbusElement <ModElType>*)modElBase)->GetDataValue();
+	const uint8_t* valueBytes = (const uint8_t*)&elValue;
+	for (uint16_t i = 0; i < wireBytesCount; i++)
+	{
+		uint16_t valueByteIndex = wireBytesCount - 1 - i;
+		buffer[i] = (valueByteIndex < sizeof(ModElType)) ? valueBytes[valueByteIndex] : 0;
+	}
+}
+
+//special algorithm for string data types
+template <>
+void ModbusRegMap::copyElementToWireData<string>(ModbusElementBase* modElBase, uint8_t* buffer, uint16_t wireBytesCount)
+{
+	//chars in reverse order as for RAW data access, absent chars are zero
+	const string& elValue = ((ModbusElement <string>*)modElBase)->GetDataValue();
+	for (uint16_t i = 0; i < wireBytesCount; i++)
+	{
+		uint16_t charIndex = wireBytesCount - 1 - i;
+		buffer[i] = (charIndex < elValue.size()) ? (uint8_t)elValue[charIndex] : 0;
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+//helper function for check and copy buffer data in modbus wire format to element
+template <typename ModElType>
+bool ModbusRegMap::copyWireDataToElement(ModbusElementBase* modElBase, const uint8_t* buffer, uint16_t wireBytesCount, bool checkOnly)
+{
+	ModbusElement <ModElType>* modbusElement = (ModbusElement <ModElType>*)modElBase;
+	//collect value from bytes in reverse order, bytes of registers not used by value must be zero
+	ModElType elVar;
+	uint8_t* valueBytes = (uint8_t*)&elVar;
+	for (uint16_t i = 0; i < wireBytesCount; i++)
+	{
+		uint16_t valueByteIndex = wireBytesCount - 1 - i;
+		if (valueByteIndex < sizeof(ModElType))
+		{
+			valueBytes[valueByteIndex] = buffer[i];
+		}
+		else if (buffer[i])
+		{
+			return false;
+		}
+	}
+	//check min/max values
+	if (!checkMinDefMax<ModElType>(elVar, modbusElement->GetMinDataValue(), modbusElement->GetMaxDataValue()))
+	{
+		return false;
+	}
+	//set new value
+	if (!checkOnly)
+	{
+		modbusElement->SetDataValue(elVar);
+	}
+	return true;
+}
+
+//special algorithm for string data types
+template <>
+bool ModbusRegMap::copyWireDataToElement<string>(ModbusElementBase* modElBase, const uint8_t* buffer, uint16_t wireBytesCount, bool checkOnly)
+{
+	//any chars accepted, nothing to check
+	if (checkOnly)
+	{
+		return true;
+	}
+	//chars in reverse order as for RAW data access, string ends on first zero char
+	char elChars[4];
+	uint16_t charsCount = 0;
+	for (uint16_t i = 0; i < wireBytesCount && i < sizeof(elChars); i++)
+	{
+		elChars[i] = (char)buffer[wireBytesCount - 1 - i];
+	}
+	while (charsCount < wireBytesCount && charsCount < sizeof(elChars) && elChars[charsCount])
+	{
+		charsCount++;
+	}
+	string elValue(elChars, charsCount);
+	((ModbusElement <string>*)modElBase)->SetDataValue(elValue);
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+//helper function for copy element data to buffer in modbus wire format depending on element data type
+bool ModbusRegMap::elementToWireData(ModbusElementBase* modElBase, uint8_t* buffer)
+{
+	uint16_t wireBytesCount = ModbusDataTypeRegistersCount(modElBase->GetDataType()) * 2;
+	switch (modElBase->GetDataType())
+	{
+		case ModbusDataType::OneBit:
+			//value from packed values, one register
+			buffer[0] = 0;
+			buffer[1] = loadBitElement(modElBase);
+			return true;
+		case ModbusDataType::UInt16:
+		case ModbusDataType::UInt16ToFloat:
+		case ModbusDataType::FileRecord:
+			copyElementToWireData<uint16_t>(modElBase, buffer, wireBytesCount);
+			return true;
+		case ModbusDataType::SInt16:
+		case ModbusDataType::SInt16ToFloat:
+			copyElementToWireData<int16_t>(modElBase, buffer, wireBytesCount);
+			return true;
+		case ModbusDataType::UInt32:
+		case ModbusDataType::UInt32ToFloat:
+			copyElementToWireData<uint32_t>(modElBase, buffer, wireBytesCount);
+			return true;
+		case ModbusDataType::SInt32:
+		case ModbusDataType::SInt32ToFloat:
+			copyElementToWireData<int32_t>(modElBase, buffer, wireBytesCount);
+			return true;
+		case ModbusDataType::Float32:
+			copyElementToWireData<float>(modElBase, buffer, wireBytesCount);
+			return true;
+		case ModbusDataType::Char2Byte:
+		case ModbusDataType::Char4Byte:
+			copyElementToWireData<string>(modElBase, buffer, wireBytesCount);
+			return true;
+		default:
+			//no data type
+			break;
+	}
+	return false;
+}
+
+//helper function for check and copy buffer data in modbus wire format to element depending on element data type
+bool ModbusRegMap::wireDataToElement(ModbusElementBase* modElBase, const uint8_t* buffer, bool checkOnly)
+{
+	uint16_t wireBytesCount = ModbusDataTypeRegistersCount(modElBase->GetDataType()) * 2;
+	switch (modElBase->GetDataType())
+	{
+		case ModbusDataType::OneBit:
+			return copyWireDataToElement<uint8_t>(modElBase, buffer, wireBytesCount, checkOnly);
+		case ModbusDataType::UInt16:
+		case ModbusDataType::UInt16ToFloat:
+		case ModbusDataType::FileRecord:
+			return copyWireDataToElement<uint16_t>(modElBase, buffer, wireBytesCount, checkOnly);
+		case ModbusDataType::SInt16:
+		case ModbusDataType::SInt16ToFloat:
+			return copyWireDataToElement<int16_t>(modElBase, buffer, wireBytesCount, checkOnly);
+		case ModbusDataType::UInt32:
+		case ModbusDataType::UInt32ToFloat:
+			return copyWireDataToElement<uint32_t>(modElBase, buffer, wireBytesCount, checkOnly);
+		case ModbusDataType::SInt32:
+		case ModbusDataType::SInt32ToFloat:
+			return copyWireDataToElement<int32_t>(modElBase, buffer, wireBytesCount, checkOnly);
+		case ModbusDataType::Float32:
+			return copyWireDataToElement<float>(modElBase, buffer, wireBytesCount, checkOnly);
+		case ModbusDataType::Char2Byte:
+		case ModbusDataType::Char4Byte:
+			return copyWireDataToElement<string>(modElBase, buffer, wireBytesCount, checkOnly);
+		default:
+			//no data type
+			break;
+	}
+	return false;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* read range of registers to buffer in modbus wire format */
+//element of 32-bit data type occupies two registers, range must contain whole elements only
+bool ModbusRegMap::GetElementsRange(uint8_t functionCode, uint16_t startAddress, uint16_t registersCount, uint8_t* buffer, size_t bufferLength, size_t* bytesCount)
+{
+	//check input data
+	if (!buffer || !bytesCount || !registersCount || bufferLength < (size_t)registersCount * 2 ||
+		(uint32_t)startAddress + registersCount > 0x10000)
+	{
+		return false;
+	}
+
+	//resolve table of function code once
+	ModbusRegTable* regTable = this->RegTables[functionCode];
+	if (!regTable)
+	{
+		return false;
+	}
+
+	//wire format image of table is created on first range read, without image registers are read element by element
+	//values are not changed during creation of image
+	if (!regTable->wire.load(std::memory_order_acquire))
+	{
+		lockWriters();
+		if (!regTable->wire.load(std::memory_order_relaxed))
+		{
+			createWireImage(regTable);
+		}
+		unlockWriters();
+	}
+
+	//read again if table is changed by other thread during reading
+	bool readResult;
+	uint32_t tableVersion;
+	do
+	{
+		tableVersion = beginTableRead(functionCode);
+		readResult = readElementsRange(regTable, startAddress, registersCount, buffer, bytesCount);
+	} while (!endTableRead(functionCode, tableVersion));
+	return readResult;
+}
+
+/* read range of registers of table to buffer, buffer and range are checked by caller */
+bool ModbusRegMap::readElementsRange(ModbusRegTable* regTable, uint16_t startAddress, uint16_t registersCount, uint8_t* buffer, size_t* bytesCount)
+{
+	//fast way - all registers of range are in image and range doesn't cut two registers element
+	uint32_t endAddress = (uint32_t)startAddress + registersCount;
+	ModbusWireImage* wireImage = regTable->wire.load(std::memory_order_acquire);
+	if (wireImage && !wireImage->overlapped &&
+		!getBitsWord(wireImage->continued, BitWordsCount, startAddress, 1) &&
+		(endAddress == 0x10000 || !getBitsWord(wireImage->continued, BitWordsCount, endAddress, 1)) &&
+		checkBitsSet(wireImage->covered, BitWordsCount, startAddress, registersCount))
+	{
+		memcpy(buffer, &wireImage->data[startAddress * 2], (size_t)registersCount * 2);
+		*bytesCount = (size_t)registersCount * 2;
+		return true;
+	}
+
+	//stream registers page by page
+	uint32_t pageIndex = RegPagesCount;
+	ModbusRegPage* regPage = nullptr;
+	uint8_t* bufferPos = buffer;
+	for (uint32_t address = startAddress; address < endAddress; )
+	{
+		//change page on page boundary only
+		if (address / RegPageSize != pageIndex)
+		{
+			pageIndex = address / RegPageSize;
+			regPage = regTable->pages[pageIndex];
+			if (!regPage)
+			{
+				return false;
+			}
+		}
+		//element of register
+		ModbusElementBase* modElBase = regPage->elements[address % RegPageSize];
+		if (!modElBase)
+		{
+			return false;
+		}
+		uint16_t elRegistersCount = ModbusDataTypeRegistersCount(modElBase->GetDataType());
+		if (!elRegistersCount || address + elRegistersCount > endAddress)
+		{
+			return false;
+		}
+		//copy value
+		if (!elementToWireData(modElBase, bufferPos))
+		{
+			return false;
+		}
+		bufferPos += elRegistersCount * 2;
+		address += elRegistersCount;
+	}
+
+	*bytesCount = (size_t)(bufferPos - buffer);
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* validate and write range of registers from buffer in modbus wire format */
+bool ModbusRegMap::SetElementsRange(uint8_t functionCode, uint16_t startAddress, uint16_t registersCount, const uint8_t* buffer, size_t bytesCount,
+	bool skipMissing)
+{
+	//check input data
+	if (!buffer || !registersCount || bytesCount != (size_t)registersCount * 2 ||
+		(uint32_t)startAddress + registersCount > 0x10000)
+	{
+		return false;
+	}
+
+	//resolve table of function code once
+	ModbusRegTable* regTable = this->RegTables[functionCode];
+	if (!regTable)
+	{
+		return false;
+	}
+
+	//first pass - validate all registers of range, second pass - write values
+	uint32_t endAddress = (uint32_t)startAddress + registersCount;
+	tableWriteSection writeSection(this, functionCode);
+	for (int pass = 0; pass < 2; pass++)
+	{
+		uint32_t pageIndex = RegPagesCount;
+		ModbusRegPage* regPage = nullptr;
+		const uint8_t* bufferPos = buffer;
+		for (uint32_t address = startAddress; address < endAddress; )
+		{
+			//change page on page boundary only
+			if (address / RegPageSize != pageIndex)
+			{
+				pageIndex = address / RegPageSize;
+				regPage = regTable->pages[pageIndex];
+			}
+			//element of register
+			ModbusElementBase* modElBase = regPage ? regPage->elements[address % RegPageSize] : nullptr;
+			if (!modElBase)
+			{
+				if (!skipMissing)
+				{
+					return false;
+				}
+				bufferPos += 2;
+				address++;
+				continue;
+			}
+			uint16_t elRegistersCount = ModbusDataTypeRegistersCount(modElBase->GetDataType());
+			if (!elRegistersCount || address + elRegistersCount > endAddress)
+			{
+				return false;
+			}
+			//check or set value
+			if (!wireDataToElement(modElBase, bufferPos, pass == 0))
+			{
+				return false;
+			}
+			if (pass)
+			{
+				elementValueChanged(modElBase);
+			}
+			bufferPos += elRegistersCount * 2;
+			address += elRegistersCount;
+		}
+	}
+
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* read range of one bit elements to packed buffer */
+bool ModbusRegMap::GetBitsRange(uint8_t functionCode, uint16_t startAddress, uint16_t bitsCount, uint8_t* buffer, size_t bufferLength)
+{
+	//check input data
+	if (!buffer || !bitsCount || bufferLength < ((size_t)bitsCount + 7) / 8 ||
+		(uint32_t)startAddress + bitsCount > 0x10000)
+	{
+		return false;
+	}
+
+	//resolve packed values of function code once
+	ModbusRegTable* regTable = this->RegTables[functionCode];
+	if (!regTable || !regTable->bits)
+	{
+		return false;
+	}
+
+	//all bits of range must exist
+	if (!checkBitsSet(regTable->bits->present, BitWordsCount, startAddress, bitsCount))
+	{
+		return false;
+	}
+
+	//copy bits, again if table is changed by other thread during reading
+	uint32_t tableVersion;
+	do
+	{
+		tableVersion = beginTableRead(functionCode);
+		extractBits(regTable->bits->values, BitWordsCount, startAddress, bitsCount, buffer);
+	} while (!endTableRead(functionCode, tableVersion));
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* validate and write range of one bit elements from packed buffer */
+bool ModbusRegMap::SetBitsRange(uint8_t functionCode, uint16_t startAddress, uint16_t bitsCount, const uint8_t* buffer, size_t bufferLength,
+	bool skipMissing)
+{
+	//check input data
+	if (!buffer || !bitsCount || bufferLength < ((size_t)bitsCount + 7) / 8 ||
+		(uint32_t)startAddress + bitsCount > 0x10000)
+	{
+		return false;
+	}
+
+	//resolve packed values of function code once
+	ModbusRegTable* regTable = this->RegTables[functionCode];
+	if (!regTable || !regTable->bits)
+	{
+		return false;
+	}
+	ModbusBitTable* bitTable = regTable->bits;
+
+	//check all bits exist and new values inside min/max of elements, word at a time; values of missing bits aren't used
+	for (uint32_t bitIndex = 0; bitIndex < bitsCount; bitIndex += 64)
+	{
+		uint32_t chunkBitsCount = (bitsCount - bitIndex < 64) ? bitsCount - bitIndex : 64;
+		uint64_t bitsMask = (chunkBitsCount < 64) ? ((uint64_t)1 << chunkBitsCount) - 1 : ~(uint64_t)0;
+		uint64_t newBits = loadBitsWord(buffer, bitIndex, chunkBitsCount);
+		uint64_t presentBits = getBitsWord(bitTable->present, BitWordsCount, startAddress + bitIndex, chunkBitsCount);
+		if ((!skipMissing && presentBits != bitsMask) ||
+			(newBits & presentBits & ~getBitsWord(bitTable->allowOne, BitWordsCount, startAddress + bitIndex, chunkBitsCount)) ||
+			(~newBits & presentBits & ~getBitsWord(bitTable->allowZero, BitWordsCount, startAddress + bitIndex, chunkBitsCount)))
+		{
+			return false;
+		}
+	}
+
+	//write bits
+	beginTableWrite(functionCode);
+	depositBits(bitTable->values, BitWordsCount, startAddress, bitsCount, buffer);
+	endTableWrite(functionCode);
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* template functions of register map for all types of element values - for use from other translation units */
+#define MODBUS_REG_MAP_INSTANTIATE(ModElType) \
+	template bool ModbusRegMap::AddNewElement<ModElType>(uint8_t, uint16_t, ModbusDataType, uint16_t, const char*, uint8_t, \
+		ModElType&, ModElType&, ModElType&, const char*); \
+	template bool ModbusRegMap::SetElementValue<ModElType>(uint8_t, uint16_t, ModElType&); \
+	template bool ModbusRegMap::SetElementValue<ModElType>(ModbusElementBase*, ModElType&); \
+	template bool ModbusRegMap::GetElementValue<ModElType>(uint8_t, uint16_t, const ModElType**); \
+	template bool ModbusRegMap::GetElementValue<ModElType>(ModbusElementBase*, const ModElType**);
+
+MODBUS_REG_MAP_INSTANTIATE(uint8_t)
+MODBUS_REG_MAP_INSTANTIATE(uint16_t)
+MODBUS_REG_MAP_INSTANTIATE(int16_t)
+MODBUS_REG_MAP_INSTANTIATE(uint32_t)
+MODBUS_REG_MAP_INSTANTIATE(int32_t)
+MODBUS_REG_MAP_INSTANTIATE(float)
+MODBUS_REG_MAP_INSTANTIATE(string)
+#undef MODBUS_REG_MAP_INSTANTIATE
+/*-----------------------------------------------------------------------------------------------------------------------------*/
@@ -9,15 +9,18 @@
 #define MODBUS_REGISTER_MAP
 
 #include <stdint.h>
-#include <map>
+#include <string.h>
 #include <string>
+#include <vector>
+#include <new>
+#include <atomic>
 #include "rapidjson/document.h"
 #include "rapidjson/istreamwrapper.h"
 #include "rapidjson/prettywriter.h"
 #include "rapidjson/filewritestream.h"
 
 using std::string;
-using std::map;
+using std::vector;
 
 /* modbus data types enumeration */
 //OneBit - discrete input/coil
@@ -43,6 +46,62 @@ enum ModbusDataType
 	LastDataType = FileRecord
 };
 
+/* count of 16-bit modbus registers occupied by element of data type */
+inline uint16_t ModbusDataTypeRegistersCount(ModbusDataType dataType)
+{
+	switch (dataType)
+	{
+		case ModbusDataType::UInt32:
+		case ModbusDataType::SInt32:
+		case ModbusDataType::Float32:
+		case ModbusDataType::Char4Byte:
+		case ModbusDataType::UInt32ToFloat:
+		case ModbusDataType::SInt32ToFloat:
+			return 2;
+		case ModbusDataType::UnknownDataType:
+			return 0;
+		default:
+			return 1;
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------------- */
+/* arena for modbus elements and their c-strings: memory is taken from few big blocks and released at once */
+class ModbusRegArena
+{
+	public:
+		/* constructor */
+		ModbusRegArena(size_t blockSize = 0x10000)
+			: BlockSize(blockSize)
+		{
+		}
+
+		/* destructor */
+		~ModbusRegArena()
+		{
+			this->Release();
+		}
+
+		/* get memory for object, nullptr if fail */
+		void* Allocate(size_t size, size_t alignment);
+
+		/* create copy of c-string in arena memory, nullptr if fail */
+		char* CopyString(const char* str);
+
+		/* release all blocks */
+		void Release();
+
+	private:
+		//size of one memory block
+		size_t BlockSize;
+		//allocated blocks
+		vector <char*> Blocks;
+		//free space in current block
+		char* currentBlockPos = nullptr;
+		char* currentBlockEnd = nullptr;
+};
+/* ---------------------------------------------------------------------------------------------------------------------------- */
+
 /* ---------------------------------------------------------------------------------------------------------------------------- */
 /* base modbus element class */
 class ModbusElementBase
@@ -55,34 +114,51 @@ class ModbusElementBase
 							uint16_t& bytesCount,
 							ModbusDataType& dataType,
 							uint8_t& decimalPoints,
-							const char* registerUnit)
-			: FunctionCode(functionCode), RegisterAddress(registerAddress), BytesCount(bytesCount), DataType(dataType), DecimalPoints(decimalPoints)
+							const char* registerUnit,
+							ModbusRegArena* stringsArena = nullptr)
+			: FunctionCode(functionCode), RegisterAddress(registerAddress), BytesCount(bytesCount), DataType(dataType), DecimalPoints(decimalPoints),
+			StringsInArena(stringsArena != nullptr)
 		{
+			//c-strings in arena, if arena exist
+			if (stringsArena)
+			{
+				if ((registerName && *registerName && !(this->RegisterName = stringsArena->CopyString(registerName))) ||
+					(registerUnit && *registerUnit && !(this->RegisterUnit = stringsArena->CopyString(registerUnit))))
+				{
+					throw std::bad_alloc();
+				}
+				return;
+			}
 			//create and copy c-strings, if exist
 			size_t strSize;
 			if (registerName && (strSize = strlen(registerName)) )
 			{
 				this->RegisterName = new char[strSize + 1]();
-				strcpy_s(this->RegisterName, strSize + 1, registerName);
+				memcpy(this->RegisterName, registerName, strSize + 1);
 			}
 			if (registerUnit && (strSize = strlen(registerUnit)) )
 			{
 				this->RegisterUnit = new char[strSize + 1]();
-				strcpy_s(this->RegisterUnit, strSize + 1, registerUnit);
+				memcpy(this->RegisterUnit, registerUnit, strSize + 1);
 			}
 		}
 
 		/* destructor */
 		virtual ~ModbusElementBase()
 		{
+			//c-strings in arena are released with arena
+			if (this->StringsInArena)
+			{
+				return;
+			}
 			//delete c-strings, if exist
 			if (this->RegisterName)
 			{
-				delete this->RegisterName;
+				delete[] this->RegisterName;
 			}
 			if (this->RegisterUnit)
 			{
-				delete this->RegisterUnit;
+				delete[] this->RegisterUnit;
 			}
 		}
 
@@ -162,6 +238,7 @@ class ModbusElementBase
 		ModbusDataType DataType;
 		uint8_t DecimalPoints;
 		char* RegisterUnit = nullptr;
+		bool StringsInArena;
 };
 /* ---------------------------------------------------------------------------------------------------------------------------- */
 
@@ -181,8 +258,9 @@ class ModbusElement : public ModbusElementBase
 						ModElType& dataValue,
 						ModElType& minDataValue,
 						ModElType& maxDataValue,
-						const char* registerUnit)
-			: ModbusElementBase(registerName, functionCode, registerAddress, bytesCount, dataType, decimalPoints, registerUnit),
+						const char* registerUnit,
+						ModbusRegArena* stringsArena = nullptr)
+			: ModbusElementBase(registerName, functionCode, registerAddress, bytesCount, dataType, decimalPoints, registerUnit, stringsArena),
 			DataValue(dataValue),
 			MinDataValue(minDataValue),
 			MaxDataValue(maxDataValue)
@@ -256,6 +334,12 @@ class ModbusRegMap
 			uint8_t decimalPoints, ModElType& value, ModElType& minDataValue, ModElType& maxDataValue, const char* registerUnit);
 		/* util - get elements count */
 		size_t ElementsCount();
+		/* enable or disable arena allocation of elements, can be changed for empty register map only */
+		bool SetArenaAllocation(bool enable);
+		bool GetArenaAllocation() const
+		{
+			return this->UseArena;
+		}
 		/* element exists check */
 		bool ModbusElementExist(uint8_t functionCode, uint16_t registerAddress);
 		/* get type of element */
@@ -277,6 +361,23 @@ class ModbusRegMap
 		bool GetElementValue(ModbusElementBase* modbusElementBase, const ModElType** value);
 			//overload #3 - Get RAW value
 		bool GetElementValue(uint8_t functionCode, uint16_t registerAddress, uint8_t* buffer, uint8_t bufferLength, uint16_t* bytesCount);
+		/* read range of registers to buffer in modbus wire format (big-endian, 2 bytes per register) */
+		bool GetElementsRange(uint8_t functionCode, uint16_t startAddress, uint16_t registersCount, uint8_t* buffer, size_t bufferLength, size_t* bytesCount);
+		/* validate and write range of registers from buffer in modbus wire format, nothing is written if any register not valid */
+		//skip missing - registers without elements in range are skipped (answers for blocks with holes), else range is not valid
+		bool SetElementsRange(uint8_t functionCode, uint16_t startAddress, uint16_t registersCount, const uint8_t* buffer, size_t bytesCount,
+			bool skipMissing = false);
+		/* read range of one bit elements (coils, discrete inputs) to buffer packed as in modbus - first bit in LSB of first byte */
+		bool GetBitsRange(uint8_t functionCode, uint16_t startAddress, uint16_t bitsCount, uint8_t* buffer, size_t bufferLength);
+		/* validate and write range of one bit elements from packed buffer, nothing is written if any bit not valid */
+		//skip missing - bits without elements in range are skipped, else range is not valid
+		bool SetBitsRange(uint8_t functionCode, uint16_t startAddress, uint16_t bitsCount, const uint8_t* buffer, size_t bufferLength,
+			bool skipMissing = false);
+		/* get version of function code table - changed on any change of table elements or values, for check of cached data */
+		uint32_t GetTableVersion(uint8_t functionCode) const
+		{
+			return this->TableVersions[functionCode].load(std::memory_order_acquire);
+		}
 		/* load register map from JSON file format */
 		bool LoadFromFile(const string& sourceFilePath);
 		/* save register map to JSON file format */
@@ -307,35 +408,73 @@ class ModbusRegMap
 		/* get first register map element */
 		ModbusElementBase* GetFirstElement()
 		{
-			currentElementIter = MainRegMap.begin();
-			if (currentElementIter != MainRegMap.end())
-			{
-				return currentElementIter->second;
-			}
-			else
-			{
-				return nullptr;
-			}
+			return findNextElement(0, &currentElementKey);
 		}
 		/* get next register map element */
 		ModbusElementBase* GetNextElement()
 		{
-			if (currentElementIter == MainRegMap.end()) return nullptr;
-			if (++currentElementIter != MainRegMap.end())
-			{
-				return currentElementIter->second;
-			}
-			else
-			{
-				return nullptr;
-			}
+			if (currentElementKey >= RegKeysCount) return nullptr;
+			return findNextElement(currentElementKey + 1, &currentElementKey);
 		}
 
 	private:
-		//container with modbus map elements
-		map <int, ModbusElementBase*> MainRegMap;
-		//iterator for getting elements function
-		map <int, ModbusElementBase*>::iterator currentElementIter = MainRegMap.begin();
+		//register map storage geometry: table for each function code, table consists of pages with adjacent addresses
+		static const uint32_t RegTablesCount = 256;
+		static const uint32_t RegPageSize = 256;
+		static const uint32_t RegPagesCount = 0x10000 / RegPageSize;
+		static const uint32_t RegKeysCount = RegTablesCount << 16;
+		static const uint32_t BitWordsCount = 0x10000 / 64;
+
+		/* one page of register map table - direct indexed by low byte of register address */
+		struct ModbusRegPage
+		{
+			ModbusElementBase* elements[RegPageSize];
+		};
+		/* packed values of one bit elements of one function code - bit number = register address */
+		struct ModbusBitTable
+		{
+			uint64_t values[BitWordsCount];
+			//element exists
+			uint64_t present[BitWordsCount];
+			//value 0 or 1 is inside element min/max range
+			uint64_t allowZero[BitWordsCount];
+			uint64_t allowOne[BitWordsCount];
+		};
+		/* values of registers of one function code in modbus wire format (big-endian), ready for range read by memcpy */
+		struct ModbusWireImage
+		{
+			uint8_t data[0x10000 * 2];
+			//register is occupied by element stored in image
+			uint64_t covered[BitWordsCount];
+			//register is second register of two registers element
+			uint64_t continued[BitWordsCount];
+			//elements of table overlap each other - image is not used
+			bool overlapped;
+		};
+		/* register map table for one function code - direct indexed by high byte of register address */
+		struct ModbusRegTable
+		{
+			ModbusRegPage* pages[RegPagesCount];
+			size_t elementsCount;
+			//values of one bit elements, created on first one bit element adding
+			ModbusBitTable* bits;
+			//wire format image of registers, created on first range read - published to range readers without lock
+			std::atomic <ModbusWireImage*> wire;
+		};
+
+		//container with modbus map elements, tables and pages are created on first element adding
+		ModbusRegTable* RegTables[RegTablesCount] = {};
+		//count of elements in all tables
+		size_t RegElementsCount = 0;
+		//versions of tables, not reset by clear of register map; version is odd during table change
+		std::atomic <uint32_t> TableVersions[RegTablesCount] = {};
+		//lock of writers - values of elements are changed by one thread at a time
+		std::atomic_flag WriteLock = ATOMIC_FLAG_INIT;
+		//key (function code << 16 | address) of current element for getting elements function
+		uint32_t currentElementKey = RegKeysCount;
+		//arena allocation mode - elements and their c-strings in arena blocks
+		bool UseArena = false;
+		ModbusRegArena ElementsArena;
 		//modbus protocol name
 		string ProtocolName = "";
 		//modbus protocol version
@@ -361,7 +500,51 @@ class ModbusRegMap
 		const char* ModbusElUnitStr = "Unit";
 
 		/* get modbus element function */
-		map <int, ModbusElementBase*>::iterator getModbusElement(uint8_t functionCode, uint16_t registerAddress);
+		ModbusElementBase* getModbusElement(uint8_t functionCode, uint16_t registerAddress);
+		/* get or create cell of register map for new element */
+		ModbusElementBase** createModbusElementCell(uint8_t functionCode, uint16_t registerAddress);
+		/* find first existing element with key (function code << 16 | address) not less than startKey */
+		ModbusElementBase* findNextElement(uint32_t startKey, uint32_t* foundKey);
+		/* add one bit element to packed values of table */
+		bool addBitElement(ModbusElementBase* modElBase);
+		/* update data depending on element value after value change */
+		void elementValueChanged(ModbusElementBase* modElBase);
+		/* concurrent access: writers change table in write section, range readers repeat reading if table changed during reading */
+		//values of elements can be changed and read by several threads (slaves of several connections),
+		//structure of map (add elements, clear, load) must not be changed during access of other threads
+		void lockWriters(void);
+		void unlockWriters(void);
+		void beginTableWrite(uint8_t functionCode);
+		void endTableWrite(uint8_t functionCode);
+		uint32_t beginTableRead(uint8_t functionCode) const;
+		bool endTableRead(uint8_t functionCode, uint32_t tableVersion) const;
+		/* write section of table for scope of object */
+		class tableWriteSection
+		{
+			public:
+				tableWriteSection(ModbusRegMap* regMap, uint8_t functionCode)
+					: RegMap(regMap), FunctionCode(functionCode)
+				{
+					this->RegMap->beginTableWrite(this->FunctionCode);
+				}
+				~tableWriteSection()
+				{
+					this->RegMap->endTableWrite(this->FunctionCode);
+				}
+			private:
+				ModbusRegMap* RegMap;
+				uint8_t FunctionCode;
+		};
+		/* range read without check of concurrent change */
+		bool readElementsRange(ModbusRegTable* regTable, uint16_t startAddress, uint16_t registersCount, uint8_t* buffer, size_t* bytesCount);
+		/* value of one bit element from packed values and copy of element value to packed values - packed values are main storage */
+		uint8_t loadBitElement(const ModbusElementBase* modElBase) const;
+		void storeBitElement(ModbusElementBase* modElBase);
+		/* create wire format image of table from existing elements */
+		bool createWireImage(ModbusRegTable* regTable);
+		/* add element to wire format image or update its value in image */
+		void addWireElement(ModbusWireImage* wireImage, ModbusElementBase* modElBase);
+		void storeWireElement(ModbusWireImage* wireImage, ModbusElementBase* modElBase);
 		/* helper function for add one new element to register map */
 		template <typename ElDataType>
 		bool addNewRegMapElement(rapidjson::Value::ValueIterator elIterator, ModbusDataType jDataType);
@@ -371,6 +554,15 @@ class ModbusRegMap
 		/* helper function for copy buffer data to element binary data */
 		template <typename ModElType>
 		bool copyRAWDataToElement(ModbusElementBase* modElBase, ModbusDataType dataType, uint8_t* buffer, uint16_t bytesCount);
+		/* helper function for copy element data to buffer in modbus wire format */
+		template <typename ModElType>
+		void copyElementToWireData(ModbusElementBase* modElBase, uint8_t* buffer, uint16_t wireBytesCount);
+		/* helper function for check (and copy, if not checkOnly) buffer data in modbus wire format to element */
+		template <typename ModElType>
+		bool copyWireDataToElement(ModbusElementBase* modElBase, const uint8_t* buffer, uint16_t wireBytesCount, bool checkOnly);
+		/* helper functions for wire format access to element depending on element data type */
+		bool elementToWireData(ModbusElementBase* modElBase, uint8_t* buffer);
+		bool wireDataToElement(ModbusElementBase* modElBase, const uint8_t* buffer, bool checkOnly);
 		/* helper function for save modbus reg map to JSON */
 		template <typename ElDataType>
 		bool addDefMinMaxToJSON(ModbusElementBase* modbusElementBase, rapidjson::Value* jsonVal, rapidjson::Document* jsonDoc);
@@ -0,0 +1,299 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Timer wheel source file. Timeouts of MODBUS master requests on monotonic clock.
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include "ModbusTimerWheel.h"
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* constructor */
+ModbusTimerWheel::ModbusTimerWheel(uint32_t tickDuration, size_t slotsCount) :
+	startTime(std::chrono::steady_clock::now()), tickDuration(tickDuration ? tickDuration : 1)
+{
+	size_t wheelSize = 16;
+	while (wheelSize < slotsCount)
+	{
+		wheelSize <<= 1;
+	}
+	this->slots.assign(wheelSize, noTimer);
+	this->slotsMask = wheelSize - 1;
+	this->expiredCallbacks.reserve(wheelSize);
+}
+
+/* destructor */
+ModbusTimerWheel::~ModbusTimerWheel()
+{
+	StopThread();
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* current tick of monotonic clock */
+uint64_t ModbusTimerWheel::currentTick(void) const
+{
+	return (uint64_t)((std::chrono::steady_clock::now() - this->startTime) / this->tickDuration);
+}
+
+/* add node to head of list of its slot */
+void ModbusTimerWheel::linkNode(uint32_t nodeIndex)
+{
+	timerNode& node = this->nodes[nodeIndex];
+	uint32_t& slotHead = this->slots[node.deadlineTick & this->slotsMask];
+	node.prev = noTimer;
+	node.next = slotHead;
+	if (slotHead != noTimer)
+	{
+		this->nodes[slotHead].prev = nodeIndex;
+	}
+	slotHead = nodeIndex;
+}
+
+/* remove node from list of its slot */
+void ModbusTimerWheel::unlinkNode(uint32_t nodeIndex)
+{
+	timerNode& node = this->nodes[nodeIndex];
+	if (node.prev != noTimer)
+	{
+		this->nodes[node.prev].next = node.next;
+	}
+	else
+	{
+		this->slots[node.deadlineTick & this->slotsMask] = node.next;
+	}
+	if (node.next != noTimer)
+	{
+		this->nodes[node.next].prev = node.prev;
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* start timer */
+uint32_t ModbusTimerWheel::StartTimer(uint32_t timeout, TimerCallbackFuncObj callbackFunc)
+{
+	if (!callbackFunc)
+	{
+		return 0;
+	}
+	//current tick is partly passed - one more tick, so timer doesn't expire before timeout
+	uint64_t timeoutTicks = (timeout + (uint64_t)this->tickDuration.count() - 1) / (uint64_t)this->tickDuration.count() + 1;
+
+	std::unique_lock <std::mutex> lock(this->wheelLock);
+	//node from free list or new node of pool
+	uint32_t nodeIndex = this->freeNodes;
+	if (nodeIndex != noTimer)
+	{
+		this->freeNodes = this->nodes[nodeIndex].next;
+	}
+	else
+	{
+		if (this->nodes.size() >= timerIndexMask)
+		{
+			return 0;
+		}
+		try
+		{
+			this->nodes.emplace_back();
+		}
+		catch (...)
+		{
+			return 0;
+		}
+		nodeIndex = (uint32_t)(this->nodes.size() - 1);
+	}
+	timerNode& node = this->nodes[nodeIndex];
+	//generation isn't 0 - identifier isn't 0
+	node.generation = (node.generation + 1) & (0xFFFFFFFF >> timerIndexBits);
+	if (!node.generation)
+	{
+		node.generation = 1;
+	}
+	node.deadlineTick = currentTick() + timeoutTicks;
+	node.started = true;
+	node.callback = std::move(callbackFunc);
+	linkNode(nodeIndex);
+	//thread of wheel waits without timers - wake it
+	if (this->timersCount++ == 0)
+	{
+		this->wheelEvent.notify_one();
+	}
+	return (node.generation << timerIndexBits) | nodeIndex;
+}
+
+/* stop timer */
+bool ModbusTimerWheel::StopTimer(uint32_t timerID)
+{
+	uint32_t nodeIndex = timerID & timerIndexMask;
+	TimerCallbackFuncObj callback;
+	std::unique_lock <std::mutex> lock(this->wheelLock);
+	if (!timerID || nodeIndex >= this->nodes.size())
+	{
+		return false;
+	}
+	timerNode& node = this->nodes[nodeIndex];
+	if (!node.started || node.generation != (timerID >> timerIndexBits))
+	{
+		return false;
+	}
+	unlinkNode(nodeIndex);
+	node.started = false;
+	//callback is destroyed without lock
+	callback = std::move(node.callback);
+	node.callback = nullptr;
+	node.next = this->freeNodes;
+	this->freeNodes = nodeIndex;
+	this->timersCount--;
+	lock.unlock();
+	return true;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* call callbacks of expired timers */
+size_t ModbusTimerWheel::ProcessExpired(void)
+{
+	std::unique_lock <std::mutex> lock(this->wheelLock);
+	uint64_t nowTick = currentTick();
+	if (nowTick <= this->processedTick)
+	{
+		return 0;
+	}
+	//slots of ticks after last processing, one turn at most - other turns are in same slots
+	uint64_t ticksCount = nowTick - this->processedTick;
+	if (ticksCount > this->slots.size())
+	{
+		ticksCount = this->slots.size();
+	}
+	for (uint64_t tick = this->processedTick + 1; tick <= this->processedTick + ticksCount; tick++)
+	{
+		uint32_t nodeIndex = this->slots[tick & this->slotsMask];
+		while (nodeIndex != noTimer)
+		{
+			timerNode& node = this->nodes[nodeIndex];
+			uint32_t nextIndex = node.next;
+			if (node.deadlineTick <= nowTick)
+			{
+				unlinkNode(nodeIndex);
+				node.started = false;
+				try
+				{
+					this->expiredCallbacks.push_back(std::move(node.callback));
+				}
+				catch (...)
+				{
+					//no memory - callback is lost, timer is stopped
+				}
+				node.callback = nullptr;
+				node.next = this->freeNodes;
+				this->freeNodes = nodeIndex;
+				this->timersCount--;
+			}
+			nodeIndex = nextIndex;
+		}
+	}
+	this->processedTick = nowTick;
+	size_t expiredCount = this->expiredCallbacks.size();
+	if (!expiredCount)
+	{
+		return 0;
+	}
+	//timers can't be stopped already - call is visible to WaitExpiredCallbacks before lock is released
+	this->expiredCallActive = true;
+	this->expiredCallThread = std::this_thread::get_id();
+	lock.unlock();
+
+	for (size_t i = 0; i < expiredCount; i++)
+	{
+		this->expiredCallbacks[i]();
+	}
+	this->expiredCallbacks.clear();
+
+	lock.lock();
+	this->expiredCallActive = false;
+	this->expiredCallsCount++;
+	lock.unlock();
+	this->expiredCallEvent.notify_all();
+	return expiredCount;
+}
+
+/* wait end of callbacks that are being called */
+void ModbusTimerWheel::WaitExpiredCallbacks(void)
+{
+	std::unique_lock <std::mutex> lock(this->wheelLock);
+	if (!this->expiredCallActive || this->expiredCallThread == std::this_thread::get_id())
+	{
+		return;
+	}
+	uint64_t callsCount = this->expiredCallsCount;
+	this->expiredCallEvent.wait(lock, [this, callsCount]() { return this->expiredCallsCount != callsCount; });
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* start own thread of wheel */
+bool ModbusTimerWheel::StartThread(void)
+{
+	std::unique_lock <std::mutex> lock(this->wheelLock);
+	if (this->wheelThread.joinable())
+	{
+		return true;
+	}
+	this->threadStopRequested = false;
+	try
+	{
+		this->wheelThread = std::thread(&ModbusTimerWheel::wheelThreadFunction, this);
+	}
+	catch (...)
+	{
+		return false;
+	}
+	return true;
+}
+
+/* stop own thread of wheel */
+void ModbusTimerWheel::StopThread(void)
+{
+	{
+		std::unique_lock <std::mutex> lock(this->wheelLock);
+		if (!this->wheelThread.joinable())
+		{
+			return;
+		}
+		this->threadStopRequested = true;
+	}
+	this->wheelEvent.notify_one();
+	this->wheelThread.join();
+}
+
+/* thread function of wheel: wait without timers, process expired timers each tick */
+void ModbusTimerWheel::wheelThreadFunction(void)
+{
+	std::unique_lock <std::mutex> lock(this->wheelLock);
+	while (!this->threadStopRequested)
+	{
+		if (!this->timersCount)
+		{
+			this->wheelEvent.wait(lock, [this]() { return this->threadStopRequested || this->timersCount; });
+			continue;
+		}
+		std::chrono::steady_clock::time_point nextTickTime = this->startTime + (this->processedTick + 1) * this->tickDuration;
+		if (this->wheelEvent.wait_until(lock, nextTickTime, [this]() { return this->threadStopRequested; }))
+		{
+			break;
+		}
+		lock.unlock();
+		ProcessExpired();
+		lock.lock();
+	}
+}
+
+/* wheel for StartTimeoutTimer/StopTimeoutTimer */
+ModbusTimerWheel& ModbusTimerWheel::DefaultWheel(void)
+{
+	static ModbusTimerWheel defaultWheel;
+	static bool threadStarted = defaultWheel.StartThread();
+	(void)threadStarted;
+	return defaultWheel;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,108 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Timer wheel header file. Timeouts of MODBUS master requests on monotonic clock.
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#ifndef MODBUS_TIMER_WHEEL
+#define MODBUS_TIMER_WHEEL
+
+#include <stdint.h>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* hashed timer wheel: slot of timer is its deadline tick modulo slots count, timers of slot are in doubly linked list */
+//start and stop of timer - O(1), one tick - O(timers of slot); timer with deadline over one wheel turn stays in slot
+//until its tick (deadline is absolute tick of monotonic clock), so timeout isn't limited by wheel size;
+//timers are nodes of pool, timer identifier is node index and generation - stale identifier of reused node is ignored
+class ModbusTimerWheel
+{
+	public:
+		typedef std::function <void()> TimerCallbackFuncObj;
+
+		/* constructor: tick duration (ms), slots count (rounded up to power of 2) */
+		ModbusTimerWheel(uint32_t tickDuration = 1, size_t slotsCount = 1024);
+
+		/* destructor - thread of wheel is stopped, not expired timers are dropped without callback */
+		~ModbusTimerWheel();
+
+		/* start timer, callback is called once after timeout (ms, rounded up to tick), returns timer identifier or 0 */
+		uint32_t StartTimer(uint32_t timeout, TimerCallbackFuncObj callbackFunc);
+		/* stop timer, false - timer is expired (callback is called or is being called) or identifier is wrong */
+		bool StopTimer(uint32_t timerID);
+		/* call callbacks of expired timers in this thread, returns count of expired timers */
+		//for owner loop without thread of wheel; only one thread calls ProcessExpired
+		size_t ProcessExpired(void);
+		/* wait end of callbacks of expired timers that are being called now */
+		//StopTimer returns false for timer whose callback is taken for call - owner of callback data waits it before destruction;
+		//call from callback returns at once
+		void WaitExpiredCallbacks(void);
+		/* start or stop own thread of wheel - it calls ProcessExpired each tick while timers are started */
+		bool StartThread(void);
+		void StopThread(void);
+		/* count of started timers */
+		size_t GetTimersCount(void) const
+		{
+			return this->timersCount;
+		}
+
+		/* wheel with own thread for StartTimeoutTimer/StopTimeoutTimer, thread is started at first call */
+		static ModbusTimerWheel& DefaultWheel(void);
+
+	private:
+		//identifier: node index in low bits, generation of node in high bits
+		static constexpr uint32_t timerIndexBits = 20;
+		static constexpr uint32_t timerIndexMask = (1u << timerIndexBits) - 1;
+		static constexpr uint32_t noTimer = 0xFFFFFFFF;
+		//node of timer in list of slot or in free list
+		struct timerNode
+		{
+			uint64_t deadlineTick = 0;
+			uint32_t generation = 0;
+			uint32_t prev = noTimer;
+			uint32_t next = noTimer;
+			bool started = false;
+			TimerCallbackFuncObj callback = nullptr;
+		};
+		std::chrono::steady_clock::time_point startTime;
+		std::chrono::milliseconds tickDuration;
+		//heads of slot lists
+		std::vector <uint32_t> slots;
+		size_t slotsMask = 0;
+		//pool of nodes, free nodes list
+		std::vector <timerNode> nodes;
+		uint32_t freeNodes = noTimer;
+		//last processed tick
+		uint64_t processedTick = 0;
+		std::atomic <size_t> timersCount = 0;
+		//callbacks of expired timers are called without lock - stop and start from callback are allowed
+		std::vector <TimerCallbackFuncObj> expiredCallbacks;
+		std::mutex wheelLock;
+		//call of expired callbacks: callbacks are taken from wheel, count of finished calls, thread of calls
+		bool expiredCallActive = false;
+		uint64_t expiredCallsCount = 0;
+		std::thread::id expiredCallThread;
+		std::condition_variable expiredCallEvent;
+
+		//own thread of wheel
+		std::thread wheelThread;
+		std::condition_variable wheelEvent;
+		bool threadStopRequested = false;
+
+		/* current tick of monotonic clock */
+		uint64_t currentTick(void) const;
+		/* add node to list of slot or remove it */
+		void linkNode(uint32_t nodeIndex);
+		void unlinkNode(uint32_t nodeIndex);
+		/* thread function of wheel */
+		void wheelThreadFunction(void);
+};
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+#endif
@@ -0,0 +1,272 @@
+//*********************************************************************************************************//
+//Modbus TCP load client
+//Many client connections in one thread (epoll, Linux), each connection keeps set count of read requests in flight.
+//Build: g++ -O2 -std=c++17 ModbusTcpLoadClient.cpp -o ModbusTcpLoadClient
+//Usage: ModbusTcpLoadClient <server IPv4> <port> [connections] [requests in flight] [seconds] [unit id] [register address] [registers count]
+//Created 16.10.2026
+//Created by Novikov Dmitry
+//*********************************************************************************************************//
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <vector>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+using std::vector;
+using steady_clock = std::chrono::steady_clock;
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+//client connection: requests in flight are answered in order of sending
+struct clientConnection
+{
+	int socket = -1;
+	bool connected = false;
+	//transaction identifier of next request and of oldest request in flight
+	uint16_t nextTransactionId = 0;
+	uint16_t expectedTransactionId = 0;
+	//send time of requests in flight by transaction identifier
+	vector <steady_clock::time_point> sendTime;
+	//not complete answer
+	uint8_t input[260];
+	size_t inputSize = 0;
+};
+
+//test parameters and results
+struct loadTest
+{
+	uint8_t unitId = 1;
+	uint16_t registerAddress = 0;
+	uint16_t registersCount = 10;
+	size_t requestsInFlight = 1;
+	uint64_t answers = 0;
+	uint64_t exceptions = 0;
+	uint64_t errors = 0;
+	double latencySum = 0;
+};
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* send count of read holding registers requests */
+static bool sendRequests(clientConnection* connection, loadTest* test, size_t count)
+{
+	uint8_t requests[12 * 64];
+	while (count)
+	{
+		size_t packCount = (count < 64) ? count : 64;
+		steady_clock::time_point now = steady_clock::now();
+		for (size_t i = 0; i < packCount; i++)
+		{
+			uint8_t* request = requests + i * 12;
+			uint16_t transactionId = connection->nextTransactionId++;
+			connection->sendTime[transactionId % connection->sendTime.size()] = now;
+			//MBAP header: transaction identifier, protocol identifier, length, unit identifier
+			request[0] = (uint8_t)(transactionId >> 8);
+			request[1] = (uint8_t)transactionId;
+			request[2] = 0;
+			request[3] = 0;
+			request[4] = 0;
+			request[5] = 6;
+			request[6] = test->unitId;
+			//PDU: function 0x03, first register, registers count
+			request[7] = 0x03;
+			request[8] = (uint8_t)(test->registerAddress >> 8);
+			request[9] = (uint8_t)test->registerAddress;
+			request[10] = (uint8_t)(test->registersCount >> 8);
+			request[11] = (uint8_t)test->registersCount;
+		}
+		//requests are small - socket buffer is never full with limited requests in flight
+		size_t length = packCount * 12;
+		if (send(connection->socket, requests, length, MSG_NOSIGNAL) != (ssize_t)length)
+		{
+			return false;
+		}
+		count -= packCount;
+	}
+	return true;
+}
+
+/* receive answers and send new request for each answer */
+static bool receiveAnswers(clientConnection* connection, loadTest* test)
+{
+	uint8_t buffer[65536 + 260];
+	while (1)
+	{
+		memcpy(buffer, connection->input, connection->inputSize);
+		ssize_t received = recv(connection->socket, buffer + connection->inputSize, 65536, 0);
+		if (received == 0)
+		{
+			return false;
+		}
+		if (received < 0)
+		{
+			return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+		}
+		size_t dataLength = connection->inputSize + (size_t)received;
+		size_t position = 0;
+		size_t answersCount = 0;
+		steady_clock::time_point now = steady_clock::now();
+		while (dataLength - position >= 7)
+		{
+			const uint8_t* answer = buffer + position;
+			size_t length = (size_t)answer[4] << 8 | answer[5];
+			if (length < 2 || length > 254)
+			{
+				test->errors++;
+				return false;
+			}
+			if (dataLength - position < length + 6)
+			{
+				break;
+			}
+			//answer must have transaction identifier of oldest request
+			uint16_t transactionId = (uint16_t)answer[0] << 8 | answer[1];
+			if (transactionId != connection->expectedTransactionId)
+			{
+				test->errors++;
+			}
+			else if (answer[7] & 0x80)
+			{
+				test->exceptions++;
+			}
+			else if (answer[7] != 0x03 || answer[8] != test->registersCount * 2 || length != 3 + (size_t)answer[8])
+			{
+				test->errors++;
+			}
+			test->latencySum += std::chrono::duration <double>(now - connection->sendTime[transactionId % connection->sendTime.size()]).count();
+			connection->expectedTransactionId = transactionId + 1;
+			test->answers++;
+			answersCount++;
+			position += length + 6;
+		}
+		connection->inputSize = dataLength - position;
+		memcpy(connection->input, buffer + position, connection->inputSize);
+		if (answersCount && !sendRequests(connection, test, answersCount))
+		{
+			return false;
+		}
+		if ((size_t)received < 65536)
+		{
+			return true;
+		}
+	}
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		cout << "Usage: ModbusTcpLoadClient <server IPv4> <port> [connections] [requests in flight] [seconds] [unit id] [register address] [registers count]" << endl;
+		return 1;
+	}
+	//test parameters
+	loadTest test;
+	size_t connectionsCount = (argc > 3) ? (size_t)atoi(argv[3]) : 100;
+	test.requestsInFlight = (argc > 4) ? (size_t)atoi(argv[4]) : 1;
+	double seconds = (argc > 5) ? atof(argv[5]) : 5;
+	test.unitId = (argc > 6) ? (uint8_t)atoi(argv[6]) : 1;
+	test.registerAddress = (argc > 7) ? (uint16_t)atoi(argv[7]) : 0;
+	test.registersCount = (argc > 8) ? (uint16_t)atoi(argv[8]) : 10;
+	if (!connectionsCount || !test.requestsInFlight || test.requestsInFlight > 1024 || !test.registersCount || test.registersCount > 125)
+	{
+		cout << "Invalid test parameters" << endl;
+		return 1;
+	}
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons((uint16_t)atoi(argv[2]));
+	if (inet_pton(AF_INET, argv[1], &address.sin_addr) != 1)
+	{
+		cout << "Invalid server address" << endl;
+		return 1;
+	}
+
+	//connect all clients, connection is complete on first writable event
+	int epollHandle = epoll_create1(0);
+	vector <clientConnection> connections(connectionsCount);
+	for (clientConnection& connection : connections)
+	{
+		connection.socket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+		int option = 1;
+		setsockopt(connection.socket, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option));
+		if (connection.socket < 0 || (connect(connection.socket, (sockaddr*)&address, sizeof(address)) < 0 && errno != EINPROGRESS))
+		{
+			cout << "Can't connect to server" << endl;
+			return 1;
+		}
+		connection.sendTime.resize(test.requestsInFlight);
+		epoll_event event = {};
+		event.events = EPOLLIN | EPOLLOUT;
+		event.data.ptr = &connection;
+		epoll_ctl(epollHandle, EPOLL_CTL_ADD, connection.socket, &event);
+	}
+
+	//test loop
+	size_t activeConnections = connectionsCount;
+	steady_clock::time_point start = steady_clock::now();
+	steady_clock::time_point stop = start + std::chrono::duration_cast <steady_clock::duration>(std::chrono::duration <double>(seconds));
+	vector <epoll_event> events(1024);
+	while (activeConnections && steady_clock::now() < stop)
+	{
+		int eventsCount = epoll_wait(epollHandle, events.data(), (int)events.size(), 100);
+		for (int i = 0; i < eventsCount; i++)
+		{
+			clientConnection* connection = (clientConnection*)events[i].data.ptr;
+			bool connectionAlive = true;
+			if (!connection->connected && (events[i].events & EPOLLOUT))
+			{
+				//connected - wait answers only, send first requests
+				int socketError = 0;
+				socklen_t socketErrorSize = sizeof(socketError);
+				getsockopt(connection->socket, SOL_SOCKET, SO_ERROR, &socketError, &socketErrorSize);
+				epoll_event event = {};
+				event.events = EPOLLIN;
+				event.data.ptr = connection;
+				epoll_ctl(epollHandle, EPOLL_CTL_MOD, connection->socket, &event);
+				connection->connected = true;
+				connectionAlive = !socketError && sendRequests(connection, &test, test.requestsInFlight);
+			}
+			if (connectionAlive && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+			{
+				connectionAlive = receiveAnswers(connection, &test);
+			}
+			if (!connectionAlive)
+			{
+				epoll_ctl(epollHandle, EPOLL_CTL_DEL, connection->socket, nullptr);
+				close(connection->socket);
+				connection->socket = -1;
+				activeConnections--;
+			}
+		}
+	}
+	double testTime = std::chrono::duration <double>(steady_clock::now() - start).count();
+
+	//results
+	cout << "connections: " << connectionsCount << ", active at end: " << activeConnections << endl;
+	cout << "answers: " << test.answers << ", exceptions: " << test.exceptions << ", errors: " << test.errors << endl;
+	cout << "requests per second: " << (uint64_t)(test.answers / testTime) << endl;
+	if (test.answers)
+	{
+		cout << "average latency, us: " << test.latencySum / test.answers * 1e6 << endl;
+	}
+	for (clientConnection& connection : connections)
+	{
+		if (connection.socket >= 0)
+		{
+			close(connection.socket);
+		}
+	}
+	close(epollHandle);
+	return (test.errors || activeConnections != connectionsCount) ? 2 : 0;
+}
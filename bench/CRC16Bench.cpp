@@ -0,0 +1,102 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Benchmark of modbus CRC16: slicing-by-8 kernel (ModbusCRC16) against reference byte table, frames of 8...256 bytes.
+//Build: see bench/README.md
+//Usage: CRC16Bench [frames of each size]
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "ModbusProtocolHandler.h"
+
+using steady_clock = std::chrono::steady_clock;
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* reference table of one byte - generated by polynomial, same as table of ModbusCRC16 */
+static uint16_t byteCRCTable[256];
+
+static void buildByteCRCTable(void)
+{
+	for (int b = 0; b < 256; b++)
+	{
+		uint16_t crc = (uint16_t)b;
+		for (int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x0001) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+		}
+		byteCRCTable[b] = crc;
+	}
+}
+
+/* modbus crc16 by reference table - one byte at a time, as before slicing */
+static uint16_t byteTableCRC16(const uint8_t* inputData, uint16_t dataLength)
+{
+	uint16_t wCRCWord = 0xFFFF;
+	uint8_t nTemp;
+	while (dataLength--)
+	{
+		nTemp = *inputData++ ^ wCRCWord;
+		wCRCWord >>= 8;
+		wCRCWord ^= byteCRCTable[nTemp];
+	}
+	return wCRCWord;
+}
+
+/* best time of several runs over all frames of one size, ns per frame; sum of CRCs compares both ways */
+template <typename CRCFunc>
+static double frameTime(CRCFunc crcFunc, const std::vector <uint8_t>& frames, uint16_t frameSize, uint32_t* crcSum)
+{
+	size_t framesCount = frames.size() / frameSize;
+	double bestTime = 0;
+	for (int run = 0; run < 7; run++)
+	{
+		uint32_t sum = 0;
+		steady_clock::time_point startTime = steady_clock::now();
+		for (size_t i = 0; i < framesCount; i++)
+		{
+			sum += crcFunc(&frames[i * frameSize], frameSize);
+		}
+		double runTime = std::chrono::duration <double, std::nano>(steady_clock::now() - startTime).count() / (double)framesCount;
+		if (!run || runTime < bestTime)
+		{
+			bestTime = runTime;
+		}
+		*crcSum = sum;
+	}
+	return bestTime;
+}
+
+int main(int argc, char* argv[])
+{
+	size_t framesCount = (argc > 1) ? (size_t)atol(argv[1]) : 20000;
+	if (!framesCount)
+	{
+		printf("Usage: CRC16Bench [frames of each size]\n");
+		return 1;
+	}
+	buildByteCRCTable();
+
+	//frames of random data one after another - different data for each frame
+	const uint16_t frameSizes[] = { 8, 16, 32, 64, 128, 256 };
+	std::mt19937 randomGenerator(1);
+	for (size_t i = 0; i < sizeof(frameSizes) / sizeof(frameSizes[0]); i++)
+	{
+		uint16_t frameSize = frameSizes[i];
+		std::vector <uint8_t> frames(framesCount * frameSize);
+		for (size_t j = 0; j < frames.size(); j++)
+		{
+			frames[j] = (uint8_t)randomGenerator();
+		}
+		uint32_t tableSum = 0, slicingSum = 0;
+		double tableTime = frameTime(byteTableCRC16, frames, frameSize, &tableSum);
+		double slicingTime = frameTime(ModbusCRC16, frames, frameSize, &slicingSum);
+		printf("%3u bytes: byte table %6.1f ns, slicing-by-8 %6.1f ns, x%.1f%s\n", frameSize, tableTime, slicingTime,
+			tableTime / slicingTime, (tableSum == slicingSum) ? "" : ", CRC MISMATCH");
+	}
+	return 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
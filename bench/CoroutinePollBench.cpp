@@ -0,0 +1,264 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Benchmark of master coroutines: simulated devices polled by coroutines on one executor thread against thread per device with futures.
+//Build: see bench/README.md
+//Usage: CoroutinePollBench [devices count] [polls of device]
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#include "ModbusCoroutines.h"
+
+using steady_clock = std::chrono::steady_clock;
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* count of allocations - to check that suspended transaction doesn't allocate */
+//replacement operators aren't inlined - else g++ sees free of pointer from operator new (-Wmismatched-new-delete)
+#ifdef _MSC_VER
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+static std::atomic <size_t> allocationsCount = 0;
+
+BENCH_NOINLINE void* operator new(size_t size)
+{
+	allocationsCount++;
+	void* memory = malloc(size ? size : 1);
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+BENCH_NOINLINE void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+BENCH_NOINLINE void operator delete(void* memory, size_t) noexcept
+{
+	free(memory);
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* loopback slave: requests of all masters (MODBUS TCP frames) are answered by one thread, answer is passed to master of request */
+//all simulated devices have same registers, so one slave answers for them
+class LoopbackSlave
+{
+	public:
+		/* constructor */
+		LoopbackSlave(ModbusRegMap* registerMap)
+		{
+			this->slave.SetRegisterMap(registerMap);
+			this->requests.reserve(4096);
+			this->processedRequests.reserve(4096);
+			this->slaveThread = std::thread(&LoopbackSlave::slaveThreadFunc, this);
+		}
+
+		/* destructor */
+		~LoopbackSlave()
+		{
+			{
+				std::lock_guard <std::mutex> lock(this->requestsLock);
+				this->stopRequested = true;
+			}
+			this->requestsEvent.notify_one();
+			this->slaveThread.join();
+		}
+
+		/* request of master - send function of master */
+		void SendRequest(ModbusProtocolMaster* master, const uint8_t* data, size_t dataLength)
+		{
+			{
+				std::lock_guard <std::mutex> lock(this->requestsLock);
+				this->requests.emplace_back(master, std::vector <uint8_t>(data, data + dataLength));
+			}
+			this->requestsEvent.notify_one();
+		}
+
+	private:
+		typedef std::pair <ModbusProtocolMaster*, std::vector <uint8_t>> loopbackRequest;
+
+		/* answer requests: MBAP header of request, PDU of slave */
+		void slaveThreadFunc(void)
+		{
+			const size_t mbapHeaderSize = 7;
+			uint8_t answerPdu[260];
+			uint8_t answer[mbapHeaderSize + sizeof(answerPdu)];
+			for (;;)
+			{
+				{
+					std::unique_lock <std::mutex> lock(this->requestsLock);
+					this->requestsEvent.wait(lock, [this] { return this->stopRequested || !this->requests.empty(); });
+					if (this->requests.empty())
+					{
+						return;
+					}
+					this->processedRequests.swap(this->requests);
+				}
+				for (size_t i = 0; i < this->processedRequests.size(); i++)
+				{
+					std::vector <uint8_t>& request = this->processedRequests[i].second;
+					if (request.size() <= mbapHeaderSize)
+					{
+						continue;
+					}
+					size_t pduLength = this->slave.ProcessRequestPDU(request[6], request.data() + mbapHeaderSize,
+						request.size() - mbapHeaderSize, answerPdu, sizeof(answerPdu));
+					memcpy(answer, request.data(), 4);
+					answer[4] = (uint8_t)((pduLength + 1) >> 8);
+					answer[5] = (uint8_t)(pduLength + 1);
+					answer[6] = request[6];
+					memcpy(answer + mbapHeaderSize, answerPdu, pduLength);
+					this->processedRequests[i].first->inputPacketParse(answer, pduLength + mbapHeaderSize);
+				}
+				this->processedRequests.clear();
+			}
+		}
+
+		ModbusProtocolSlave slave;
+		std::mutex requestsLock;
+		std::condition_variable requestsEvent;
+		std::vector <loopbackRequest> requests;
+		std::vector <loopbackRequest> processedRequests;
+		bool stopRequested = false;
+		std::thread slaveThread;
+};
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* poll of one device by coroutine */
+static ModbusTask pollDevice(ModbusProtocolMaster& master, int pollsCount, std::atomic <size_t>& answersCount, std::atomic <size_t>& errorsCount)
+{
+	for (int i = 0; i < pollsCount; i++)
+	{
+		int result = co_await master.AwaitReadRequest(3, 0, 10);
+		if (result == 0)
+		{
+			answersCount++;
+		}
+		else
+		{
+			errorsCount++;
+		}
+	}
+}
+
+/* print results of one way of poll */
+static void printResults(const char* name, size_t answersCount, size_t errorsCount, double seconds, size_t threadsCount, size_t allocations)
+{
+	printf("%s: requests %zu, errors %zu, %.2f s, %.0f req/s, threads %zu, allocations/request %.2f\n", name, answersCount, errorsCount,
+		seconds, answersCount / seconds, threadsCount, (double)allocations / (double)(answersCount + errorsCount));
+}
+
+int main(int argc, char* argv[])
+{
+	int devicesCount = (argc > 1) ? atoi(argv[1]) : 1000;
+	int pollsCount = (argc > 2) ? atoi(argv[2]) : 100;
+	if (devicesCount <= 0 || pollsCount <= 0)
+	{
+		printf("Usage: CoroutinePollBench [devices count] [polls of device]\n");
+		return 1;
+	}
+
+	ModbusRegMap slaveRegisterMap;
+	for (uint16_t address = 0; address < 10; address++)
+	{
+		uint16_t value = (uint16_t)(0x100 + address), minValue = 0, maxValue = 65535;
+		slaveRegisterMap.AddNewElement <uint16_t>(3, address, ModbusDataType::UInt16, 2, "register", 0, value, minValue, maxValue, "");
+	}
+	LoopbackSlave loopbackSlave(&slaveRegisterMap);
+	std::vector <ModbusRegMap> deviceRegisterMaps(devicesCount);
+	std::vector <ModbusProtocolMaster> masters(devicesCount);
+	for (int device = 0; device < devicesCount; device++)
+	{
+		for (uint16_t address = 0; address < 10; address++)
+		{
+			uint16_t value = 0, minValue = 0, maxValue = 65535;
+			deviceRegisterMaps[device].AddNewElement <uint16_t>(3, address, ModbusDataType::UInt16, 2, "register", 0, value, minValue, maxValue, "");
+		}
+		ModbusProtocolMaster* master = &masters[device];
+		master->SetRegisterMap(&deviceRegisterMaps[device]);
+		master->SetTcpMode(true);
+		master->SetSendDataFunc([&loopbackSlave, master](uint8_t* data, size_t dataLength)
+			{
+				loopbackSlave.SendRequest(master, data, dataLength);
+				return true;
+			});
+	}
+
+	//coroutines: all devices on one executor thread; allocations include copy of request by loopback
+	{
+		std::atomic <size_t> answersCount = 0, errorsCount = 0;
+		ModbusCoroutineExecutor executor;
+		for (int device = 0; device < devicesCount; device++)
+		{
+			executor.Spawn(pollDevice(masters[device], pollsCount, answersCount, errorsCount));
+		}
+		size_t allocationsBefore = allocationsCount;
+		steady_clock::time_point startTime = steady_clock::now();
+		executor.Run();
+		double seconds = std::chrono::duration <double>(steady_clock::now() - startTime).count();
+		printResults("coroutines", answersCount, errorsCount, seconds, 1, allocationsCount - allocationsBefore);
+	}
+
+	//futures: thread per device
+	{
+		std::atomic <size_t> answersCount = 0, errorsCount = 0;
+		std::vector <std::thread> deviceThreads;
+		deviceThreads.reserve(devicesCount);
+		size_t allocationsBefore = allocationsCount;
+		steady_clock::time_point startTime = steady_clock::now();
+		for (int device = 0; device < devicesCount; device++)
+		{
+			deviceThreads.emplace_back([&masters, &answersCount, &errorsCount, device, pollsCount]
+				{
+					for (int i = 0; i < pollsCount; i++)
+					{
+						if (masters[device].SendReadRequest(3, 0, 10).get() == 0)
+						{
+							answersCount++;
+						}
+						else
+						{
+							errorsCount++;
+						}
+					}
+				});
+		}
+		for (size_t i = 0; i < deviceThreads.size(); i++)
+		{
+			deviceThreads[i].join();
+		}
+		double seconds = std::chrono::duration <double>(steady_clock::now() - startTime).count();
+		printResults("futures   ", answersCount, errorsCount, seconds, deviceThreads.size(), allocationsCount - allocationsBefore);
+	}
+
+	//values of slave in register maps of all devices
+	size_t valueErrorsCount = 0;
+	for (int device = 0; device < devicesCount; device++)
+	{
+		for (uint16_t address = 0; address < 10; address++)
+		{
+			const uint16_t* value;
+			deviceRegisterMaps[device].GetElementValue <uint16_t>(3, address, &value);
+			valueErrorsCount += (*value != 0x100 + address);
+		}
+	}
+	printf("devices %d, wrong register values %zu\n", devicesCount, valueErrorsCount);
+	return 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
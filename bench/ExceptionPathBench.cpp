@@ -0,0 +1,100 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Benchmark of slave request processing: requests with normal answers against requests with modbus exception answers.
+//Build: see bench/README.md
+//Usage: ExceptionPathBench [requests count]
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include "ModbusProtocolHandler.h"
+
+using steady_clock = std::chrono::steady_clock;
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* RTU request frame with CRC */
+static std::vector <uint8_t> requestFrame(std::vector <uint8_t> frame)
+{
+	uint16_t crcVal = ModbusCRC16(frame.data(), (uint16_t)frame.size());
+	frame.push_back((uint8_t)crcVal);
+	frame.push_back((uint8_t)(crcVal >> 8));
+	return frame;
+}
+
+/* best time of several runs of one request, ns per request */
+static double requestTime(ModbusProtocolSlave& slave, std::vector <uint8_t>& frame, size_t requestsCount)
+{
+	double bestTime = 0;
+	for (int run = 0; run < 7; run++)
+	{
+		steady_clock::time_point startTime = steady_clock::now();
+		for (size_t i = 0; i < requestsCount; i++)
+		{
+			slave.inputPacketParse(frame.data(), frame.size());
+		}
+		double runTime = std::chrono::duration <double, std::nano>(steady_clock::now() - startTime).count() / (double)requestsCount;
+		if (!run || runTime < bestTime)
+		{
+			bestTime = runTime;
+		}
+	}
+	return bestTime;
+}
+
+/* answers aren't cached - each request is processed by register map */
+//unknown function codes aren't framed by RTU decoder (dropped as noise), so illegal function isn't measured here
+int main(int argc, char* argv[])
+{
+	size_t requestsCount = (argc > 1) ? (size_t)atol(argv[1]) : 200000;
+	if (!requestsCount)
+	{
+		printf("Usage: ExceptionPathBench [requests count]\n");
+		return 1;
+	}
+
+	ModbusRegMap registerMap;
+	for (uint16_t address = 0; address < 100; address++)
+	{
+		uint16_t value = address, minValue = 0, maxValue = 100;
+		registerMap.AddNewElement <uint16_t>(3, address, ModbusDataType::UInt16, 2, "register", 0, value, minValue, maxValue, "");
+		registerMap.AddNewElement <uint16_t>(6, address, ModbusDataType::UInt16, 2, "register", 0, value, minValue, maxValue, "");
+	}
+	ModbusProtocolSlave slave;
+	slave.SetRegisterMap(&registerMap);
+	slave.SetDeviceAddress(1);
+	slave.SetResponseCacheEnabled(false);
+	size_t exceptionAnswersCount = 0;
+	slave.SetSendDataFunc([&exceptionAnswersCount](uint8_t* data, size_t dataLength)
+		{
+			if (dataLength > 1 && (data[1] & 0x80))
+			{
+				exceptionAnswersCount++;
+			}
+			return true;
+		});
+
+	struct requestCase
+	{
+		const char* name;
+		std::vector <uint8_t> frame;
+	};
+	std::vector <requestCase> requestCases =
+	{
+		{ "FC03 read 4 registers             ", requestFrame({ 1, 3, 0, 0, 0, 4 }) },
+		{ "FC03 illegal data address         ", requestFrame({ 1, 3, 0x10, 0, 0, 4 }) },
+		{ "FC06 write register               ", requestFrame({ 1, 6, 0, 7, 0, 9 }) },
+		{ "FC06 illegal data value (max 100) ", requestFrame({ 1, 6, 0, 7, 0x10, 0 }) },
+		{ "FC03 illegal quantity (0)         ", requestFrame({ 1, 3, 0, 0, 0, 0 }) },
+	};
+	for (size_t i = 0; i < requestCases.size(); i++)
+	{
+		exceptionAnswersCount = 0;
+		double timePerRequest = requestTime(slave, requestCases[i].frame, requestsCount);
+		printf("%s %6.1f ns/request, exception answers %s\n", requestCases[i].name, timePerRequest, exceptionAnswersCount ? "yes" : "no");
+	}
+	return 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
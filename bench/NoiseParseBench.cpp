@@ -0,0 +1,105 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Benchmark of RTU frame decoder of slave on received stream with noise between request frames.
+//Build: see bench/README.md
+//Usage: NoiseParseBench [noise probability 0...1] [max noise bytes] [bytes of one read]
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "ModbusProtocolHandler.h"
+
+using steady_clock = std::chrono::steady_clock;
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* stream of FC03 requests, before request - burst of random bytes with noise probability */
+static std::vector <uint8_t> buildNoisyStream(double noiseProbability, size_t noiseMaxBytes, size_t streamSize, size_t* framesCount)
+{
+	std::mt19937 randomGenerator(1);
+	std::uniform_real_distribution <double> noiseDistribution(0.0, 1.0);
+	std::vector <uint8_t> stream;
+	stream.reserve(streamSize + noiseMaxBytes + 8);
+	*framesCount = 0;
+	while (stream.size() < streamSize)
+	{
+		if (noiseMaxBytes && noiseDistribution(randomGenerator) < noiseProbability)
+		{
+			size_t noiseBytes = 1 + randomGenerator() % noiseMaxBytes;
+			for (size_t i = 0; i < noiseBytes; i++)
+			{
+				stream.push_back((uint8_t)randomGenerator());
+			}
+		}
+		uint8_t frame[8] = { 1, 3, 0, (uint8_t)(randomGenerator() % 200), 0, (uint8_t)(1 + randomGenerator() % 50) };
+		uint16_t crcVal = ModbusCRC16(frame, 6);
+		frame[6] = (uint8_t)crcVal;
+		frame[7] = (uint8_t)(crcVal >> 8);
+		stream.insert(stream.end(), frame, frame + 8);
+		(*framesCount)++;
+	}
+	return stream;
+}
+
+/* stream is passed to slave by reads of fixed size, answers are counted */
+static void runNoiseBenchmark(double noiseProbability, size_t noiseMaxBytes, size_t readSize)
+{
+	ModbusRegMap registerMap;
+	for (uint16_t address = 0; address < 300; address++)
+	{
+		uint16_t value = address, minValue = 0, maxValue = 65535;
+		registerMap.AddNewElement <uint16_t>(3, address, ModbusDataType::UInt16, 2, "register", 0, value, minValue, maxValue, "");
+	}
+	ModbusProtocolSlave slave;
+	slave.SetRegisterMap(&registerMap);
+	slave.SetDeviceAddress(1);
+	size_t answersCount = 0;
+	slave.SetSendDataFunc([&answersCount](uint8_t*, size_t)
+		{
+			answersCount++;
+			return true;
+		});
+
+	size_t framesCount = 0;
+	std::vector <uint8_t> stream = buildNoisyStream(noiseProbability, noiseMaxBytes, 8000000, &framesCount);
+	steady_clock::time_point startTime = steady_clock::now();
+	for (size_t position = 0; position < stream.size(); position += readSize)
+	{
+		size_t dataLength = (stream.size() - position < readSize) ? stream.size() - position : readSize;
+		slave.inputPacketParse(&stream[position], dataLength);
+	}
+	double seconds = std::chrono::duration <double>(steady_clock::now() - startTime).count();
+	printf("noise %.2f, burst up to %3zu bytes, read %4zu bytes: %6.1f MB/s, %5.0f ns/frame, frames %zu, answers %zu\n",
+		noiseProbability, noiseMaxBytes, readSize, stream.size() / seconds / 1e6, seconds * 1e9 / framesCount, framesCount, answersCount);
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1)
+	{
+		double noiseProbability = atof(argv[1]);
+		size_t noiseMaxBytes = (argc > 2) ? (size_t)atol(argv[2]) : 40;
+		size_t readSize = (argc > 3) ? (size_t)atol(argv[3]) : 8;
+		if (noiseProbability < 0 || noiseProbability > 1 || !readSize)
+		{
+			printf("Usage: NoiseParseBench [noise probability 0...1] [max noise bytes] [bytes of one read]\n");
+			return 1;
+		}
+		runNoiseBenchmark(noiseProbability, noiseMaxBytes, readSize);
+		return 0;
+	}
+
+	//clean line, noise between some frames, long noise bursts (resync after lost synchronization) - by small and large reads
+	const double noiseProbabilities[] = { 0.0, 0.1, 0.5, 0.5 };
+	const size_t noiseMaxBytes[] = { 0, 40, 40, 255 };
+	for (size_t i = 0; i < sizeof(noiseProbabilities) / sizeof(noiseProbabilities[0]); i++)
+	{
+		runNoiseBenchmark(noiseProbabilities[i], noiseMaxBytes[i], 8);
+		runNoiseBenchmark(noiseProbabilities[i], noiseMaxBytes[i], 1024);
+	}
+	return 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
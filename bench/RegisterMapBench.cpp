@@ -0,0 +1,130 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Benchmark of register map access: direct indexed tables of ModbusRegMap against std::map index of elements.
+//Build: see bench/README.md
+//Usage: RegisterMapBench [iterations]
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <map>
+#include <random>
+#include <vector>
+#include "ModbusRegisterMap.h"
+
+using steady_clock = std::chrono::steady_clock;
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* index of elements as in register map before direct indexed tables: std::map by key (function code << 16 | address) */
+typedef std::map <uint32_t, ModbusElementBase*> ElementsIndex;
+
+/* read range of registers by index - element by element, big-endian as in answer */
+static bool readIndexRange(const ElementsIndex& index, uint8_t functionCode, uint16_t startAddress, uint16_t registersCount, uint8_t* buffer)
+{
+	for (uint32_t i = 0; i < registersCount; i++)
+	{
+		ElementsIndex::const_iterator element = index.find((uint32_t)functionCode << 16 | (startAddress + i));
+		if (element == index.end())
+		{
+			return false;
+		}
+		uint16_t value = ((ModbusElement <uint16_t>*)element->second)->GetDataValue();
+		buffer[i * 2] = (uint8_t)(value >> 8);
+		buffer[i * 2 + 1] = (uint8_t)value;
+	}
+	return true;
+}
+
+/* nanoseconds per operation */
+static double nsPerOperation(steady_clock::time_point startTime, size_t operationsCount)
+{
+	return std::chrono::duration <double, std::nano>(steady_clock::now() - startTime).count() / (double)operationsCount;
+}
+
+/* map of registers count: random single register reads and FC03 reads of 125 registers */
+static void runMapBenchmark(uint32_t registersCount, size_t iterations)
+{
+	const uint8_t functionCode = 3;
+	const uint16_t rangeSize = 125;
+	ModbusRegMap registerMap;
+	for (uint32_t address = 0; address < registersCount; address++)
+	{
+		uint16_t value = (uint16_t)address, minValue = 0, maxValue = 65535;
+		registerMap.AddNewElement <uint16_t>(functionCode, (uint16_t)address, ModbusDataType::UInt16, 2, "register", 0,
+			value, minValue, maxValue, "");
+	}
+	ElementsIndex index;
+	for (ModbusElementBase* element = registerMap.GetFirstElement(); element != nullptr; element = registerMap.GetNextElement())
+	{
+		index[(uint32_t)element->GetFunctionCode() << 16 | element->GetRegisterAddress()] = element;
+	}
+
+	//same random addresses for both ways
+	std::mt19937 randomGenerator(1);
+	std::vector <uint16_t> addresses(iterations);
+	std::vector <uint16_t> rangeAddresses(iterations / 16 + 1);
+	for (size_t i = 0; i < addresses.size(); i++)
+	{
+		addresses[i] = (uint16_t)(randomGenerator() % registersCount);
+	}
+	for (size_t i = 0; i < rangeAddresses.size(); i++)
+	{
+		rangeAddresses[i] = (uint16_t)(randomGenerator() % (registersCount - rangeSize + 1));
+	}
+
+	//single register
+	volatile uint32_t sink = 0;
+	steady_clock::time_point startTime = steady_clock::now();
+	for (size_t i = 0; i < addresses.size(); i++)
+	{
+		ElementsIndex::const_iterator element = index.find((uint32_t)functionCode << 16 | addresses[i]);
+		sink = sink + ((ModbusElement <uint16_t>*)element->second)->GetDataValue();
+	}
+	double indexSingleTime = nsPerOperation(startTime, addresses.size());
+	startTime = steady_clock::now();
+	for (size_t i = 0; i < addresses.size(); i++)
+	{
+		const uint16_t* value;
+		registerMap.GetElementValue <uint16_t>(functionCode, addresses[i], &value);
+		sink = sink + *value;
+	}
+	double mapSingleTime = nsPerOperation(startTime, addresses.size());
+
+	//range of registers in wire format
+	uint8_t buffer[rangeSize * 2];
+	size_t bytesCount = 0;
+	startTime = steady_clock::now();
+	for (size_t i = 0; i < rangeAddresses.size(); i++)
+	{
+		readIndexRange(index, functionCode, rangeAddresses[i], rangeSize, buffer);
+		sink = sink + buffer[0];
+	}
+	double indexRangeTime = nsPerOperation(startTime, rangeAddresses.size());
+	startTime = steady_clock::now();
+	for (size_t i = 0; i < rangeAddresses.size(); i++)
+	{
+		registerMap.GetElementsRange(functionCode, rangeAddresses[i], rangeSize, buffer, sizeof(buffer), &bytesCount);
+		sink = sink + buffer[0];
+	}
+	double mapRangeTime = nsPerOperation(startTime, rangeAddresses.size());
+
+	printf("%u registers\n", registersCount);
+	printf("  one register:    std::map %7.1f ns, ModbusRegMap %7.1f ns, x%.1f\n", indexSingleTime, mapSingleTime, indexSingleTime / mapSingleTime);
+	printf("  125 registers:   std::map %7.1f ns, ModbusRegMap %7.1f ns, x%.1f\n", indexRangeTime, mapRangeTime, indexRangeTime / mapRangeTime);
+}
+
+int main(int argc, char* argv[])
+{
+	size_t iterations = (argc > 1) ? (size_t)atol(argv[1]) : 4000000;
+	if (!iterations)
+	{
+		printf("Usage: RegisterMapBench [iterations]\n");
+		return 1;
+	}
+	runMapBenchmark(10000, iterations);
+	runMapBenchmark(65536, iterations);
+	return 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
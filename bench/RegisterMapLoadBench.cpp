@@ -0,0 +1,121 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Benchmark of register map loading: elements and their strings on heap or in arena - load time, clear time, RSS.
+//Build: see bench/README.md
+//Usage: RegisterMapLoadBench <heap | arena> [elements count]
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "ModbusRegisterMap.h"
+
+#ifdef _WIN32
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#endif
+
+using steady_clock = std::chrono::steady_clock;
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* resident memory of process in KB */
+static size_t residentMemoryKB(void)
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS memoryCounters = {};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters)))
+	{
+		return 0;
+	}
+	return memoryCounters.WorkingSetSize / 1024;
+#else
+	FILE* statusFile = fopen("/proc/self/status", "r");
+	if (!statusFile)
+	{
+		return 0;
+	}
+	char line[256];
+	size_t residentSize = 0;
+	while (fgets(line, sizeof(line), statusFile))
+	{
+		if (!strncmp(line, "VmRSS:", 6))
+		{
+			residentSize = (size_t)atol(line + 6);
+			break;
+		}
+	}
+	fclose(statusFile);
+	return residentSize;
+#endif
+}
+
+/* milliseconds from start time */
+static double msFrom(steady_clock::time_point startTime)
+{
+	return std::chrono::duration <double, std::milli>(steady_clock::now() - startTime).count();
+}
+
+/* elements of holding registers, input registers and coils with names and units, as loaded from register map file */
+//each mode is measured by own process - memory released by clear isn't returned to system at once
+int main(int argc, char* argv[])
+{
+	if (argc < 2 || (strcmp(argv[1], "heap") && strcmp(argv[1], "arena")))
+	{
+		printf("Usage: RegisterMapLoadBench <heap | arena> [elements count]\n");
+		return 1;
+	}
+	bool useArena = !strcmp(argv[1], "arena");
+	uint32_t elementsCount = (argc > 2) ? (uint32_t)atol(argv[2]) : 50000;
+	if (!elementsCount || elementsCount > 3 * 0x8000)
+	{
+		printf("elements count: 1...%u\n", 3 * 0x8000);
+		return 1;
+	}
+
+	ModbusRegMap registerMap;
+	registerMap.SetArenaAllocation(useArena);
+	size_t residentBefore = residentMemoryKB();
+	char registerName[32];
+	steady_clock::time_point startTime = steady_clock::now();
+	for (uint32_t i = 0; i < elementsCount; i++)
+	{
+		uint16_t address = (uint16_t)(i / 3);
+		snprintf(registerName, sizeof(registerName), "register %u", i);
+		switch (i % 3)
+		{
+			case 0:
+			{
+				uint16_t value = 0, minValue = 0, maxValue = 65535;
+				registerMap.AddNewElement <uint16_t>(3, address, ModbusDataType::UInt16, 2, registerName, 0, value, minValue, maxValue, "V");
+			}
+			break;
+			case 1:
+			{
+				float value = 0, minValue = -1000, maxValue = 1000;
+				registerMap.AddNewElement <float>(4, (uint16_t)(address * 2), ModbusDataType::Float32, 4, registerName, 2,
+					value, minValue, maxValue, "degC");
+			}
+			break;
+			default:
+			{
+				uint8_t value = 0, minValue = 0, maxValue = 1;
+				registerMap.AddNewElement <uint8_t>(1, address, ModbusDataType::OneBit, 1, registerName, 0, value, minValue, maxValue, "");
+			}
+			break;
+		}
+	}
+	double loadTime = msFrom(startTime);
+	size_t residentLoaded = residentMemoryKB();
+	size_t loadedCount = registerMap.ElementsCount();
+
+	startTime = steady_clock::now();
+	registerMap.Clear();
+	double clearTime = msFrom(startTime);
+
+	printf("%s: %zu elements, load %.1f ms, clear %.1f ms, RSS of map %zu KB\n", useArena ? "arena" : "heap ",
+		loadedCount, loadTime, clearTime, residentLoaded - residentBefore);
+	return 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,104 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Benchmark server of MODBUS TCP for comparison of epoll and io_uring: load is created by ModbusTcpLoadClient on loopback.
+//Build: see bench/README.md
+//Usage: TcpServerBench <port> <seconds> <epoll | uring> [threads count]
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <functional>
+#include <vector>
+#include "ModbusProtocolHandler.h"
+#include "IndustryDataStreamsAL.h"
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* requests of one server thread, own cache line for each thread */
+struct alignas(64) workerCounter
+{
+	size_t requestsCount = 0;
+};
+
+/* CPU time of process (user + system), seconds */
+static double processCpuSeconds(void)
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+/* server runs for given time, then prints requests of each thread and CPU time per request */
+//requests per second and latency are printed by load client
+int main(int argc, char* argv[])
+{
+	if (argc < 4 || (strcmp(argv[3], "epoll") && strcmp(argv[3], "uring")))
+	{
+		printf("Usage: TcpServerBench <port> <seconds> <epoll | uring> [threads count]\n");
+		return 1;
+	}
+	int tcpPort = atoi(argv[1]);
+	int seconds = atoi(argv[2]);
+	int workersCount = (argc > 4) ? atoi(argv[4]) : 1;
+	if (tcpPort <= 0 || tcpPort > 65535 || seconds <= 0 || workersCount <= 0)
+	{
+		printf("Usage: TcpServerBench <port> <seconds> <epoll | uring> [threads count]\n");
+		return 1;
+	}
+
+	//holding registers as read by load client
+	ModbusRegMap registerMap;
+	for (uint16_t address = 0; address < 200; address++)
+	{
+		uint16_t value = (uint16_t)(0x1000 + address), minValue = 0, maxValue = 65535;
+		registerMap.AddNewElement <uint16_t>(3, address, ModbusDataType::UInt16, 2, "register", 0, value, minValue, maxValue, "");
+	}
+	std::vector <ModbusProtocolSlave> modbusSlaves(workersCount);
+	std::vector <workerCounter> workersCounters(workersCount);
+	for (ModbusProtocolSlave& modbusSlave : modbusSlaves)
+	{
+		modbusSlave.SetRegisterMap(&registerMap);
+		modbusSlave.SetDeviceAddress(1);
+	}
+
+	DataStreamEthernet ethernetStream((uint16_t)tcpPort);
+	ethernetStream.SetWorkersCount((size_t)workersCount);
+	ethernetStream.SetWorkersPinning(workersCount > 1);
+	ethernetStream.SetIoUringMode(!strcmp(argv[3], "uring"));
+	for (int i = 0; i < workersCount; i++)
+	{
+		ModbusProtocolSlave* modbusSlave = &modbusSlaves[i];
+		workerCounter* counter = &workersCounters[i];
+		ethernetStream.SetWorkerRequestHandler((size_t)i,
+			[modbusSlave, counter](uint8_t unitId, const uint8_t* pdu, size_t pduLength, uint8_t* response, size_t responseCapacity)
+			{
+				counter->requestsCount++;
+				return modbusSlave->ProcessRequestPDU(unitId, pdu, pduLength, response, responseCapacity);
+			});
+	}
+	if (!ethernetStream.StreamStart())
+	{
+		printf("Can't start modbus TCP server\n");
+		return 1;
+	}
+	printf("port %d, threads %d, backend %s\n", tcpPort, workersCount, ethernetStream.IsIoUringActive() ? "io_uring" : "epoll");
+	fflush(stdout);
+	double cpuStart = processCpuSeconds();
+	sleep((unsigned int)seconds);
+	ethernetStream.StreamStop();
+	double cpuSeconds = processCpuSeconds() - cpuStart;
+
+	size_t requestsCount = 0;
+	for (int i = 0; i < workersCount; i++)
+	{
+		printf("thread %d: requests %zu\n", i, workersCounters[i].requestsCount);
+		requestsCount += workersCounters[i].requestsCount;
+	}
+	printf("requests %zu, CPU %.2f s, %.2f us/request\n", requestsCount, cpuSeconds,
+		requestsCount ? cpuSeconds * 1e6 / requestsCount : 0.0);
+	return 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,88 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Test of modbus CRC16: slicing-by-8 calculation is equal to bytewise calculation.
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include <stdio.h>
+#include <random>
+#include "ModbusProtocolHandler.h"
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* bytewise modbus CRC16 by polynomial (0xA001), without tables - reference for table calculation */
+static uint16_t bytewiseCRC16(const uint8_t* inputData, size_t dataLength)
+{
+	uint16_t crcWord = 0xFFFF;
+	for (size_t i = 0; i < dataLength; i++)
+	{
+		crcWord ^= inputData[i];
+		for (int bit = 0; bit < 8; bit++)
+		{
+			crcWord = (crcWord & 0x0001) ? (uint16_t)((crcWord >> 1) ^ 0xA001) : (uint16_t)(crcWord >> 1);
+		}
+	}
+	return crcWord;
+}
+
+/* all inputs of one and two bytes, random inputs of each length up to max RTU frame and longer with any alignment */
+int main(int argc, char* argv[])
+{
+	size_t checksCount = 0;
+	size_t errorsCount = 0;
+	auto checkCRC = [&](const uint8_t* inputData, size_t dataLength)
+	{
+		checksCount++;
+		if (ModbusCRC16(inputData, (uint16_t)dataLength) != bytewiseCRC16(inputData, dataLength))
+		{
+			if (errorsCount++ < 10)
+			{
+				printf("FAIL: length %zu, first byte %02X\n", dataLength, dataLength ? inputData[0] : 0);
+			}
+		}
+	};
+
+	//reference is checked by standard check value of CRC-16/MODBUS
+	if (bytewiseCRC16((const uint8_t*)"123456789", 9) != 0x4B37)
+	{
+		printf("FAIL: check value of bytewise CRC\n");
+		return 1;
+	}
+
+	uint8_t data[2048 + 8] = {};
+	//empty input and all single byte and two bytes inputs
+	checkCRC(data, 0);
+	for (uint32_t value = 0; value < 0x10000; value++)
+	{
+		data[0] = (uint8_t)value;
+		data[1] = (uint8_t)(value >> 8);
+		if (value < 0x100)
+		{
+			checkCRC(data, 1);
+		}
+		checkCRC(data, 2);
+	}
+
+	//random data: each length, offset of data changes alignment of 8 bytes blocks
+	std::mt19937 randomGenerator(argc > 1 ? (unsigned)atoi(argv[1]) : 2026);
+	for (size_t dataLength = 1; dataLength <= 2048; dataLength++)
+	{
+		for (int attempt = 0; attempt < 64; attempt++)
+		{
+			size_t offset = attempt % 8;
+			for (size_t i = 0; i < dataLength; i++)
+			{
+				data[offset + i] = (uint8_t)randomGenerator();
+			}
+			checkCRC(data + offset, dataLength);
+		}
+	}
+
+	printf("checks: %zu, errors: %zu\n", checksCount, errorsCount);
+	if (errorsCount)
+	{
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
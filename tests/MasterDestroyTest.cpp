@@ -0,0 +1,52 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Test of master destruction during timeouts: expired timers of master don't call destroyed master.
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "ModbusProtocolHandler.h"
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* masters are destroyed at different moments around expiry of answer timeout and repeats of request */
+//slow send function keeps timer callback in repeat of request while destructor is called; build with AddressSanitizer
+int main(int argc, char* argv[])
+{
+	int mastersCount = (argc > 1) ? atoi(argv[1]) : 3000;
+
+	//answers aren't received - elements of register map aren't needed
+	ModbusRegMap registerMap;
+
+	std::atomic <int> sendsCount = 0;
+	std::atomic <int> resultsCount = 0;
+	for (int i = 0; i < mastersCount; i++)
+	{
+		ModbusProtocolMaster* master = new ModbusProtocolMaster;
+		master->SetRegisterMap(&registerMap);
+		master->SetSendDataFunc([&sendsCount](uint8_t*, size_t)
+			{
+				sendsCount++;
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+				return true;
+			});
+		master->SetResponseTimeout(1);
+		master->SetNumberOfAttempts(3);
+		master->SendReadRequest(3, 0, 2, [&resultsCount](int) { resultsCount++; });
+		std::this_thread::sleep_for(std::chrono::microseconds(500 + (i % 7) * 300));
+		delete master;
+	}
+
+	//each transaction is finished once - by timeout or by cancel of destructor
+	printf("masters: %d, requests sent: %d, results: %d\n", mastersCount, sendsCount.load(), resultsCount.load());
+	if (resultsCount != mastersCount)
+	{
+		printf("FAIL: results count isn't masters count\n");
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,91 @@
+//*********************************************************************************************************//
+//MODBUS protocol implementation in C++
+//Test of failed send of master request: transaction result is delivered once - by return value or by callback.
+//Created 16.10.2026
+//*********************************************************************************************************//
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include "ModbusProtocolHandler.h"
+
+/*-----------------------------------------------------------------------------------------------------------------------------*/
+/* failed send: callback count must be 0 for false, 1 for true; future must get one value without std::future_error */
+static bool checkSendFail(const char* name, ModbusProtocolMaster& master, int expectedResult)
+{
+	std::atomic <int> callbacksCount = 0;
+	std::atomic <int> callbackResult = 0;
+	bool requestStarted = master.SendReadRequest(3, 0, 1, [&callbacksCount, &callbackResult](int result)
+		{
+			callbackResult = result;
+			callbacksCount++;
+		});
+	int futureResult = 0;
+	try
+	{
+		futureResult = master.SendReadRequest(3, 0, 1).get();
+	}
+	catch (const std::future_error& error)
+	{
+		printf("FAIL %s: %s\n", name, error.what());
+		return false;
+	}
+	printf("%s: started %d, callbacks %d, callback result %d, future result %d, in flight %zu\n", name, (int)requestStarted,
+		callbacksCount.load(), callbackResult.load(), futureResult, (size_t)master.GetTransactionsInFlight());
+	if (callbacksCount != (requestStarted ? 1 : 0) || (requestStarted && callbackResult != expectedResult) ||
+		futureResult != expectedResult || master.GetTransactionsInFlight())
+	{
+		printf("FAIL %s\n", name);
+		return false;
+	}
+	return true;
+}
+
+/* send fails plainly, after cancel of transaction and after timeout of transaction (timeout is shorter than send) */
+int main(void)
+{
+	//answers aren't received - elements of register map aren't needed
+	ModbusRegMap registerMap;
+	bool testPassed = true;
+
+	ModbusProtocolMaster master;
+	master.SetRegisterMap(&registerMap);
+	master.SetTcpMode(true);
+	master.SetSendDataFunc([](uint8_t*, size_t) { return false; });
+	testPassed &= checkSendFail("send error", master, ModbusProtocolMaster::MT_SEND_ERROR);
+
+	ModbusProtocolMaster cancelMaster;
+	cancelMaster.SetRegisterMap(&registerMap);
+	cancelMaster.SetTcpMode(true);
+	cancelMaster.SetSendDataFunc([&cancelMaster](uint8_t*, size_t)
+		{
+			cancelMaster.CancelTransactions();
+			return false;
+		});
+	testPassed &= checkSendFail("cancel in send", cancelMaster, ModbusProtocolMaster::MT_CANCELLED);
+
+	ModbusProtocolMaster timeoutMaster;
+	timeoutMaster.SetRegisterMap(&registerMap);
+	timeoutMaster.SetTcpMode(true);
+	timeoutMaster.SetResponseTimeout(1);
+	timeoutMaster.SetSendDataFunc([&timeoutMaster](uint8_t*, size_t)
+		{
+			//timer callback finishes transaction while request is sent
+			for (int i = 0; i < 1000 && timeoutMaster.GetTransactionsInFlight(); i++)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			return false;
+		});
+	testPassed &= checkSendFail("timeout in send", timeoutMaster, ModbusProtocolMaster::MT_TIMEOUT);
+
+	if (!testPassed)
+	{
+		return 1;
+	}
+	printf("OK\n");
+	return 0;
+}
+/*-----------------------------------------------------------------------------------------------------------------------------*/